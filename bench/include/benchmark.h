@@ -0,0 +1,148 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <muli/muli.h>
+#include <muli/random.h>
+
+namespace muli
+{
+
+typedef void BenchmarkFunction();
+
+struct BenchmarkFrame
+{
+    const char* name;
+    BenchmarkFunction* function;
+};
+
+inline std::vector<BenchmarkFrame> benchmarks;
+
+inline int32 register_benchmark(const char* name, BenchmarkFunction* function)
+{
+    benchmarks.push_back(BenchmarkFrame{ name, function });
+    return (int32)benchmarks.size();
+}
+
+// Seconds since an arbitrary point
+inline double GetTime()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Worker counts to measure: 1, 2, 4, ... up to the hardware thread count
+inline std::vector<int32> GetWorkerCounts()
+{
+    int32 maxWorkers = Clamp(int32(std::thread::hardware_concurrency()), 1, max_workers);
+
+    std::vector<int32> counts;
+    for (int32 i = 1; i < maxWorkers; i *= 2)
+    {
+        counts.push_back(i);
+    }
+    counts.push_back(maxWorkers);
+
+    return counts;
+}
+
+// Hash of all body transforms, used to check that the results don't depend on the worker count
+inline uint64 ComputeChecksum(const World& world)
+{
+    uint64 hash = 14695981039346656037ull;
+
+    for (const RigidBody* b = world.GetBodyList(); b; b = b->GetNext())
+    {
+        const Transform& tf = b->GetTransform();
+        float values[4] = { tf.position.x, tf.position.y, tf.rotation.s, tf.rotation.c };
+
+        uint8 bytes[sizeof(values)];
+        memcpy(bytes, values, sizeof(values));
+
+        for (uint8 byte : bytes)
+        {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+    }
+
+    return hash;
+}
+
+typedef void CreateFunction(World& world);
+
+// 1000 boxes dropped into a container
+inline void CreatePile(World& world)
+{
+    Srand(1);
+
+    float h = 7.5f;
+    world.CreateCapsule(Vec2{ -h, -h }, Vec2{ h, -h }, 0.2f, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ h, -h }, Vec2{ h, h }, 0.2f, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ -h, h }, Vec2{ -h, -h }, 0.2f, RigidBody::Type::static_body);
+
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        RigidBody* b = world.CreateBox(0.38f);
+        b->SetPosition(Rand(-7.0f, 7.0f), Rand(-7.0f, 7.0f));
+    }
+}
+
+// Pyramid of 820 boxes
+inline void CreatePyramid(World& world)
+{
+    world.CreateCapsule(40.0f, 0.2f, true, RigidBody::Type::static_body);
+
+    int32 rows = 40;
+    float size = 0.4f;
+    float gap = 0.025f;
+
+    for (int32 y = 0; y < rows; ++y)
+    {
+        for (int32 x = 0; x < rows - y; ++x)
+        {
+            RigidBody* b = world.CreateBox(size);
+            b->SetPosition((x - (rows - y - 1) * 0.5f) * (size + gap), 0.2f + size * 0.5f + y * (size + gap));
+        }
+    }
+}
+
+// Average step time of the scene over the best of a few runs, sleeping is disabled
+// contactCount receives the contact count at the end of the last run if given
+inline double MeasureStep(
+    CreateFunction* create, WorldSettings settings, int32 warmupSteps, int32 stepCount, int32* contactCount = nullptr
+)
+{
+    constexpr int32 run_count = 3;
+    constexpr float dt = 1.0f / 60.0f;
+
+    settings.sleeping = false;
+
+    double best = max_value;
+
+    for (int32 i = 0; i < run_count; ++i)
+    {
+        World world{ settings };
+        create(world);
+
+        for (int32 j = 0; j < warmupSteps; ++j)
+        {
+            world.Step(dt);
+        }
+
+        double begin = GetTime();
+        for (int32 j = 0; j < stepCount; ++j)
+        {
+            world.Step(dt);
+        }
+        best = Min(best, (GetTime() - begin) / stepCount);
+
+        if (contactCount)
+        {
+            *contactCount = world.GetContactCount();
+        }
+    }
+
+    return best;
+}
+
+} // namespace muli
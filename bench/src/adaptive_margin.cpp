@@ -0,0 +1,142 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// 1000 bodies rolling and sliding along a long floor
+static void CreateTraffic(World& world)
+{
+    Srand(1);
+
+    world.CreateCapsule(Vec2{ -500.0f, 0.0f }, Vec2{ 500.0f, 0.0f }, 0.2f, RigidBody::Type::static_body);
+
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        RigidBody* b = i % 2 ? world.CreateBox(0.4f) : world.CreateCircle(0.2f);
+        b->SetPosition(Rand(-480.0f, 480.0f), Rand(0.5f, 4.0f));
+        b->SetLinearVelocity(Vec2{ Rand(-5.0f, 5.0f), 0.0f });
+    }
+}
+
+// 200 thin rods shot through a field of 2000 small static boxes
+static void CreateBullets(World& world)
+{
+    Srand(1);
+
+    for (int32 i = 0; i < 2000; ++i)
+    {
+        RigidBody* b = world.CreateBox(0.2f, RigidBody::Type::static_body);
+        b->SetPosition(Rand(-50.0f, 50.0f), Rand(-50.0f, 50.0f));
+    }
+
+    for (int32 i = 0; i < 200; ++i)
+    {
+        RigidBody* b = world.CreateCapsule(0.5f, 0.02f, true);
+        b->SetPosition(Rand(-50.0f, 50.0f), Rand(-50.0f, 50.0f));
+        b->SetRotation(Rand(0.0f, pi));
+        b->SetLinearVelocity(Vec2{ Rand(-40.0f, 40.0f), Rand(-40.0f, 40.0f) });
+        b->SetContinuous(false);
+    }
+}
+
+struct MarginResult
+{
+    double stepTime;
+    float reinsertions;
+    float newPairs;
+    float pairs;
+    float falsePositives;
+};
+
+static MarginResult MeasureMargin(CreateFunction* create, bool adaptive)
+{
+    constexpr int32 warmup_steps = 60;
+    constexpr int32 step_count = 240;
+    constexpr int32 run_count = 3;
+    constexpr float dt = 1.0f / 60.0f;
+
+    WorldSettings settings;
+    settings.sleeping = false;
+    settings.apply_gravity = create != CreateBullets;
+    settings.adaptive_aabb_margin = adaptive;
+
+    MarginResult result{};
+    int64 touching = 0;
+    int64 pairs = 0;
+
+    // The counters are deterministic, the step time is the best of a few runs
+    result.stepTime = max_value;
+    for (int32 run = 0; run < run_count; ++run)
+    {
+        World world{ settings };
+        create(world);
+
+        for (int32 i = 0; i < warmup_steps; ++i)
+        {
+            world.Step(dt);
+        }
+
+        result.reinsertions = 0.0f;
+        result.newPairs = 0.0f;
+        touching = 0;
+        pairs = 0;
+
+        double begin = GetTime();
+        for (int32 i = 0; i < step_count; ++i)
+        {
+            world.Step(dt);
+
+            const BroadPhaseStats& stats = world.GetBroadPhaseStats();
+            result.reinsertions += stats.reinsertions;
+            result.newPairs += stats.newPairs;
+            pairs += stats.pairs;
+            touching += stats.touchingPairs;
+        }
+        result.stepTime = Min(result.stepTime, (GetTime() - begin) / step_count);
+    }
+
+    result.reinsertions /= step_count;
+    result.newPairs /= step_count;
+    result.pairs = float(pairs) / step_count;
+    result.falsePositives = pairs > 0 ? float(pairs - touching) / pairs : 0.0f;
+
+    return result;
+}
+
+// Tree churn and false positive pairs with the constant and the adaptive fat aabb margins
+static void AdaptiveMarginBenchmark()
+{
+    struct Scene
+    {
+        const char* name;
+        CreateFunction* create;
+    };
+
+    Scene scenes[] = {
+        { "pile", CreatePile },
+        { "traffic", CreateTraffic },
+        { "bullets", CreateBullets },
+    };
+
+    printf(
+        "%-8s %-9s %9s %13s %10s %8s %16s\n", "scene", "margin", "step(ms)", "reinsert/step", "new/step", "pairs",
+        "false positives"
+    );
+
+    for (const Scene& scene : scenes)
+    {
+        for (bool adaptive : { false, true })
+        {
+            MarginResult r = MeasureMargin(scene.create, adaptive);
+
+            printf(
+                "%-8s %-9s %9.3f %13.1f %10.1f %8.0f %15.1f%%\n", scene.name, adaptive ? "adaptive" : "constant",
+                r.stepTime * 1000.0, r.reinsertions, r.newPairs, r.pairs, r.falsePositives * 100.0f
+            );
+        }
+    }
+}
+
+static int index = register_benchmark("adaptive_margin", AdaptiveMarginBenchmark);
+
+} // namespace muli
@@ -0,0 +1,69 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Wide static floor holding rows of sleeping boxes, with a few hundred bodies falling in from above
+static void CreateScene(World& world)
+{
+    constexpr int32 floor_pieces = 2000;
+    constexpr int32 sleeping_rows = 4;
+    constexpr int32 falling_count = 300;
+    constexpr float piece_width = 0.5f;
+
+    for (int32 i = 0; i < floor_pieces; ++i)
+    {
+        RigidBody* b = world.CreateBox(piece_width, 0.4f, RigidBody::Type::static_body);
+        b->SetPosition((i - floor_pieces / 2) * piece_width, 0.0f);
+    }
+
+    for (int32 y = 0; y < sleeping_rows; ++y)
+    {
+        for (int32 i = 0; i < floor_pieces / 2; ++i)
+        {
+            RigidBody* b = world.CreateBox(0.4f);
+            b->SetPosition((i - floor_pieces / 4) * piece_width * 2.0f, 0.4f + y * 0.41f);
+            b->Sleep();
+        }
+    }
+
+    Srand(1);
+    for (int32 i = 0; i < falling_count; ++i)
+    {
+        RigidBody* b = i % 2 ? world.CreateBox(0.3f) : world.CreateCircle(0.15f);
+        b->SetPosition(Rand(-100.0f, 100.0f), Rand(3.0f, 10.0f));
+    }
+}
+
+// Step time of a world that is mostly static and sleeping
+static void BroadPhaseBenchmark()
+{
+    constexpr int32 step_count = 180;
+    constexpr int32 run_count = 3;
+    constexpr float dt = 1.0f / 60.0f;
+
+    double best = max_value;
+    int32 contactCount = 0;
+
+    for (int32 i = 0; i < run_count; ++i)
+    {
+        WorldSettings settings;
+        World world{ settings };
+        CreateScene(world);
+
+        double begin = GetTime();
+        for (int32 j = 0; j < step_count; ++j)
+        {
+            world.Step(dt);
+        }
+        best = Min(best, (GetTime() - begin) / step_count);
+
+        contactCount = world.GetContactCount();
+    }
+
+    printf("step %.3fms, %d contacts\n", best * 1000.0, contactCount);
+}
+
+static int index = register_benchmark("broad_phase", BroadPhaseBenchmark);
+
+} // namespace muli
@@ -0,0 +1,114 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Scene of the 1000 Capsules demo, 1000 small capsules dropped into a box made of capsule walls
+static void CreateCapsules1000(World& world)
+{
+    Srand(1);
+
+    float size = 15.0f;
+    float halfSize = size / 2.0f;
+    float wallWidth = 0.4f;
+    float wallRadius = wallWidth / 2.0f;
+
+    world.CreateCapsule(Vec2{ -halfSize, -halfSize }, Vec2{ halfSize, -halfSize }, wallRadius, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ halfSize, -halfSize }, Vec2{ halfSize, halfSize }, wallRadius, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ halfSize, halfSize }, Vec2{ -halfSize, halfSize }, wallRadius, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ -halfSize, halfSize }, Vec2{ -halfSize, -halfSize }, wallRadius, RigidBody::Type::static_body);
+
+    float r = 0.3f;
+
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        RigidBody* c = world.CreateCapsule(r, r / 2.0f);
+        c->SetPosition(
+            Rand(0.0f, size - wallWidth) - (size - wallWidth) / 2.0f, Rand(0.0f, size - wallWidth) - (size - wallWidth) / 2.0f
+        );
+        c->SetRotation(Rand(0.0f, pi * 2.0f));
+    }
+}
+
+struct CapsulePair
+{
+    const Shape* a;
+    const Shape* b;
+    Transform tfA;
+    Transform tfB;
+};
+
+// Step time of the capsules_1000 scene, and the capsule-capsule kernels timed on the contacts of the settled pile
+static void CapsulesBenchmark()
+{
+    constexpr int32 settle_steps = 300;
+    constexpr int32 step_count = 300;
+    constexpr int32 repeat_count = 200;
+    constexpr float dt = 1.0f / 60.0f;
+
+    WorldSettings settings;
+    settings.sleeping = false;
+
+    World world{ settings };
+    CreateCapsules1000(world);
+
+    for (int32 i = 0; i < settle_steps; ++i)
+    {
+        world.Step(dt);
+    }
+
+    double begin = GetTime();
+    for (int32 i = 0; i < step_count; ++i)
+    {
+        world.Step(dt);
+    }
+    double stepTime = (GetTime() - begin) / step_count;
+
+    printf("capsules_1000 step: %.3f ms\n\n", stepTime * 1000.0);
+
+    std::vector<CapsulePair> pairs;
+    for (const Contact* c = world.GetContacts(); c; c = c->GetNext())
+    {
+        const Collider* colliderA = c->GetColliderA();
+        const Collider* colliderB = c->GetColliderB();
+        if (colliderA->GetType() != Shape::Type::capsule || colliderB->GetType() != Shape::Type::capsule)
+        {
+            continue;
+        }
+
+        pairs.push_back(
+            { colliderA->GetShape(), colliderB->GetShape(), colliderA->GetBody()->GetTransform(), colliderB->GetBody()->GetTransform() }
+        );
+    }
+
+    printf("%-16s %10s %9s %8s\n", "kernel", "call(ns)", "touching", "points");
+
+    for (CollideFunction* collide : { &ConvexVsConvex, &CapsuleVsCapsule })
+    {
+        ContactManifold manifold;
+        int32 touching = 0;
+        int32 points = 0;
+
+        begin = GetTime();
+        for (int32 r = 0; r < repeat_count; ++r)
+        {
+            for (const CapsulePair& pair : pairs)
+            {
+                if (collide(pair.a, pair.tfA, pair.b, pair.tfB, &manifold) && r == 0)
+                {
+                    ++touching;
+                    points += manifold.contactCount;
+                }
+            }
+        }
+        double time = (GetTime() - begin) / (repeat_count * pairs.size());
+
+        printf(
+            "%-16s %10.1f %9d %8d\n", collide == &ConvexVsConvex ? "gjk-epa" : "segment-segment", time * 1e9, touching, points
+        );
+    }
+}
+
+static int index = register_benchmark("capsules", CapsulesBenchmark);
+
+} // namespace muli
@@ -0,0 +1,134 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+constexpr uint32 wall_category = 1 << 1;
+constexpr uint32 debris_category = 1 << 2;
+
+// A few hundred walls standing among thousands of small debris bodies
+static void CreateRuins(World& world)
+{
+    Srand(1);
+
+    float range = 100.0f;
+
+    CollisionFilter wallFilter;
+    wallFilter.bit = wall_category;
+
+    for (int32 i = 0; i < 300; ++i)
+    {
+        RigidBody* b = world.CreateBox(Rand(2.0f, 6.0f), 0.5f, RigidBody::Type::static_body);
+        b->SetPosition(Rand(-range, range), Rand(-range, range));
+        b->SetRotation(Rand(0.0f, pi));
+        b->GetColliderList()->SetFilter(wallFilter);
+    }
+
+    CollisionFilter debrisFilter;
+    debrisFilter.bit = debris_category;
+
+    for (int32 i = 0; i < 20000; ++i)
+    {
+        RigidBody* b = world.CreateBox(0.3f, RigidBody::Type::static_body);
+        b->SetPosition(Rand(-range, range), Rand(-range, range));
+        b->GetColliderList()->SetFilter(debrisFilter);
+    }
+}
+
+struct CategoryResult
+{
+    double rayTime;
+    double queryTime;
+    int32 blocked;
+    int32 walls;
+};
+
+// Line of sight rays and area queries looking for the walls only
+static CategoryResult MeasureCategoryQueries(WorldSettings::BroadPhaseType broadPhase, bool masked)
+{
+    constexpr int32 ray_count = 20000;
+    constexpr int32 query_count = 20000;
+
+    WorldSettings settings;
+    settings.broad_phase = broadPhase;
+
+    World world{ settings };
+    CreateRuins(world);
+    world.Step(1.0f / 60.0f);
+
+    uint32 categoryMask = masked ? wall_category : all_categories;
+
+    CategoryResult result{};
+
+    Srand(2);
+    double begin = GetTime();
+    for (int32 i = 0; i < ray_count; ++i)
+    {
+        Vec2 from{ Rand(-100.0f, 100.0f), Rand(-100.0f, 100.0f) };
+        Vec2 to = from + Vec2{ Rand(-30.0f, 30.0f), Rand(-30.0f, 30.0f) };
+
+        bool blocked = false;
+        world.RayCastAny(
+            from, to, 0.0f,
+            [&](Collider* collider, const Vec2& point, const Vec2& normal, float fraction) -> float {
+                MuliNotUsed(point);
+                MuliNotUsed(normal);
+                MuliNotUsed(fraction);
+
+                if ((collider->GetFilter().bit & wall_category) == 0)
+                {
+                    return -1.0f;
+                }
+
+                blocked = true;
+                return 0.0f;
+            },
+            categoryMask
+        );
+
+        result.blocked += blocked;
+    }
+    result.rayTime = GetTime() - begin;
+
+    begin = GetTime();
+    for (int32 i = 0; i < query_count; ++i)
+    {
+        Vec2 center{ Rand(-100.0f, 100.0f), Rand(-100.0f, 100.0f) };
+        AABB aabb{ center - Vec2{ 5.0f }, center + Vec2{ 5.0f } };
+
+        world.Query(
+            aabb,
+            [&](Collider* collider) -> bool {
+                result.walls += (collider->GetFilter().bit & wall_category) != 0;
+                return true;
+            },
+            categoryMask
+        );
+    }
+    result.queryTime = GetTime() - begin;
+
+    return result;
+}
+
+// Queries for a single category through a crowd of other colliders, filtered in the callback or pruned by the query mask
+static void CategoryQueryBenchmark()
+{
+    printf("%-16s %-9s %10s %12s %8s %8s\n", "broad phase", "filter", "rays(ms)", "queries(ms)", "blocked", "walls");
+
+    for (WorldSettings::BroadPhaseType type : { WorldSettings::dynamic_tree, WorldSettings::sweep_and_prune })
+    {
+        for (bool masked : { false, true })
+        {
+            CategoryResult r = MeasureCategoryQueries(type, masked);
+
+            printf(
+                "%-16s %-9s %10.3f %12.3f %8d %8d\n", type == WorldSettings::dynamic_tree ? "dynamic tree" : "sweep and prune",
+                masked ? "mask" : "callback", r.rayTime * 1000.0, r.queryTime * 1000.0, r.blocked, r.walls
+            );
+        }
+    }
+}
+
+static int index = register_benchmark("category_query", CategoryQueryBenchmark);
+
+} // namespace muli
@@ -0,0 +1,99 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+struct KernelCase
+{
+    Transform tfA;
+    Transform tfB;
+};
+
+// Pairs resting on each other like in a stack, slightly rotated and overlapping by a few slops
+static std::vector<KernelCase> CreateRestingCases(float heightA, float heightB)
+{
+    Srand(1);
+
+    std::vector<KernelCase> cases(10000);
+    for (KernelCase& c : cases)
+    {
+        c.tfA = Transform{ Vec2{ Rand(-0.1f, 0.1f), 0.0f }, Rand(-0.05f, 0.05f) };
+        c.tfB = Transform{ Vec2{ Rand(-0.3f, 0.3f), (heightA + heightB) * 0.5f + Rand(-0.02f, 0.01f) }, Rand(-0.05f, 0.05f) };
+    }
+
+    return cases;
+}
+
+static double MeasureKernel(
+    CollideFunction* collide, const Shape* a, const Shape* b, const std::vector<KernelCase>& cases, int32* touching, int32* points
+)
+{
+    constexpr int32 repeat_count = 100;
+
+    ContactManifold manifold;
+    *touching = 0;
+    *points = 0;
+
+    double begin = GetTime();
+    for (int32 r = 0; r < repeat_count; ++r)
+    {
+        for (const KernelCase& c : cases)
+        {
+            if (collide(a, c.tfA, b, c.tfB, &manifold))
+            {
+                *touching += r == 0;
+                *points += r == 0 ? manifold.contactCount : 0;
+            }
+        }
+    }
+
+    return (GetTime() - begin) / (repeat_count * cases.size());
+}
+
+// Time per call of the separating axis kernels against the GJK and EPA path
+static void CollideKernelsBenchmark()
+{
+    Polygon box{ 1.0f };
+    Polygon wideBox{ 2.0f, 0.5f, default_radius };
+    Polygon hexagon{ { Vec2{ 0.5f, 0.0f }, Vec2{ 0.25f, 0.43f }, Vec2{ -0.25f, 0.43f }, Vec2{ -0.5f, 0.0f }, Vec2{ -0.25f, -0.43f },
+                       Vec2{ 0.25f, -0.43f } } };
+    Capsule capsule{ 1.0f, 0.25f, true };
+
+    struct Pair
+    {
+        const char* name;
+        const Shape* a;
+        const Shape* b;
+        CollideFunction* kernel;
+        float heightA;
+        float heightB;
+    };
+
+    Pair pairs[] = {
+        { "box-box", &box, &wideBox, PolygonVsPolygon, 1.0f, 0.5f },
+        { "hexagon-hexagon", &hexagon, &hexagon, PolygonVsPolygon, 0.86f, 0.86f },
+        { "box-capsule", &box, &capsule, PolygonVsCapsule, 1.0f, 0.5f },
+    };
+
+    printf("%-16s %-8s %10s %9s %8s\n", "pair", "kernel", "call(ns)", "touching", "points");
+
+    for (const Pair& pair : pairs)
+    {
+        std::vector<KernelCase> cases = CreateRestingCases(pair.heightA, pair.heightB);
+
+        for (CollideFunction* collide : { &ConvexVsConvex, pair.kernel })
+        {
+            int32 touching, points;
+            double time = MeasureKernel(collide, pair.a, pair.b, cases, &touching, &points);
+
+            printf(
+                "%-16s %-8s %10.1f %9d %8d\n", pair.name, collide == &ConvexVsConvex ? "gjk-epa" : "sat", time * 1e9, touching,
+                points
+            );
+        }
+    }
+}
+
+static int index = register_benchmark("collide_kernels", CollideKernelsBenchmark);
+
+} // namespace muli
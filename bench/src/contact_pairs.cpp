@@ -0,0 +1,49 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// 10k small boxes dropped onto a single long capsule
+// Every new pair is checked against the existing contacts, and the capsule ends up with 10k contact edges
+static void ContactPairsBenchmark()
+{
+    constexpr int32 box_count = 10000;
+    constexpr float spacing = 0.1f;
+    constexpr int32 step_count = 60;
+    constexpr float dt = 1.0f / 60.0f;
+
+    RigidBody::Type types[] = { RigidBody::Type::static_body, RigidBody::Type::kinematic_body };
+    const char* names[] = { "static", "kinematic" };
+
+    printf("%10s %12s %10s\n", "capsule", "step(ms)", "contacts");
+
+    for (int32 i = 0; i < 2; ++i)
+    {
+        WorldSettings settings;
+        settings.sleeping = false;
+
+        World world{ settings };
+
+        float halfWidth = box_count * spacing * 0.5f;
+        world.CreateCapsule(Vec2{ -halfWidth, 0.0f }, Vec2{ halfWidth, 0.0f }, 0.5f, types[i]);
+
+        for (int32 j = 0; j < box_count; ++j)
+        {
+            RigidBody* b = world.CreateBox(spacing * 0.8f);
+            b->SetPosition(-halfWidth + (j + 0.5f) * spacing, 0.8f);
+        }
+
+        double begin = GetTime();
+        for (int32 j = 0; j < step_count; ++j)
+        {
+            world.Step(dt);
+        }
+        double time = (GetTime() - begin) / step_count;
+
+        printf("%10s %12.3f %10d\n", names[i], time * 1000.0, world.GetContactCount());
+    }
+}
+
+static int index = register_benchmark("contact_pairs", ContactPairsBenchmark);
+
+} // namespace muli
@@ -0,0 +1,105 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+struct QueryCase
+{
+    Transform tfA;
+    Transform tfB;
+    Vec2 translation;
+};
+
+// Shapes around each other within a few sizes, casts aimed roughly at the other shape
+static std::vector<QueryCase> CreateQueryCases()
+{
+    Srand(1);
+
+    std::vector<QueryCase> cases(10000);
+    for (QueryCase& c : cases)
+    {
+        c.tfA = Transform{ Vec2{ Rand(-0.5f, 0.5f), Rand(-0.5f, 0.5f) }, Rand(0.0f, pi) };
+        float direction = Rand(0.0f, 2.0f * pi);
+        c.tfB = Transform{ Vec2{ cosf(direction), sinf(direction) } * Rand(0.5f, 3.0f), Rand(0.0f, pi) };
+        c.translation = (c.tfB.position - c.tfA.position) * Rand(0.5f, 1.5f) + Vec2{ Rand(-0.5f, 0.5f), Rand(-0.5f, 0.5f) };
+    }
+
+    return cases;
+}
+
+// Time per call of the GJK based queries on the Shape interface
+static void ConvexQueriesBenchmark()
+{
+    constexpr int32 repeat_count = 50;
+
+    Polygon box{ 1.0f };
+    Polygon hexagon{ { Vec2{ 0.5f, 0.0f }, Vec2{ 0.25f, 0.43f }, Vec2{ -0.25f, 0.43f }, Vec2{ -0.5f, 0.0f }, Vec2{ -0.25f, -0.43f },
+                       Vec2{ 0.25f, -0.43f } } };
+    Capsule capsule{ 1.0f, 0.25f, true };
+    Circle circle{ 0.4f };
+
+    struct Pair
+    {
+        const char* name;
+        const Shape* a;
+        const Shape* b;
+    };
+
+    Pair pairs[] = {
+        { "box-box", &box, &box },
+        { "hexagon-hexagon", &hexagon, &hexagon },
+        { "hexagon-capsule", &hexagon, &capsule },
+        { "capsule-circle", &capsule, &circle },
+    };
+
+    std::vector<QueryCase> cases = CreateQueryCases();
+
+    printf("%-16s %10s %10s %10s %10s\n", "pair", "gjk(ns)", "collide", "distance", "cast");
+
+    for (const Pair& pair : pairs)
+    {
+        double times[4];
+        int32 hits = 0;
+
+        GJKResult gjkResult;
+        ContactManifold manifold;
+        ShapeCastOutput castOutput;
+        Vec2 pointA, pointB;
+
+        for (int32 query = 0; query < 4; ++query)
+        {
+            double begin = GetTime();
+            for (int32 r = 0; r < repeat_count; ++r)
+            {
+                for (const QueryCase& c : cases)
+                {
+                    switch (query)
+                    {
+                    case 0:
+                        hits += GJK(pair.a, c.tfA, pair.b, c.tfB, &gjkResult);
+                        break;
+                    case 1:
+                        hits += ConvexVsConvex(pair.a, c.tfA, pair.b, c.tfB, &manifold);
+                        break;
+                    case 2:
+                        hits += ComputeDistance(pair.a, c.tfA, pair.b, c.tfB, &pointA, &pointB) > 0.0f;
+                        break;
+                    case 3:
+                        hits += ShapeCast(pair.a, c.tfA, pair.b, c.tfB, c.translation, Vec2::zero, &castOutput);
+                        break;
+                    }
+                }
+            }
+            times[query] = (GetTime() - begin) / (repeat_count * cases.size());
+        }
+
+        printf(
+            "%-16s %10.1f %10.1f %10.1f %10.1f\n", pair.name, times[0] * 1e9, times[1] * 1e9, times[2] * 1e9, times[3] * 1e9
+        );
+        MuliNotUsed(hits);
+    }
+}
+
+static int index = register_benchmark("convex_queries", ConvexQueriesBenchmark);
+
+} // namespace muli
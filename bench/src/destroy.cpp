@@ -0,0 +1,58 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Destroying half of the bodies in the frame they were created, while all proxies are still in the move buffer
+static void DestroyBenchmark()
+{
+    int32 bodyCounts[] = { 2000, 20000 };
+
+    printf("%8s %16s %14s\n", "bodies", "one by one(ms)", "bulk(ms)");
+
+    for (int32 bodyCount : bodyCounts)
+    {
+        double times[2];
+
+        for (int32 bulk = 0; bulk < 2; ++bulk)
+        {
+            WorldSettings settings;
+            World world{ settings };
+
+            Srand(1);
+            float range = Sqrt(float(bodyCount));
+
+            std::vector<RigidBody*> bodies;
+            for (int32 i = 0; i < bodyCount; ++i)
+            {
+                RigidBody* b = world.CreateBox(0.4f);
+                b->SetPosition(Rand(-range, range), Rand(-range, range));
+
+                if (i % 2 == 0)
+                {
+                    bodies.push_back(b);
+                }
+            }
+
+            double begin = GetTime();
+            if (bulk)
+            {
+                world.Destroy(bodies);
+            }
+            else
+            {
+                for (RigidBody* b : bodies)
+                {
+                    world.Destroy(b);
+                }
+            }
+            times[bulk] = GetTime() - begin;
+        }
+
+        printf("%8d %16.3f %14.3f\n", bodyCount, times[0] * 1000.0, times[1] * 1000.0);
+    }
+}
+
+static int index = register_benchmark("destroy", DestroyBenchmark);
+
+} // namespace muli
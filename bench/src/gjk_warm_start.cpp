@@ -0,0 +1,185 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+static Polygon CreateRegularPolygon(int32 count, float radius)
+{
+    Vec2 vertices[max_local_polygon_vertices];
+    for (int32 i = 0; i < count; ++i)
+    {
+        float angle = 2.0f * pi * i / count;
+        vertices[i] = Vec2{ cosf(angle), sinf(angle) } * radius;
+    }
+
+    return Polygon{ vertices, count };
+}
+
+// Pair of shapes moving slowly relative to each other over many frames
+struct DistancePair
+{
+    Transform tfA;
+    Vec2 position;
+    float angle;
+    Vec2 velocity;
+    float angularVelocity;
+};
+
+static std::vector<DistancePair> CreateDistancePairs()
+{
+    Srand(1);
+
+    std::vector<DistancePair> pairs(2000);
+    for (DistancePair& p : pairs)
+    {
+        p.tfA = Transform{ Vec2{ Rand(-0.5f, 0.5f), Rand(-0.5f, 0.5f) }, Rand(0.0f, pi) };
+        float direction = Rand(0.0f, 2.0f * pi);
+        p.position = Vec2{ cosf(direction), sinf(direction) } * Rand(1.2f, 2.5f);
+        p.angle = Rand(0.0f, pi);
+        p.velocity = Vec2{ Rand(-0.01f, 0.01f), Rand(-0.01f, 0.01f) };
+        p.angularVelocity = Rand(-0.02f, 0.02f);
+    }
+
+    return pairs;
+}
+
+struct WarmStartResult
+{
+    double time;
+    float iterations;
+};
+
+// Closest features of every pair at each frame, cold or seeded by the cache of the last frame
+static WarmStartResult MeasureClosestFeatures(const Shape* a, const Shape* b, bool warmStart)
+{
+    constexpr int32 frame_count = 200;
+
+    std::vector<DistancePair> pairs = CreateDistancePairs();
+    std::vector<SimplexCache> caches(pairs.size());
+
+    int64 iterations = 0;
+    ClosestFeatures features;
+
+    double begin = GetTime();
+    for (int32 frame = 0; frame < frame_count; ++frame)
+    {
+        for (size_t i = 0; i < pairs.size(); ++i)
+        {
+            DistancePair& p = pairs[i];
+            Transform tfB{ p.position + p.velocity * float(frame), p.angle + p.angularVelocity * frame };
+
+            GetClosestFeatures(a, p.tfA, b, tfB, &features, warmStart ? &caches[i] : nullptr);
+            iterations += features.iterations;
+        }
+    }
+
+    WarmStartResult result;
+    result.time = (GetTime() - begin) / (frame_count * pairs.size());
+    result.iterations = float(iterations) / (frame_count * pairs.size());
+
+    return result;
+}
+
+// Shapes flying past and into a target, the time of impact of each frame computed with or without a cache kept across frames
+static WarmStartResult MeasureTimeOfImpact(const Shape* a, const Shape* b, bool warmStart, int32* hits)
+{
+    constexpr int32 frame_count = 40;
+    constexpr int32 sweep_count = 2000;
+
+    Srand(2);
+
+    int64 gjkCalls = 0;
+    int64 iterations = 0;
+    *hits = 0;
+
+    double time = 0.0;
+    for (int32 i = 0; i < sweep_count; ++i)
+    {
+        Vec2 start{ -10.0f, Rand(-1.5f, 1.5f) };
+        Vec2 step{ Rand(0.4f, 0.6f), Rand(-0.02f, 0.02f) };
+        float angle = Rand(0.0f, pi);
+        float spin = Rand(-0.1f, 0.1f);
+
+        Sweep sweepA{ identity };
+        SimplexCache cache;
+
+        double begin = GetTime();
+        for (int32 frame = 0; frame < frame_count; ++frame)
+        {
+            Sweep sweepB{ identity };
+            sweepB.c0 = start + step * float(frame);
+            sweepB.c = sweepB.c0 + step;
+            sweepB.a0 = angle + spin * frame;
+            sweepB.a = sweepB.a0 + spin;
+
+            TOIOutput output;
+            ComputeTimeOfImpact(a, sweepA, b, sweepB, 1.0f, &output, warmStart ? &cache : nullptr);
+
+            gjkCalls += output.gjkCalls;
+            iterations += output.gjkIterations;
+
+            if (output.state == TOIOutput::touching)
+            {
+                ++*hits;
+                break;
+            }
+        }
+        time += GetTime() - begin;
+    }
+
+    WarmStartResult result;
+    result.time = time / sweep_count;
+    result.iterations = float(iterations) / gjkCalls;
+
+    return result;
+}
+
+// Gjk support points evaluated per call with and without the simplex cache
+static void GJKWarmStartBenchmark()
+{
+    Polygon octagon = CreateRegularPolygon(8, 0.5f);
+    Polygon box{ 0.8f };
+    Capsule capsule{ 1.0f, 0.25f, true };
+
+    struct Pair
+    {
+        const char* name;
+        const Shape* a;
+        const Shape* b;
+    };
+
+    Pair pairs[] = {
+        { "octagon-octagon", &octagon, &octagon },
+        { "octagon-box", &octagon, &box },
+        { "octagon-capsule", &octagon, &capsule },
+    };
+
+    printf("closest features\n");
+    printf("%-16s %-6s %10s %11s\n", "pair", "cache", "call(ns)", "iterations");
+
+    for (const Pair& pair : pairs)
+    {
+        for (bool warmStart : { false, true })
+        {
+            WarmStartResult r = MeasureClosestFeatures(pair.a, pair.b, warmStart);
+            printf("%-16s %-6s %10.1f %11.3f\n", pair.name, warmStart ? "on" : "off", r.time * 1e9, r.iterations);
+        }
+    }
+
+    printf("\ntime of impact\n");
+    printf("%-16s %-6s %10s %11s %6s\n", "pair", "cache", "sweep(ns)", "iterations", "hits");
+
+    for (const Pair& pair : pairs)
+    {
+        for (bool warmStart : { false, true })
+        {
+            int32 hits;
+            WarmStartResult r = MeasureTimeOfImpact(pair.a, pair.b, warmStart, &hits);
+            printf("%-16s %-6s %10.1f %11.3f %6d\n", pair.name, warmStart ? "on" : "off", r.time * 1e9, r.iterations, hits);
+        }
+    }
+}
+
+static int index = register_benchmark("gjk_warm_start", GJKWarmStartBenchmark);
+
+} // namespace muli
@@ -0,0 +1,30 @@
+#include "benchmark.h"
+
+using namespace muli;
+
+// Usage: benchmark [name...]
+// Runs all registered benchmarks if no name is given
+int main(int argc, char** argv)
+{
+    std::sort(benchmarks.begin(), benchmarks.end(), [](const BenchmarkFrame& l, const BenchmarkFrame& r) {
+        return strcmp(l.name, r.name) < 0;
+    });
+
+    for (const BenchmarkFrame& benchmark : benchmarks)
+    {
+        bool selected = argc == 1;
+        for (int32 i = 1; i < argc; ++i)
+        {
+            selected |= strcmp(argv[i], benchmark.name) == 0;
+        }
+
+        if (selected)
+        {
+            printf("[%s]\n", benchmark.name);
+            benchmark.function();
+            printf("\n");
+        }
+    }
+
+    return 0;
+}
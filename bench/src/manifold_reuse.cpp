@@ -0,0 +1,86 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Pyramid of boxes resting on the ground
+static RigidBody* CreateBoxPyramid(World& world, int32 rows)
+{
+    world.CreateBox(200.0f, 1.0f, RigidBody::Type::static_body)->SetPosition(0.0f, -0.5f);
+
+    RigidBody* top = nullptr;
+    for (int32 y = 0; y < rows; ++y)
+    {
+        for (int32 x = 0; x < rows - y; ++x)
+        {
+            top = world.CreateBox(1.0f);
+            top->SetPosition((x - (rows - y) * 0.5f) * 1.05f, 0.5f + y * 1.0f);
+        }
+    }
+
+    return top;
+}
+
+struct ReuseResult
+{
+    double stepTime;
+    float hitRate;
+    float topDrift;
+};
+
+static ReuseResult MeasureManifoldReuse(bool reuse)
+{
+    constexpr int32 rows = 30;
+    constexpr int32 settle_steps = 300;
+    constexpr int32 step_count = 600;
+    constexpr float dt = 1.0f / 60.0f;
+
+    WorldSettings settings;
+    settings.sleeping = false;
+    settings.manifold_reuse = reuse;
+
+    World world{ settings };
+    RigidBody* top = CreateBoxPyramid(world, rows);
+
+    for (int32 i = 0; i < settle_steps; ++i)
+    {
+        world.Step(dt);
+    }
+
+    Vec2 settled = top->GetPosition();
+    int64 pairs = 0;
+    int64 reused = 0;
+
+    double begin = GetTime();
+    for (int32 i = 0; i < step_count; ++i)
+    {
+        world.Step(dt);
+
+        const BroadPhaseStats& stats = world.GetBroadPhaseStats();
+        pairs += stats.pairs;
+        reused += stats.reusedPairs;
+    }
+
+    ReuseResult result;
+    result.stepTime = (GetTime() - begin) / step_count;
+    result.hitRate = pairs > 0 ? float(reused) / pairs : 0.0f;
+    result.topDrift = Dist(settled, top->GetPosition());
+
+    return result;
+}
+
+// Step time of a resting pile with and without reusing the manifolds of the contacts whose bodies barely move
+static void ManifoldReuseBenchmark()
+{
+    printf("%-8s %10s %9s %12s\n", "reuse", "step(ms)", "hit rate", "top drift");
+
+    for (bool reuse : { false, true })
+    {
+        ReuseResult r = MeasureManifoldReuse(reuse);
+        printf("%-8s %10.3f %8.1f%% %12.6f\n", reuse ? "on" : "off", r.stepTime * 1000.0, r.hitRate * 100.0f, r.topDrift);
+    }
+}
+
+static int index = register_benchmark("manifold_reuse", ManifoldReuseBenchmark);
+
+} // namespace muli
@@ -0,0 +1,216 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// 1000 bodies tumbling in a rotating drum, most proxies leave their fat aabbs every few steps
+static void CreateDrum(World& world)
+{
+    float r = 11.0f;
+    int32 segments = 40;
+
+    RigidBody* drum = world.CreateEmptyBody(RigidBody::Type::kinematic_body);
+    for (int32 i = 0; i < segments; ++i)
+    {
+        float a0 = 2.0f * pi * i / segments;
+        float a1 = 2.0f * pi * (i + 1) / segments;
+
+        Capsule wall{ Vec2{ Cos(a0), Sin(a0) } * r, Vec2{ Cos(a1), Sin(a1) } * r, 0.3f };
+        drum->CreateCollider(&wall);
+    }
+    drum->SetAngularVelocity(1.0f);
+
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        RigidBody* b = i % 2 ? world.CreateBox(0.3f) : world.CreateCircle(0.15f);
+        b->SetPosition(-7.5f + (i % 32) * 0.5f, -7.5f + (i / 32) * 0.45f);
+    }
+}
+
+struct RefitResult
+{
+    double stepTime;
+    float reinsertions;
+    float rebuiltLeaves;
+    float treeCost;
+};
+
+static RefitResult MeasureRefit(CreateFunction* create, WorldSettings::BroadPhaseType broadPhase)
+{
+    constexpr int32 warmup_steps = 60;
+    constexpr int32 step_count = 300;
+    constexpr float dt = 1.0f / 60.0f;
+
+    WorldSettings settings;
+    settings.sleeping = false;
+    settings.broad_phase = broadPhase;
+
+    World world{ settings };
+    create(world);
+
+    for (int32 i = 0; i < warmup_steps; ++i)
+    {
+        world.Step(dt);
+    }
+
+    RefitResult result{};
+
+    double begin = GetTime();
+    for (int32 i = 0; i < step_count; ++i)
+    {
+        world.Step(dt);
+
+        const BroadPhaseStats& stats = world.GetBroadPhaseStats();
+        result.reinsertions += stats.reinsertions;
+        result.rebuiltLeaves += stats.rebuiltLeaves;
+    }
+    result.stepTime = (GetTime() - begin) / step_count;
+
+    result.reinsertions /= step_count;
+    result.rebuiltLeaves /= step_count;
+    result.treeCost = world.GetDynamicTree().ComputeTreeCost();
+
+    return result;
+}
+
+struct OverlapCount
+{
+    int32 count = 0;
+
+    bool PairCallback(NodeProxy nodeA, Data* dataA, NodeProxy nodeB, Data* dataB)
+    {
+        MuliNotUsed(nodeA);
+        MuliNotUsed(dataA);
+        MuliNotUsed(nodeB);
+        MuliNotUsed(dataB);
+
+        ++count;
+        return true;
+    }
+};
+
+struct DriftResult
+{
+    double updateTime;
+    double pairTime;
+    float treeCost;
+    int32 rebuiltLeaves;
+};
+
+// Leaves drifting through a box with random velocities, every leaf leaves its fat aabb every few steps
+static DriftResult MeasureDrift(bool refit)
+{
+    constexpr int32 leaf_count = 10000;
+    constexpr int32 step_count = 300;
+
+    Srand(1);
+
+    float range = 50.0f;
+    Vec2 extents{ 0.25f };
+
+    AABBTree tree;
+    std::vector<NodeProxy> leaves(leaf_count);
+    std::vector<Vec2> positions(leaf_count);
+    std::vector<Vec2> velocities(leaf_count);
+
+    for (int32 i = 0; i < leaf_count; ++i)
+    {
+        positions[i] = Vec2{ Rand(-range, range), Rand(-range, range) };
+        velocities[i] = Vec2{ Rand(-0.1f, 0.1f), Rand(-0.1f, 0.1f) };
+        leaves[i] = tree.CreateNode(nullptr, AABB{ positions[i] - extents, positions[i] + extents });
+    }
+
+    DriftResult result{};
+
+    double begin = GetTime();
+    for (int32 step = 0; step < step_count; ++step)
+    {
+        for (int32 i = 0; i < leaf_count; ++i)
+        {
+            Vec2& p = positions[i];
+            Vec2& v = velocities[i];
+
+            p += v;
+            if (Abs(p.x) > range)
+            {
+                v.x = -v.x;
+            }
+            if (Abs(p.y) > range)
+            {
+                v.y = -v.y;
+            }
+
+            AABB aabb{ p - extents, p + extents };
+            if (refit)
+            {
+                tree.RefitNode(leaves[i], aabb, v, false);
+            }
+            else
+            {
+                tree.MoveNode(leaves[i], aabb, v, false);
+            }
+        }
+
+        if (refit)
+        {
+            result.rebuiltLeaves += tree.Refit();
+        }
+    }
+    result.updateTime = (GetTime() - begin) / step_count;
+
+    OverlapCount overlaps;
+
+    begin = GetTime();
+    tree.QueryPairs(&overlaps);
+    result.pairTime = GetTime() - begin;
+
+    result.treeCost = tree.ComputeTreeCost();
+
+    return result;
+}
+
+// Step time and tree quality of the dynamic tree reinserting the moved proxies and of the refit tree
+static void RefitTreeBenchmark()
+{
+    struct Scene
+    {
+        const char* name;
+        CreateFunction* create;
+    };
+
+    Scene scenes[] = {
+        { "drum", CreateDrum },
+        { "pile", CreatePile },
+    };
+
+    printf("%-8s %11s %9s %13s %10s\n", "drift", "update(ms)", "pairs(ms)", "rebuilt/step", "tree cost");
+
+    for (bool refit : { false, true })
+    {
+        DriftResult r = MeasureDrift(refit);
+
+        printf(
+            "%-8s %11.3f %9.3f %13.1f %10.0f\n", refit ? "refit" : "dynamic", r.updateTime * 1000.0, r.pairTime * 1000.0,
+            r.rebuiltLeaves / 300.0f, r.treeCost
+        );
+    }
+
+    printf("\n%-6s %-8s %9s %13s %13s %10s\n", "scene", "tree", "step(ms)", "moved/step", "rebuilt/step", "tree cost");
+
+    for (const Scene& scene : scenes)
+    {
+        for (WorldSettings::BroadPhaseType type : { WorldSettings::dynamic_tree, WorldSettings::refit_tree })
+        {
+            RefitResult r = MeasureRefit(scene.create, type);
+
+            printf(
+                "%-6s %-8s %9.3f %13.1f %13.1f %10.0f\n", scene.name, type == WorldSettings::refit_tree ? "refit" : "dynamic",
+                r.stepTime * 1000.0, r.reinsertions, r.rebuiltLeaves, r.treeCost
+            );
+        }
+    }
+}
+
+static int index = register_benchmark("refit_tree", RefitTreeBenchmark);
+
+} // namespace muli
@@ -0,0 +1,109 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// 140 ragdolls made of a box and 6 capsules connected by revolute joints
+static void CreateRagdolls(World& world)
+{
+    world.CreateCapsule(500.0f, 0.2f, true, RigidBody::Type::static_body);
+
+    for (int32 i = 0; i < 140; ++i)
+    {
+        float x = (i - 70) * 3.0f;
+
+        RigidBody* prev = world.CreateBox(0.5f);
+        prev->SetPosition(x, 1.0f);
+
+        for (int32 j = 0; j < 6; ++j)
+        {
+            RigidBody* limb = world.CreateCapsule(0.4f, 0.1f);
+            limb->SetPosition(x + 0.3f * (j + 1), 1.5f + 0.5f * j);
+            world.CreateRevoluteJoint(prev, limb, limb->GetPosition());
+            prev = limb;
+        }
+    }
+}
+
+// Single island pyramid of 12880 boxes, its body state is larger than the L2 cache
+static void CreateLargePyramid(World& world)
+{
+    world.CreateCapsule(200.0f, 0.2f, true, RigidBody::Type::static_body);
+
+    int32 rows = 160;
+    float size = 0.4f;
+    float gap = 0.025f;
+
+    for (int32 y = 0; y < rows; ++y)
+    {
+        for (int32 x = 0; x < rows - y; ++x)
+        {
+            RigidBody* b = world.CreateBox(size);
+            b->SetPosition((x - (rows - y - 1) * 0.5f) * (size + gap), 0.2f + size * 0.5f + y * (size + gap));
+        }
+    }
+}
+
+// Step time with few and many velocity iterations
+// The difference isolates the cost of one velocity iteration over all constraints of the scene
+// Continuous collision is off, its time of impact events don't depend on the iterations and only add noise
+static void SolverBenchmark()
+{
+    constexpr int32 low_iterations = 10;
+    constexpr int32 high_iterations = 40;
+    constexpr int32 warmup_steps = 60;
+    constexpr int32 step_count = 60;
+
+    struct Scene
+    {
+        const char* name;
+        CreateFunction* create;
+    };
+
+    Scene scenes[] = {
+        { "pile", CreatePile },
+        { "pyramid", CreatePyramid },
+        { "ragdolls", CreateRagdolls },
+        { "large", CreateLargePyramid },
+    };
+
+    struct Solver
+    {
+        const char* name;
+        bool graphColoring;
+        bool wideSolver;
+    };
+
+    Solver solvers[] = {
+        { "serial", false, false },
+        { "colored", true, false },
+        { "wide", false, true },
+    };
+
+    printf("%10s %8s %14s %14s %22s\n", "scene", "solver", "step10(ms)", "step40(ms)", "velocity iteration(us)");
+
+    for (const Scene& scene : scenes)
+    {
+        for (const Solver& solver : solvers)
+        {
+            WorldSettings settings;
+            settings.continuous = false;
+            settings.graph_coloring = solver.graphColoring;
+            settings.wide_solver = solver.wideSolver;
+
+            settings.step.velocity_iterations = low_iterations;
+            double low = MeasureStep(scene.create, settings, warmup_steps, step_count);
+            settings.step.velocity_iterations = high_iterations;
+            double high = MeasureStep(scene.create, settings, warmup_steps, step_count);
+
+            printf(
+                "%10s %8s %14.3f %14.3f %22.2f\n", scene.name, solver.name, low * 1000.0, high * 1000.0,
+                (high - low) / (high_iterations - low_iterations) * 1000000.0
+            );
+        }
+    }
+}
+
+static int index = register_benchmark("solver", SolverBenchmark);
+
+} // namespace muli
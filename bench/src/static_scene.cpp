@@ -0,0 +1,103 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Bumpy terrain made of many small static pieces
+static void CreateTerrain(World& world)
+{
+    constexpr int32 piece_count = 2000;
+    constexpr float piece_width = 0.5f;
+
+    for (int32 i = 0; i < piece_count; ++i)
+    {
+        float x = (i - piece_count / 2) * piece_width;
+        float y = Sin(i * 0.05f) * 2.0f + Sin(i * 0.31f) * 0.3f;
+
+        RigidBody* b = world.CreateBox(piece_width, 0.4f, RigidBody::Type::static_body);
+        b->SetPosition(x, y);
+        b->SetRotation(Cos(i * 0.05f) * 0.1f);
+    }
+}
+
+static void CreateBodies(World& world, uint32 seed)
+{
+    Srand(seed);
+
+    for (int32 i = 0; i < 100; ++i)
+    {
+        RigidBody* b = i % 2 ? world.CreateBox(0.4f) : world.CreateCircle(0.2f);
+        b->SetPosition(Rand(-400.0f, 400.0f), Rand(4.0f, 8.0f));
+    }
+}
+
+// Many worlds on the same terrain, each world holding its own copy versus sharing a static scene
+static void StaticSceneBenchmark()
+{
+    constexpr int32 world_count = 64;
+    constexpr int32 step_count = 60;
+    constexpr float dt = 1.0f / 60.0f;
+
+    WorldSettings settings;
+
+    World source{ settings };
+    CreateTerrain(source);
+
+    double begin = GetTime();
+    StaticScene scene{ source };
+    double sceneTime = GetTime() - begin;
+
+    printf(
+        "%d worlds x %d steps, %d static colliders, scene built in %.2fms\n", world_count, step_count, scene.GetColliderCount(),
+        sceneTime * 1000.0
+    );
+    printf("%8s %14s %12s %18s %10s\n", "mode", "create(ms)", "step(ms)", "static colliders", "contacts");
+
+    WorldPool pool{ GetWorkerCounts().back() };
+
+    for (int32 shared = 0; shared < 2; ++shared)
+    {
+        std::vector<World*> worlds(world_count);
+
+        begin = GetTime();
+        for (int32 i = 0; i < world_count; ++i)
+        {
+            if (shared)
+            {
+                worlds[i] = new World(settings, &scene);
+            }
+            else
+            {
+                worlds[i] = new World(settings);
+                CreateTerrain(*worlds[i]);
+            }
+        }
+        double createTime = GetTime() - begin;
+
+        for (int32 i = 0; i < world_count; ++i)
+        {
+            CreateBodies(*worlds[i], uint32(i));
+        }
+
+        begin = GetTime();
+        pool.Step(worlds, dt, step_count);
+        double stepTime = GetTime() - begin;
+
+        int32 staticColliders = shared ? 0 : scene.GetColliderCount() * world_count;
+        int32 contacts = 0;
+        for (World* world : worlds)
+        {
+            contacts += world->GetContactCount();
+            delete world;
+        }
+
+        printf(
+            "%8s %14.2f %12.2f %18d %10d\n", shared ? "shared" : "copied", createTime * 1000.0, stepTime * 1000.0, staticColliders,
+            contacts
+        );
+    }
+}
+
+static int index = register_benchmark("static_scene", StaticSceneBenchmark);
+
+} // namespace muli
@@ -0,0 +1,71 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Side scrolling level, a long floor of static pieces with platforms and 1000 bodies spread along it
+static void CreateLevel(World& world)
+{
+    constexpr int32 floor_pieces = 1000;
+    constexpr float piece_width = 1.0f;
+
+    Srand(1);
+
+    for (int32 i = 0; i < floor_pieces; ++i)
+    {
+        RigidBody* b = world.CreateBox(piece_width, 0.4f, RigidBody::Type::static_body);
+        b->SetPosition((i - floor_pieces / 2) * piece_width, 0.0f);
+
+        if (i % 10 == 0)
+        {
+            RigidBody* p = world.CreateBox(4.0f, 0.2f, RigidBody::Type::static_body);
+            p->SetPosition((i - floor_pieces / 2) * piece_width, Rand(2.0f, 4.0f));
+        }
+    }
+
+    for (int32 i = 0; i < 1000; ++i)
+    {
+        RigidBody* b = i % 2 ? world.CreateBox(0.4f) : world.CreateCircle(0.2f);
+        b->SetPosition(Rand(-480.0f, 480.0f), Rand(1.0f, 8.0f));
+        b->SetLinearVelocity(Vec2{ Rand(-5.0f, 5.0f), 0.0f });
+    }
+}
+
+// Step time with the dynamic tree and the sweep and prune broad phase
+static void SweepAndPruneBenchmark()
+{
+    struct Scene
+    {
+        const char* name;
+        CreateFunction* create;
+    };
+
+    Scene scenes[] = {
+        { "pile", CreatePile },
+        { "pyramid", CreatePyramid },
+        { "level", CreateLevel },
+    };
+
+    constexpr int32 warmup_steps = 60;
+    constexpr int32 step_count = 120;
+
+    for (const Scene& scene : scenes)
+    {
+        WorldSettings settings;
+        int32 treeContacts, sapContacts;
+
+        settings.broad_phase = WorldSettings::dynamic_tree;
+        double tree = MeasureStep(scene.create, settings, warmup_steps, step_count, &treeContacts);
+        settings.broad_phase = WorldSettings::sweep_and_prune;
+        double sap = MeasureStep(scene.create, settings, warmup_steps, step_count, &sapContacts);
+
+        printf(
+            "%-8s tree %.3fms (%d contacts), sweep and prune %.3fms (%d contacts)\n", scene.name, tree * 1000.0, treeContacts,
+            sap * 1000.0, sapContacts
+        );
+    }
+}
+
+static int index = register_benchmark("sweep_and_prune", SweepAndPruneBenchmark);
+
+} // namespace muli
@@ -0,0 +1,110 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Pairs found by querying the tree for each moved leaf, the pair of two moved leaves is counted by the greater one
+struct MovedLeafQuery
+{
+    const AABBTree* tree;
+    NodeProxy node;
+    int32 count = 0;
+
+    bool QueryCallback(NodeProxy other, Data* data)
+    {
+        MuliNotUsed(data);
+
+        if (other != node && (tree->WasMoved(other) == false || other < node))
+        {
+            ++count;
+        }
+        return true;
+    }
+};
+
+struct PairCount
+{
+    int32 count = 0;
+
+    bool PairCallback(NodeProxy nodeA, Data* dataA, NodeProxy nodeB, Data* dataB)
+    {
+        MuliNotUsed(nodeA);
+        MuliNotUsed(dataA);
+        MuliNotUsed(nodeB);
+        MuliNotUsed(dataB);
+
+        ++count;
+        return true;
+    }
+};
+
+// Pair search time of a query per moved leaf and of the simultaneous descent
+static void TreePairsBenchmark()
+{
+    int32 leafCounts[] = { 1000, 10000, 100000 };
+    float movedRatios[] = { 1.0f, 0.1f, 0.01f };
+
+    printf("%8s %8s %8s %12s %12s\n", "leaves", "moved", "pairs", "queries(ms)", "pairs(ms)");
+
+    for (int32 leafCount : leafCounts)
+    {
+        for (float movedRatio : movedRatios)
+        {
+            Srand(1);
+
+            // Densely packed boxes, as in a pile of bodies
+            float range = Sqrt(float(leafCount)) * 0.5f;
+
+            AABBTree tree;
+            std::vector<NodeProxy> leaves(leafCount);
+            for (int32 i = 0; i < leafCount; ++i)
+            {
+                Vec2 p{ Rand(-range, range), Rand(-range, range) };
+                Vec2 extents{ Rand(0.1f, 0.4f), Rand(0.1f, 0.4f) };
+
+                leaves[i] = tree.CreateNode(nullptr, AABB{ p - extents, p + extents });
+            }
+
+            std::vector<NodeProxy> moved;
+            for (NodeProxy leaf : leaves)
+            {
+                if (Rand(0.0f, 1.0f) < movedRatio)
+                {
+                    moved.push_back(leaf);
+                }
+                else
+                {
+                    tree.ClearMoved(leaf);
+                }
+            }
+
+            MovedLeafQuery query;
+            query.tree = &tree;
+
+            double begin = GetTime();
+            for (NodeProxy leaf : moved)
+            {
+                query.node = leaf;
+                tree.Query(tree.GetAABB(leaf), &query);
+            }
+            double queryTime = GetTime() - begin;
+
+            PairCount pairs;
+
+            begin = GetTime();
+            tree.QueryPairs(&pairs, true);
+            double pairTime = GetTime() - begin;
+
+            MuliAssert(query.count == pairs.count);
+
+            printf(
+                "%8d %8d %8d %12.3f %12.3f\n", leafCount, int32(moved.size()), pairs.count, queryTime * 1000.0,
+                pairTime * 1000.0
+            );
+        }
+    }
+}
+
+static int index = register_benchmark("tree_pairs", TreePairsBenchmark);
+
+} // namespace muli
@@ -0,0 +1,52 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Tree cost of incremental insertion versus the binned SAH and the linear rebuilds, and the rebuild times
+static void TreeRebuildBenchmark()
+{
+    int32 leafCounts[] = { 1000, 10000, 100000 };
+
+    printf(
+        "%8s %16s %16s %12s %16s %12s\n", "leaves", "inserted cost", "sah cost", "sah(ms)", "linear cost", "linear(ms)"
+    );
+
+    for (int32 leafCount : leafCounts)
+    {
+        Srand(1);
+
+        // Small boxes scattered over an area that grows with the leaf count
+        float range = Sqrt(float(leafCount));
+
+        AABBTree tree;
+        for (int32 i = 0; i < leafCount; ++i)
+        {
+            Vec2 p{ Rand(-range, range), Rand(-range, range) };
+            Vec2 extents{ Rand(0.1f, 0.5f), Rand(0.1f, 0.5f) };
+
+            tree.CreateNode(nullptr, AABB{ p - extents, p + extents });
+        }
+
+        float insertedCost = tree.ComputeTreeCost();
+
+        double begin = GetTime();
+        tree.Rebuild();
+        double sahTime = GetTime() - begin;
+        float sahCost = tree.ComputeTreeCost();
+
+        begin = GetTime();
+        tree.RebuildLinear();
+        double linearTime = GetTime() - begin;
+        float linearCost = tree.ComputeTreeCost();
+
+        printf(
+            "%8d %16.1f %16.1f %12.3f %16.1f %12.3f\n", leafCount, insertedCost, sahCost, sahTime * 1000.0, linearCost,
+            linearTime * 1000.0
+        );
+    }
+}
+
+static int index = register_benchmark("tree_rebuild", TreeRebuildBenchmark);
+
+} // namespace muli
@@ -0,0 +1,105 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Circles of the same size dropped into a square container
+static void CreateCircles(World& world, int32 count, float size)
+{
+    Srand(1);
+
+    float h = size / 2.0f;
+    world.CreateCapsule(Vec2{ -h, -h }, Vec2{ h, -h }, 0.2f, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ h, -h }, Vec2{ h, h }, 0.2f, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ h, h }, Vec2{ -h, h }, 0.2f, RigidBody::Type::static_body);
+    world.CreateCapsule(Vec2{ -h, h }, Vec2{ -h, -h }, 0.2f, RigidBody::Type::static_body);
+
+    for (int32 i = 0; i < count; ++i)
+    {
+        RigidBody* b = world.CreateCircle(0.22f);
+        b->SetPosition(Rand(-h + 0.5f, h - 0.5f), Rand(-h + 0.5f, h - 0.5f));
+    }
+}
+
+static void CreateCircles1000(World& world)
+{
+    CreateCircles(world, 1000, 15.0f);
+}
+
+// Cloud of kinematic particles drifting around, only the broad phase has work to do
+static void CreateParticles(World& world)
+{
+    Srand(1);
+
+    for (int32 i = 0; i < 10000; ++i)
+    {
+        RigidBody* b = world.CreateCircle(0.22f, RigidBody::Type::kinematic_body);
+        b->SetPosition(Rand(-50.0f, 50.0f), Rand(-50.0f, 50.0f));
+        b->SetLinearVelocity(Rand(-2.0f, 2.0f), Rand(-2.0f, 2.0f));
+    }
+}
+
+// Large polygon thrown into a cloud of circles without gravity
+static void CreateDense(World& world)
+{
+    Srand(1);
+
+    float r = 0.25f;
+    float spread = 10.0f;
+
+    RigidBody* b = world.CreateRandomConvexPolygon(spread / 2.0f, 7);
+    b->SetPosition(-25.0, 0.0f);
+    b->SetLinearVelocity(40.0f, 0.0f);
+    b->SetAngularVelocity(1.0f);
+    b->SetContinuous(true);
+
+    for (int32 i = 0; i < 500; ++i)
+    {
+        RigidBody* c = world.CreateCircle(r);
+        c->SetPosition(Rand(0.0f, spread * 1.414f), Rand(0.0f, spread * 0.9f) - spread / 2.0f);
+        c->SetLinearDamping(0.1f);
+    }
+}
+
+// Step time of the circle workloads with each broad phase type
+static void UniformGridBenchmark()
+{
+    constexpr int32 warmup_steps = 30;
+    constexpr int32 step_count = 120;
+
+    struct Scene
+    {
+        const char* name;
+        CreateFunction* create;
+        bool gravity;
+    };
+
+    Scene scenes[] = {
+        { "circles_1000", CreateCircles1000, true },
+        { "particles_10000", CreateParticles, false },
+        { "dense", CreateDense, false },
+    };
+
+    const char* names[] = { "tree", "sweep and prune", "grid" };
+
+    for (const Scene& scene : scenes)
+    {
+        printf("%s\n", scene.name);
+
+        for (int32 i = 0; i < 3; ++i)
+        {
+            WorldSettings settings;
+            settings.apply_gravity = scene.gravity;
+            settings.broad_phase = WorldSettings::BroadPhaseType(i);
+
+            int32 contactCount;
+            double t = MeasureStep(scene.create, settings, warmup_steps, step_count, &contactCount);
+
+            printf("  %-16s %.3fms, %d contacts\n", names[i], t * 1000.0, contactCount);
+        }
+    }
+}
+
+static int index = register_benchmark("uniform_grid", UniformGridBenchmark);
+
+} // namespace muli
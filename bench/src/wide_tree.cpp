@@ -0,0 +1,126 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+struct CountQuery
+{
+    int32 count = 0;
+
+    bool QueryCallback(NodeProxy node, Data* data)
+    {
+        MuliNotUsed(node);
+        MuliNotUsed(data);
+
+        ++count;
+        return true;
+    }
+};
+
+struct CountCast
+{
+    int32 count = 0;
+
+    float AABBCastCallback(const AABBCastInput& input, Data* data)
+    {
+        MuliNotUsed(data);
+
+        ++count;
+        return input.maxFraction;
+    }
+};
+
+// Query and cast time of the binary tree and its wide copy
+static void WideTreeBenchmark()
+{
+    constexpr int32 query_count = 100000;
+    constexpr int32 cast_count = 10000;
+
+    int32 leafCounts[] = { 1000, 10000, 100000 };
+
+    printf("wide nodes have %d children\n", simd_width);
+    printf("%8s %10s %18s %18s %18s\n", "leaves", "build(ms)", "query(ms)", "point(ms)", "cast(ms)");
+
+    for (int32 leafCount : leafCounts)
+    {
+        Srand(1);
+
+        // Small boxes scattered over an area that grows with the leaf count
+        float range = Sqrt(float(leafCount));
+
+        AABBTree tree;
+        for (int32 i = 0; i < leafCount; ++i)
+        {
+            Vec2 p{ Rand(-range, range), Rand(-range, range) };
+            Vec2 extents{ Rand(0.1f, 0.5f), Rand(0.1f, 0.5f) };
+
+            tree.CreateNode(nullptr, AABB{ p - extents, p + extents });
+        }
+
+        double begin = GetTime();
+        WideAABBTree wideTree;
+        wideTree.Build(tree);
+        double buildTime = GetTime() - begin;
+
+        std::vector<AABB> boxes(query_count);
+        for (AABB& box : boxes)
+        {
+            Vec2 p{ Rand(-range, range), Rand(-range, range) };
+            box = AABB{ p - Vec2{ 0.5f }, p + Vec2{ 0.5f } };
+        }
+
+        std::vector<AABBCastInput> casts(cast_count);
+        for (AABBCastInput& cast : casts)
+        {
+            cast.from = Vec2{ Rand(-range, range), Rand(-range, range) };
+            cast.to = cast.from + Vec2{ Rand(-10.0f, 10.0f), Rand(-10.0f, 10.0f) };
+            cast.maxFraction = 1.0f;
+            cast.halfExtents = Vec2{ 0.1f };
+        }
+
+        auto measure = [&](auto* t, int32* hits) -> Vec3 {
+            Vec3 time;
+
+            CountQuery query;
+            begin = GetTime();
+            for (const AABB& box : boxes)
+            {
+                t->Query(box, &query);
+            }
+            time.x = float(GetTime() - begin);
+
+            begin = GetTime();
+            for (const AABB& box : boxes)
+            {
+                t->Query(box.GetCenter(), &query);
+            }
+            time.y = float(GetTime() - begin);
+
+            CountCast cast;
+            begin = GetTime();
+            for (const AABBCastInput& input : casts)
+            {
+                t->AABBCast(input, &cast);
+            }
+            time.z = float(GetTime() - begin);
+
+            *hits = query.count + cast.count;
+            return time;
+        };
+
+        int32 hits, wideHits;
+        Vec3 binary = measure(&tree, &hits);
+        Vec3 wide = measure(&wideTree, &wideHits);
+
+        MuliAssert(hits == wideHits);
+
+        printf(
+            "%8d %10.3f %8.2f -> %6.2f %8.2f -> %6.2f %8.2f -> %6.2f\n", leafCount, buildTime * 1000.0, binary.x * 1000.0,
+            wide.x * 1000.0, binary.y * 1000.0, wide.y * 1000.0, binary.z * 1000.0, wide.z * 1000.0
+        );
+    }
+}
+
+static int index = register_benchmark("wide_tree", WideTreeBenchmark);
+
+} // namespace muli
@@ -0,0 +1,87 @@
+#include "benchmark.h"
+
+namespace muli
+{
+
+// Small pyramid with a few circles dropped on it
+static void CreateSmallScene(World& world, uint32 seed)
+{
+    Srand(seed);
+
+    world.CreateCapsule(20.0f, 0.2f, true, RigidBody::Type::static_body);
+
+    int32 rows = 6;
+    float boxSize = 0.4f;
+    float gap = 0.03f * boxSize / 0.5f;
+    float xStart = -(rows - 1.0f) * (boxSize + gap) / 2.0f;
+    float yStart = 0.2f + boxSize / 2.0f + gap;
+
+    for (int32 y = 0; y < rows; ++y)
+    {
+        for (int32 x = 0; x < rows - y; ++x)
+        {
+            RigidBody* b = world.CreateBox(boxSize);
+            b->SetPosition(xStart + y * (boxSize + gap) / 2.0f + x * (boxSize + gap), yStart + y * (boxSize + gap));
+        }
+    }
+
+    for (int32 i = 0; i < 10; ++i)
+    {
+        RigidBody* c = world.CreateCircle(0.15f);
+        c->SetPosition(Rand(-2.0f, 2.0f), Rand(4.0f, 8.0f));
+    }
+}
+
+// Steps many small independent worlds across the pool workers
+static void WorldPoolBenchmark()
+{
+    constexpr int32 world_count = 512;
+    constexpr int32 step_count = 60;
+    constexpr float dt = 1.0f / 60.0f;
+
+    // Shared by all worlds, the worlds never write to their settings
+    WorldSettings settings;
+
+    printf("%d worlds x %d steps\n", world_count, step_count);
+    printf("%8s %12s %16s %9s %11s %18s\n", "workers", "time(ms)", "world steps/s", "speedup", "efficiency", "checksum");
+
+    double serialTime = 0.0;
+
+    for (int32 workerCount : GetWorkerCounts())
+    {
+        std::vector<World*> worlds(world_count);
+        for (int32 i = 0; i < world_count; ++i)
+        {
+            worlds[i] = new World(settings);
+            CreateSmallScene(*worlds[i], uint32(i));
+        }
+
+        WorldPool pool{ workerCount };
+
+        double begin = GetTime();
+        pool.Step(worlds, dt, step_count);
+        double time = GetTime() - begin;
+
+        if (workerCount == 1)
+        {
+            serialTime = time;
+        }
+
+        uint64 checksum = 0;
+        for (World* world : worlds)
+        {
+            checksum = checksum * 31 + ComputeChecksum(*world);
+            delete world;
+        }
+
+        double speedup = serialTime / time;
+        printf(
+            "%8d %12.2f %16.0f %8.2fx %10.0f%% %18llx\n", workerCount, time * 1000.0, world_count * step_count / time, speedup,
+            speedup / workerCount * 100.0, (unsigned long long)checksum
+        );
+    }
+}
+
+static int index = register_benchmark("world_pool", WorldPoolBenchmark);
+
+} // namespace muli
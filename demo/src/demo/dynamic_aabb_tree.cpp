@@ -70,14 +70,23 @@ public:
 
                 game.RestartDemo();
             }
-            if (ImGui::Button("Rebuild bottom up"))
+            if (ImGui::Button("Rebuild (binned SAH)"))
             {
+                costBeforeRebuild = world->GetDynamicTree().ComputeTreeCost();
                 world->RebuildDynamicTree();
+                costAfterRebuild = world->GetDynamicTree().ComputeTreeCost();
+            }
+            if (costBeforeRebuild > 0.0f)
+            {
+                ImGui::Text("Last rebuild: %.4f -> %.4f", costBeforeRebuild, costAfterRebuild);
             }
         }
         ImGui::End();
     }
 
+    float costBeforeRebuild = 0.0f;
+    float costAfterRebuild = 0.0f;
+
     float Random(float left, float right)
     {
         return (rand() / (float)RAND_MAX) * (right - left) + left;
@@ -53,8 +53,6 @@ void Game::UpdateInput()
     demo->UpdateInput();
 }
 
-extern bool block_solve;
-
 void Game::UpdateUI()
 {
     // ImGui::DockSpaceOverViewport(ImGui::GetMainViewport(),
@@ -149,11 +147,16 @@ void Game::UpdateUI()
                         ImGui::SetNextItemWidth(120);
                         ImGui::SliderInt("Position", &settings.step.position_iterations, 0, 50);
                     }
-                    ImGui::Checkbox("Contact block solve", &block_solve);
+                    ImGui::Checkbox("Contact block solve", &settings.step.block_solve);
                     ImGui::Checkbox("Warm starting", &settings.step.warm_starting);
                     ImGui::Checkbox("Sleeping", &settings.sleeping);
                     ImGui::Checkbox("Continuous", &settings.continuous);
                     ImGui::Checkbox("Sub-stepping", &settings.sub_stepping);
+
+                    ImGui::SetNextItemWidth(120);
+                    ImGui::SliderInt("Workers", &settings.worker_count, 1, 16);
+                    ImGui::Checkbox("Graph coloring", &settings.graph_coloring);
+                    ImGui::Checkbox("Wide solver", &settings.wide_solver);
                 }
 
                 ImGui::Separator();
@@ -401,15 +404,18 @@ void Game::Render()
 
     if (options.show_bvh || options.show_aabb)
     {
-        const AABBTree& tree = world.GetDynamicTree();
-        tree.Traverse([&](const AABBTree::Node* n) -> void {
-            if (options.show_bvh == false && n->IsLeaf() == false)
-            {
-                return;
-            }
+        const AABBTree* trees[] = { &world.GetStaticTree(), &world.GetSleepingTree(), &world.GetDynamicTree() };
+        for (const AABBTree* tree : trees)
+        {
+            tree->Traverse([&](const AABBTree::Node* n) -> void {
+                if (options.show_bvh == false && n->IsLeaf() == false)
+                {
+                    return;
+                }
 
-            renderer.DrawAABB(n->aabb);
-        });
+                renderer.DrawAABB(n->aabb);
+            });
+        }
     }
 
     if (options.show_contact_point || options.show_contact_normal)
@@ -23,6 +23,9 @@ struct AABB
     bool TestRay(const Vec2& from, const Vec2& to, float tMin, float tMax, Vec2 margin = Vec2::zero) const;
     float RayCast(const Vec2& from, const Vec2& to, float tMin, float tMax, Vec2 margin = Vec2::zero) const;
 
+    // Extend towards the displacement and then by the margin on every side
+    void Fatten(const Vec2& displacement, const Vec2& margin);
+
     std::string ToString() const;
 
     Vec2 min;
@@ -80,6 +83,30 @@ inline bool AABB::TestOverlap(const AABB& other) const
     return true;
 }
 
+inline void AABB::Fatten(const Vec2& displacement, const Vec2& margin)
+{
+    if (displacement.x > 0.0f)
+    {
+        max.x += displacement.x;
+    }
+    else
+    {
+        min.x += displacement.x;
+    }
+
+    if (displacement.y > 0.0f)
+    {
+        max.y += displacement.y;
+    }
+    else
+    {
+        min.y += displacement.y;
+    }
+
+    max += margin;
+    min -= margin;
+}
+
 inline std::string AABB::ToString() const
 {
     return FormatString("min: %s\nmax: %s", min.ToString().c_str(), max.ToString().c_str());
@@ -41,7 +41,8 @@ public:
         NodeProxy child2;
 
         NodeProxy next;
-        bool moved;
+        bool moved;          // Internal nodes are flagged if any leaf below them is
+        uint32 categoryBits; // Collision filter bits of the leaf, internal nodes hold the union of the leaves below them
 
         Data* data; // user data
     };
@@ -57,34 +58,74 @@ public:
 
     void Reset();
 
-    NodeProxy CreateNode(Data* data, const AABB& aabb);
-    bool MoveNode(NodeProxy node, AABB aabb, const Vec2& displacement, bool forceMove);
+    NodeProxy CreateNode(Data* data, const AABB& aabb, uint32 categoryBits = all_categories);
+    // Insert a node with an already fattened aabb, e.g. taken over from another tree
+    NodeProxy InsertNode(Data* data, const AABB& fatAABB, bool moved, uint32 categoryBits = all_categories);
+    bool MoveNode(NodeProxy node, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin = aabb_margin);
+    // Same as MoveNode(), but the leaf is updated in place and its ancestors are only grown to contain it.
+    // Refit() tightens them again once the leaves of a step are moved
+    bool RefitNode(NodeProxy node, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin = aabb_margin);
     void RemoveNode(NodeProxy node);
+    // Remove many leaves together, the remaining ancestors are refitted once without rotations
+    void RemoveNodes(std::span<const NodeProxy> leaves);
 
     bool TestOverlap(NodeProxy nodeA, NodeProxy nodeB) const;
     const AABB& GetAABB(NodeProxy node) const;
     void ClearMoved(NodeProxy node) const;
     bool WasMoved(NodeProxy node) const;
     Data* GetData(NodeProxy node) const;
+    uint32 GetCategoryBits(NodeProxy node) const;
+    void SetCategoryBits(NodeProxy node, uint32 categoryBits);
 
     template <typename T>
     void Traverse(T* callback) const;
+    // The queries skip the subtrees without a leaf in the categoryMask
     template <typename T>
-    void Query(const Vec2& point, T* callback) const;
+    void Query(const Vec2& point, T* callback, uint32 categoryMask = all_categories) const;
     template <typename T>
-    void Query(const AABB& aabb, T* callback) const;
+    void Query(const AABB& aabb, T* callback, uint32 categoryMask = all_categories) const;
     template <typename T>
-    void AABBCast(const AABBCastInput& input, T* callback) const;
+    void AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask = all_categories) const;
+    // Calls callback->PairCallback(NodeProxy nodeA, Data* dataA, NodeProxy nodeB, Data* dataB) once for every pair of
+    // overlapping leaves until it returns false. Both sides are descended together, so each level is visited once.
+    // With movedOnly, the pairs of two leaves not moved since their last ClearMoved() are skipped
+    template <typename T>
+    void QueryPairs(T* callback, bool movedOnly = false) const;
+    // Same for the pairs of a leaf of this tree and a leaf of the other tree
+    template <typename T>
+    void QueryPairs(const AABBTree& other, T* callback, bool movedOnly = false) const;
 
     void Traverse(std::function<void(const Node*)> callback) const;
-    void Query(const Vec2& point, std::function<bool(NodeProxy, Data*)> callback) const;
-    void Query(const AABB& aabb, std::function<bool(NodeProxy, Data*)> callback) const;
-    void AABBCast(const AABBCastInput& input, std::function<float(const AABBCastInput& input, Data* data)> callback) const;
+    void Query(const Vec2& point, std::function<bool(NodeProxy, Data*)> callback, uint32 categoryMask = all_categories) const;
+    void Query(const AABB& aabb, std::function<bool(NodeProxy, Data*)> callback, uint32 categoryMask = all_categories) const;
+    void AABBCast(
+        const AABBCastInput& input,
+        std::function<float(const AABBCastInput& input, Data* data)> callback,
+        uint32 categoryMask = all_categories
+    ) const;
+    void QueryPairs(std::function<bool(NodeProxy, Data*, NodeProxy, Data*)> callback, bool movedOnly = false) const;
+    void QueryPairs(
+        const AABBTree& other, std::function<bool(NodeProxy, Data*, NodeProxy, Data*)> callback, bool movedOnly = false
+    ) const;
 
     float ComputeTreeCost() const;
     void Rebuild();
+    // Rebuild tree as a linear BVH of the leaves sorted along a Morton curve,
+    // several times faster than Rebuild() at the cost of a worse tree
+    void RebuildLinear();
+    // Refit the internal nodes bottom up in a single pass. Once the tree cost relative to the leaves grows past
+    // refit_rebuild_threshold over the best refit, the worst subtrees are rebuilt. Returns the number of rebuilt leaves
+    int32 Refit();
+    void RebuildSubtree(NodeProxy node);
+
+    int32 GetNodeCount() const;
+    // Changes whenever the tree is modified
+    uint32 GetRevision() const;
 
 private:
+    friend class WideAABBTree;
+    friend class BroadPhase;
+
     NodeProxy root;
 
     Node* nodes;
@@ -93,6 +134,11 @@ private:
 
     NodeProxy freeList;
 
+    uint32 revision;
+
+    // Ratio of the internal to the leaf surface area of the best refitted tree, zero until Refit() first rebuilds the tree
+    float refitQuality;
+
     NodeProxy AllocateNode();
     void FreeNode(NodeProxy node);
 
@@ -101,6 +147,20 @@ private:
 
     void Rotate(NodeProxy node);
     void Swap(NodeProxy node1, NodeProxy node2);
+
+    // Clear the tree down to its leaves, freeing the internal nodes. Returns the number of leaves
+    int32 CollectLeaves(NodeProxy* leaves);
+    // Build a subtree of the leaves with binned SAH under the parent node
+    void Build(NodeProxy* leaves, int32 count, NodeProxy parent, bool isChild1);
+    // Build the whole tree of the leaves split by their Morton codes
+    void BuildLinear(NodeProxy* leaves, int32 count);
+
+    // Pair search of the subtree nodeA and the subtree nodeB of the other tree,
+    // a subtree paired with itself searches the pairs within it. Returns false if the callback stopped it
+    template <typename T>
+    bool SearchPairs(NodeProxy nodeA, const AABBTree& other, NodeProxy nodeB, T* callback, bool movedOnly) const;
+    // Whether a pair search descends into the first subtree of the pair
+    static bool DescendFirst(const Node& a, const Node& b, bool movedOnly);
 };
 
 inline bool AABBTree::TestOverlap(NodeProxy nodeA, NodeProxy nodeB) const
@@ -123,6 +183,19 @@ inline void AABBTree::ClearMoved(NodeProxy node) const
     MuliAssert(0 <= node && node < nodeCapacity);
 
     nodes[node].moved = false;
+
+    // Clear the ancestors left without a moved leaf
+    NodeProxy parent = nodes[node].parent;
+    while (parent != nullNode && nodes[parent].moved)
+    {
+        if (nodes[nodes[parent].child1].moved || nodes[nodes[parent].child2].moved)
+        {
+            break;
+        }
+
+        nodes[parent].moved = false;
+        parent = nodes[parent].parent;
+    }
 }
 
 inline bool AABBTree::WasMoved(NodeProxy node) const
@@ -132,6 +205,23 @@ inline bool AABBTree::WasMoved(NodeProxy node) const
     return nodes[node].moved;
 }
 
+inline uint32 AABBTree::GetCategoryBits(NodeProxy node) const
+{
+    MuliAssert(0 <= node && node < nodeCapacity);
+
+    return nodes[node].categoryBits;
+}
+
+inline int32 AABBTree::GetNodeCount() const
+{
+    return nodeCount;
+}
+
+inline uint32 AABBTree::GetRevision() const
+{
+    return revision;
+}
+
 inline Data* AABBTree::GetData(NodeProxy node) const
 {
     MuliAssert(0 <= node && node < nodeCapacity);
@@ -175,7 +265,7 @@ void AABBTree::Traverse(T* callback) const
 }
 
 template <typename T>
-void AABBTree::Query(const Vec2& point, T* callback) const
+void AABBTree::Query(const Vec2& point, T* callback, uint32 categoryMask) const
 {
     if (root == nullNode)
     {
@@ -189,7 +279,7 @@ void AABBTree::Query(const Vec2& point, T* callback) const
     {
         NodeProxy current = stack.PopBack();
 
-        if (nodes[current].aabb.TestPoint(point) == false)
+        if ((nodes[current].categoryBits & categoryMask) == 0 || nodes[current].aabb.TestPoint(point) == false)
         {
             continue;
         }
@@ -211,7 +301,7 @@ void AABBTree::Query(const Vec2& point, T* callback) const
 }
 
 template <typename T>
-void AABBTree::Query(const AABB& aabb, T* callback) const
+void AABBTree::Query(const AABB& aabb, T* callback, uint32 categoryMask) const
 {
     if (root == nullNode)
     {
@@ -225,7 +315,7 @@ void AABBTree::Query(const AABB& aabb, T* callback) const
     {
         NodeProxy current = stack.PopBack();
 
-        if (nodes[current].aabb.TestOverlap(aabb) == false)
+        if ((nodes[current].categoryBits & categoryMask) == 0 || nodes[current].aabb.TestOverlap(aabb) == false)
         {
             continue;
         }
@@ -247,7 +337,7 @@ void AABBTree::Query(const AABB& aabb, T* callback) const
 }
 
 template <typename T>
-void AABBTree::AABBCast(const AABBCastInput& input, T* callback) const
+void AABBTree::AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask) const
 {
     const Vec2 p1 = input.from;
     const Vec2 p2 = input.to;
@@ -268,7 +358,7 @@ void AABBTree::AABBCast(const AABBCastInput& input, T* callback) const
     while (stack.Count() > 0)
     {
         NodeProxy current = stack.PopBack();
-        if (current == nullNode)
+        if (current == nullNode || (nodes[current].categoryBits & categoryMask) == 0)
         {
             continue;
         }
@@ -326,4 +416,111 @@ void AABBTree::AABBCast(const AABBCastInput& input, T* callback) const
     }
 }
 
-} // namespace muli
\ No newline at end of file
+inline bool AABBTree::DescendFirst(const Node& a, const Node& b, bool movedOnly)
+{
+    if (a.IsLeaf() || b.IsLeaf())
+    {
+        return b.IsLeaf();
+    }
+
+    // Head for the moved leaves, the unmoved children of the moved side are pruned right away
+    if (movedOnly && a.moved != b.moved)
+    {
+        return a.moved;
+    }
+
+    // Otherwise descend into the larger subtree
+    return SurfaceArea(a.aabb) >= SurfaceArea(b.aabb);
+}
+
+template <typename T>
+void AABBTree::QueryPairs(T* callback, bool movedOnly) const
+{
+    if (root == nullNode)
+    {
+        return;
+    }
+
+    SearchPairs(root, *this, root, callback, movedOnly);
+}
+
+template <typename T>
+void AABBTree::QueryPairs(const AABBTree& other, T* callback, bool movedOnly) const
+{
+    if (root == nullNode || other.root == nullNode)
+    {
+        return;
+    }
+
+    SearchPairs(root, other, other.root, callback, movedOnly);
+}
+
+template <typename T>
+bool AABBTree::SearchPairs(NodeProxy nodeA, const AABBTree& other, NodeProxy nodeB, T* callback, bool movedOnly) const
+{
+    struct Pair
+    {
+        NodeProxy nodeA;
+        NodeProxy nodeB;
+    };
+
+    const Node* otherNodes = other.nodes;
+    bool self = this == &other;
+
+    GrowableArray<Pair, 256> stack;
+    stack.EmplaceBack(nodeA, nodeB);
+
+    while (stack.Count() != 0)
+    {
+        Pair pair = stack.PopBack();
+
+        const Node* a = nodes + pair.nodeA;
+        const Node* b = otherNodes + pair.nodeB;
+
+        if (movedOnly && a->moved == false && b->moved == false)
+        {
+            continue;
+        }
+
+        if (self && pair.nodeA == pair.nodeB)
+        {
+            // Pairs within each child and across them
+            if (a->IsLeaf() == false)
+            {
+                stack.EmplaceBack(a->child1, a->child2);
+                stack.EmplaceBack(a->child2, a->child2);
+                stack.EmplaceBack(a->child1, a->child1);
+            }
+
+            continue;
+        }
+
+        if (a->aabb.TestOverlap(b->aabb) == false)
+        {
+            continue;
+        }
+
+        if (a->IsLeaf() && b->IsLeaf())
+        {
+            bool proceed = callback->PairCallback(pair.nodeA, a->data, pair.nodeB, b->data);
+            if (proceed == false)
+            {
+                return false;
+            }
+        }
+        else if (DescendFirst(*a, *b, movedOnly))
+        {
+            stack.EmplaceBack(a->child2, pair.nodeB);
+            stack.EmplaceBack(a->child1, pair.nodeB);
+        }
+        else
+        {
+            stack.EmplaceBack(pair.nodeA, b->child2);
+            stack.EmplaceBack(pair.nodeA, b->child1);
+        }
+    }
+
+    return true;
+}
+
+} // namespace muli
@@ -1,29 +0,0 @@
-#pragma once
-
-#include "common.h"
-
-namespace muli
-{
-
-class Contact;
-class ContactSolver;
-struct Jacobian;
-
-class BlockSolver
-{
-public:
-    void Prepare(Contact* contact);
-    void Solve();
-
-private:
-    friend class Contact;
-
-    Contact* c;
-
-    Mat2 k;
-    Mat2 m;
-
-    bool enabled;
-};
-
-} // namespace muli
\ No newline at end of file
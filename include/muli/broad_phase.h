@@ -3,51 +3,295 @@
 #include "aabb.h"
 #include "aabb_tree.h"
 #include "common.h"
+#include "sweep_and_prune.h"
+#include "uniform_grid.h"
+#include "wide_aabb_tree.h"
 
 namespace muli
 {
 class ContactManager;
 
+// Broad phase counters of the last step, to weigh the tree updates against the narrow phase work
+struct BroadPhaseStats
+{
+    int32 reinsertions;  // Proxies moved out of their fat aabb
+    int32 newPairs;      // Contacts created for newly overlapping fat aabbs
+    int32 pairs;         // Contacts evaluated by the narrow phase
+    int32 touchingPairs; // Evaluated contacts whose shapes touch, the others are false positives of the broad phase
+    int32 reusedPairs;   // Evaluated contacts whose manifold was reused without calling the narrow phase
+    int32 rebuiltLeaves; // Leaves of the subtrees rebuilt by the refit tree
+};
+
 class BroadPhase
 {
 public:
     BroadPhase(World* world, ContactManager* contactManager);
     ~BroadPhase();
 
+    // Proxies are kept in separate trees by the state of their body,
+    // so the queries of moving proxies don't descend through large static and sleeping subtrees
+    enum TreeType
+    {
+        // Order matters!
+        static_tree = 0, // Rarely modified
+        sleeping_tree,
+        active_tree,
+        tree_count
+    };
+
     void FindNewContacts();
     bool TestOverlap(Collider* colliderA, Collider* colliderB) const;
+    const AABB& GetFatAABB(Collider* collider) const;
 
     void Add(Collider* collider, const AABB& aabb);
     void Remove(Collider* collider);
+    // Remove the proxies of many colliders together
+    void Remove(std::span<Collider*> colliders);
     void Update(Collider* collider, const AABB& aabb, const Vec2& displacement);
     void Refresh(Collider* collider);
+    // Sync the category bits of the proxy with the filter of the collider
+    void UpdateCategory(Collider* collider);
+
+    // Query all trees and the static scene until the callback stops the query,
+    // the colliders whose filter bit is outside the categoryMask are skipped
+    template <typename T>
+    void Query(const Vec2& point, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void Query(const AABB& aabb, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void AABBCast(AABBCastInput input, T* callback, uint32 categoryMask = all_categories) const;
 
-    bool QueryCallback(NodeProxy node, Collider* collider);
+    const BroadPhaseStats& GetStats() const;
 
 protected:
     friend class World;
+    friend class ContactManager;
 
     World* world;
     ContactManager* contactManager;
-    AABBTree tree;
+    WorldSettings::BroadPhaseType type;
+    AABBTree trees[tree_count];
+    // Wide copies of the trees refreshed for the pair search, used by the queries while they are current
+    WideAABBTree wideTrees[tree_count];
+    // Pair queries run on each tree since its wide copy went stale
+    int32 staleQueryCounts[tree_count];
+    // Used instead of the trees by the other broad phase types
+    SweepAndPrune sap;
+    UniformGrid grid;
+    // Tree of the shared static scene, never modified by the world
+    const AABBTree* sceneTree;
+    const WideAABBTree* sceneWideTree;
+
+    BroadPhaseStats stats;
 
 private:
-    NodeProxy* moveBuffer;
+    // Potential contact found by a pair search task
+    struct ProxyPair
+    {
+        int32 taskIndex;
+        Collider* colliderA;
+        Collider* colliderB;
+    };
+
+    // Pair search of a single task, e.g. a moved proxy, a sweep and prune entry or a pair of subtrees
+    struct PairQuery
+    {
+        const BroadPhase* broadPhase;
+        std::vector<ProxyPair>* pairBuffer;
+        int32 taskIndex;
+        // Querying the scene tree, whose proxies never move
+        bool sceneQuery;
+
+        TreeType treeA;
+        NodeProxy nodeA;
+        RigidBody* bodyA;
+        Collider* colliderA;
+        Shape::Type typeA;
+
+        bool QueryCallback(NodeProxy nodeB, Collider* colliderB);
+        void PairCallback(int32 entry, Collider* colliderA, Collider* colliderB);
+        bool PairCallback(NodeProxy nodeA, Collider* colliderA, NodeProxy nodeB, Collider* colliderB);
+
+        void AddPair(Collider* colliderB);
+    };
+
+    // Subtrees descended together by a single task, a subtree paired with itself searches the pairs within it
+    struct SubtreePair
+    {
+        const AABBTree* treeA;
+        const AABBTree* treeB;
+        NodeProxy nodeA;
+        NodeProxy nodeB;
+    };
+
+    Collider** moveBuffer;
     int32 moveCapacity;
     int32 moveCount;
 
-    NodeProxy nodeA;
-    RigidBody* bodyA;
-    Collider* colliderA;
-    Shape::Type typeA;
+    // Per-worker buffers filled during the parallel pair finding
+    std::vector<ProxyPair> pairBuffers[max_workers];
 
-    void BufferMove(NodeProxy node);
-    void UnBufferMove(NodeProxy node);
+    std::vector<SubtreePair> subtreePairs;
+    std::vector<SubtreePair> splitPairs;
+
+    static TreeType GetTreeType(const RigidBody* body);
+
+    template <typename Q, typename T>
+    void QueryTree(int32 tree, const Q& query, T* callback, uint32 categoryMask = all_categories) const;
+
+    void BufferMove(Collider* collider);
+    void UnBufferMove(Collider* collider);
+
+    // Move the proxy to the tree matching the state of its body
+    void Transfer(Collider* collider);
+    // Returns true if the fat aabb is too large for the recent motion
+    bool ComputeMargin(Collider* collider, const AABB& aabb, Vec2* displacement, Vec2* margin);
+    void RefreshWideTrees();
+
+    void AddSubtreePair(const AABBTree* treeA, NodeProxy nodeA, const AABBTree* treeB, NodeProxy nodeB);
+    void SplitSubtreePairs();
+
+    static void TreePairsTask(int32 begin, int32 end, int32 workerIndex, void* taskContext);
+    static void FindPairsTask(int32 begin, int32 end, int32 workerIndex, void* taskContext);
+    static void SweepPairsTask(int32 begin, int32 end, int32 workerIndex, void* taskContext);
 };
 
 inline bool BroadPhase::TestOverlap(Collider* inColliderA, Collider* inColliderB) const
 {
-    return tree.TestOverlap(inColliderA->node, inColliderB->node);
+    return GetFatAABB(inColliderA).TestOverlap(GetFatAABB(inColliderB));
+}
+
+inline const BroadPhaseStats& BroadPhase::GetStats() const
+{
+    return stats;
+}
+
+inline const AABB& BroadPhase::GetFatAABB(Collider* collider) const
+{
+    // Colliders of the static scene don't belong to this world
+    if (collider->body->world != world)
+    {
+        return sceneTree->GetAABB(collider->node);
+    }
+
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        return sap.GetAABB(collider->node);
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        return grid.GetAABB(collider->node);
+    }
+
+    return trees[collider->tree].GetAABB(collider->node);
+}
+
+inline BroadPhase::TreeType BroadPhase::GetTreeType(const RigidBody* body)
+{
+    if (body->GetType() == RigidBody::Type::static_body)
+    {
+        return static_tree;
+    }
+
+    return body->IsSleeping() ? sleeping_tree : active_tree;
+}
+
+template <typename Q, typename T>
+void BroadPhase::QueryTree(int32 tree, const Q& query, T* callback, uint32 categoryMask) const
+{
+    if (wideTrees[tree].IsCurrent(trees[tree]))
+    {
+        wideTrees[tree].Query(query, callback, categoryMask);
+    }
+    else
+    {
+        trees[tree].Query(query, callback, categoryMask);
+    }
+}
+
+template <typename T>
+void BroadPhase::Query(const Vec2& point, T* callback, uint32 categoryMask) const
+{
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        sap.Query(point, callback, categoryMask);
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        grid.Query(point, callback, categoryMask);
+    }
+    else
+    {
+        for (int32 i = 0; i < tree_count && callback->proceed; ++i)
+        {
+            QueryTree(i, point, callback, categoryMask);
+        }
+    }
+
+    if (sceneTree && callback->proceed)
+    {
+        sceneWideTree->Query(point, callback, categoryMask);
+    }
+}
+
+template <typename T>
+void BroadPhase::Query(const AABB& aabb, T* callback, uint32 categoryMask) const
+{
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        sap.Query(aabb, callback, categoryMask);
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        grid.Query(aabb, callback, categoryMask);
+    }
+    else
+    {
+        for (int32 i = 0; i < tree_count && callback->proceed; ++i)
+        {
+            QueryTree(i, aabb, callback, categoryMask);
+        }
+    }
+
+    if (sceneTree && callback->proceed)
+    {
+        sceneWideTree->Query(aabb, callback, categoryMask);
+    }
+}
+
+template <typename T>
+void BroadPhase::AABBCast(AABBCastInput input, T* callback, uint32 categoryMask) const
+{
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        sap.AABBCast(input, callback, categoryMask);
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        grid.AABBCast(input, callback, categoryMask);
+    }
+    else
+    {
+        // Each tree is cast clipped by the hits found so far
+        for (int32 i = 0; i < tree_count && callback->maxFraction > 0.0f; ++i)
+        {
+            input.maxFraction = callback->maxFraction;
+            if (wideTrees[i].IsCurrent(trees[i]))
+            {
+                wideTrees[i].AABBCast(input, callback, categoryMask);
+            }
+            else
+            {
+                trees[i].AABBCast(input, callback, categoryMask);
+            }
+        }
+    }
+
+    if (sceneTree && callback->maxFraction > 0.0f)
+    {
+        input.maxFraction = callback->maxFraction;
+        sceneWideTree->AABBCast(input, callback, categoryMask);
+    }
 }
 
 } // namespace muli
\ No newline at end of file
@@ -69,7 +69,7 @@ private:
     friend class Contact;
     friend class ContactManager;
     friend class World;
-    friend class ContactSolver;
+    friend class StaticScene;
 
     Collider();
     ~Collider();
@@ -88,6 +88,10 @@ private:
     CollisionFilter filter;
 
     NodeProxy node;
+    uint8 tree;      // Broad phase tree holding the node
+    int32 moveIndex; // Slot in the broad phase move buffer, -1 if not buffered
+    Vec2 motion;     // Smoothed displacement per step, sizes the adaptive fat aabb prediction
+    float jitter;    // Smoothed deviation of the displacement from the motion, sizes the adaptive fat aabb margin
 
     bool enabled;
 };
@@ -204,11 +208,6 @@ inline const CollisionFilter& Collider::GetFilter() const
     return filter;
 }
 
-inline void Collider::SetFilter(const CollisionFilter& newCollisionFilter)
-{
-    filter = newCollisionFilter;
-}
-
 inline bool Collider::IsEnabled() const
 {
     return enabled;
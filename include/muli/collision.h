@@ -41,16 +41,29 @@ bool Collide(const Shape* a, const Transform& tfA,
              const Shape* b, const Transform& tfB,
              ContactManifold* manifold = nullptr);
 
+// Collide functions of the shape pairs, the type of shape a is greater than or equal to the type of shape b
+CollideFunction CircleVsCircle;
+CollideFunction CapsuleVsCircle;
+CollideFunction CapsuleVsCapsule;
+CollideFunction PolygonVsCircle;
+CollideFunction PolygonVsCapsule;
+CollideFunction PolygonVsPolygon;
+// GJK and EPA based, works for all shape pairs
+CollideFunction ConvexVsConvex;
+
 struct GJKResult
 {
     Simplex simplex;
     Vec2 direction;
     float distance;
+    int32 iterations; // Support points evaluated
 };
 
+// The cache is read to warm start the search and updated with the termination simplex
 bool GJK(const Shape* a, const Transform& tfA,
          const Shape* b, const Transform& tfB,
-         GJKResult* result);
+         GJKResult* result,
+         SimplexCache* cache = nullptr);
 
 struct EPAResult
 {
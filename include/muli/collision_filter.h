@@ -14,6 +14,9 @@ struct CollisionFilter
 
 constexpr CollisionFilter default_collision_filter{};
 
+// Query mask passing the colliders of every category
+constexpr uint32 all_categories = 0xffffffff;
+
 inline bool EvaluateFilter(const CollisionFilter& filterA, const CollisionFilter& filterB)
 {
     if (filterA.group != filterB.group)
@@ -8,6 +8,34 @@ namespace muli
 
 struct Timestep;
 
+// Compact body state the constraints are solved on
+// The island copies its bodies into these arrays, solves the constraints and writes the results back once
+// Arrays are grouped by the solver phase that touches them and indexed by the solver index of the body
+struct SolverVelocity
+{
+    Vec2 v;
+    float w;
+};
+
+struct SolverPosition
+{
+    Vec2 c; // Center of mass
+    float a;
+};
+
+struct SolverMass
+{
+    float invMass;
+    float invInertia;
+};
+
+struct SolverBodies
+{
+    SolverVelocity* velocities;
+    SolverPosition* positions;
+    SolverMass* masses;
+};
+
 class Constraint
 {
 public:
@@ -25,7 +53,7 @@ public:
      * Compute Jacobian J and effective mass M
      * M = K^-1 = (J · M^-1 · J^t)^-1
      */
-    virtual void Prepare(const Timestep& step) = 0;
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) = 0;
 
     /*
      * Solve velocity constraint, calculate corrective impulse for current iteration
@@ -41,18 +69,34 @@ public:
      * More reading:
      * https://pybullet.org/Bullet/phpBB3/viewtopic.php?f=4&t=1354
      */
-    virtual void SolveVelocityConstraints(const Timestep& step) = 0;
-    virtual bool SolvePositionConstraints(const Timestep& step) = 0;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) = 0;
+    virtual bool SolvePositionConstraints(const Timestep& step, SolverBodies& bodies) = 0;
 
     RigidBody* GetBodyA() const;
     RigidBody* GetBodyB() const;
 
 protected:
+    friend class World;
+    friend class Island;
+    friend class ContactManager;
+    friend class RigidBody;
+
     RigidBody* bodyA;
     RigidBody* bodyB;
 
+    // Solver indices of the bodies, assigned by the island before solving
+    int32 indexA;
+    int32 indexB;
+
     float beta;
     float gamma;
+
+    // Constraints in the same color don't share any non-static body
+    // graph_color_count means the constraint is not colored (overflow)
+    int32 color;
+
+    void AddColor();
+    void RemoveColor();
 };
 
 inline RigidBody* Constraint::GetBodyA() const
@@ -1,10 +1,7 @@
 #pragma once
 
-#include "block_solver.h"
 #include "collision.h"
 #include "constraint.h"
-#include "contact_solver.h"
-#include "position_solver.h"
 
 namespace muli
 {
@@ -20,10 +17,56 @@ struct ContactEdge
     ContactEdge* next;
 };
 
+// Solver data of a contact point
+struct ContactConstraintPoint
+{
+    // Angular parts of the jacobians
+    // J = [-dir, -ra × dir, dir, rb × dir] (dir: contact normal or tangent)
+    float normalWA, normalWB;
+    float tangentWA, tangentWB;
+
+    // Effective masses: (J · M^-1 · J^t)^-1
+    float normalMass;
+    float tangentMass;
+
+    float bias; // Restitution
+
+    // Accumulated impulses
+    float normalImpulse = 0.0f;
+    float tangentImpulse = 0.0f;
+    float normalImpulseSave = 0.0f;
+    float tangentImpulseSave = 0.0f;
+
+    // Penetration point in the incident body space
+    Vec2 localClipPoint;
+};
+
+// Velocity and position constraints of all contact points of a contact
+// The linear parts of the jacobians are the normal and tangent of the contact manifold
+struct ContactConstraint
+{
+    ContactConstraintPoint points[max_contact_point_count];
+
+    // Solve two contact points simultaneously (2-contact LCP solver)
+    // K = (J · M^-1 · J^t), M = K^-1
+    Mat2 k;
+    Mat2 m;
+    bool blockSolve;
+
+    float invMass1, invInertia1;
+    float invMass2, invInertia2;
+
+    // Reference plane in the reference body space
+    Vec2 localPlainPoint;
+    Vec2 localNormal;
+};
+
 class Contact : Constraint
 {
 public:
     Contact(Collider* colliderA, Collider* colliderB);
+    // The bodies differ from the collider bodies for the colliders of a static scene
+    Contact(Collider* colliderA, Collider* colliderB, RigidBody* bodyA, RigidBody* bodyB);
     ~Contact() noexcept = default;
 
     Collider* GetColliderA() const;
@@ -54,9 +97,7 @@ private:
     friend class Island;
     friend class ContactManager;
     friend class BroadPhase;
-    friend class ContactSolver;
-    friend class BlockSolver;
-    friend class PositionSolver;
+    friend class WideContactSolver;
 
     enum
     {
@@ -64,14 +105,41 @@ private:
         flag_touching = 1 << 1,
         flag_island = 1 << 2,
         flag_toi = 1 << 3,
+        flag_cached = 1 << 4, // The manifold cache holds the touching result of the last narrow phase call
+        flag_reused = 1 << 5, // The last update reused the cached manifold
+    };
+
+    // Manifold of the last narrow phase call in the body spaces, see WorldSettings::manifold_reuse
+    struct ManifoldCache
+    {
+        // Pose of the body with the smaller collider in the space of the other body
+        Transform relativeTransform;
+        float extent; // Distance from the origin of the smaller collider's body to its farthest point
+        bool smallerA;
+
+        // Reference body space
+        Vec2 localNormal;
+        Vec2 localReferencePoint;
+
+        // Incident body space
+        Vec2 localContactPoints[max_contact_point_count];
     };
 
-    virtual void Prepare(const Timestep& step) override;
-    virtual void SolveVelocityConstraints(const Timestep& step) override;
-    virtual bool SolvePositionConstraints(const Timestep& step) override;
-    bool SolveTOIPositionConstraints();
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) override;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) override;
+    virtual bool SolvePositionConstraints(const Timestep& step, SolverBodies& bodies) override;
+    bool SolveTOIPositionConstraints(SolverBodies& bodies);
+    bool SolvePositions(SolverBodies& bodies, float correction, float maxCorrection, float threshold, bool toi);
 
     void Update();
+    // Only writes to this contact, so it's safe to call in parallel
+    void UpdateManifold();
+    // Moves the cached manifold along with the bodies if they barely moved relative to each other since it was cached
+    bool ReuseManifold();
+    void CacheManifold();
+    // Assigns the graph color and calls the listeners, must be called on the calling thread of World::Step()
+    void ReportUpdate(bool wasTouching);
+    bool HasListener() const;
 
     void SaveImpulses();
     void RestoreImpulses();
@@ -81,6 +149,10 @@ private:
     RigidBody* b1; // Reference body
     RigidBody* b2; // Incident body
 
+    // Solver indices of the reference and incident body
+    int32 index1;
+    int32 index2;
+
     Collider* colliderA;
     Collider* colliderB;
 
@@ -96,22 +168,16 @@ private:
     float surfaceSpeed;
 
     ContactManifold manifold;
+    ManifoldCache cache;
 
-    // TODO: Integrate decoupled solvers into SolveVelocityConstraints() and SolvePositionConstraints() for optimization
-    ContactSolver normalSolvers[max_contact_point_count];
-    ContactSolver tangentSolvers[max_contact_point_count];
-    PositionSolver positionSolvers[max_contact_point_count];
-    BlockSolver blockSolver;
-
-    // Impulse buffer for position correction
-    // prefix 'c' stands for corrective
-    Vec2 cLinearImpulseA, cLinearImpulseB;
-    float cAngularImpulseA, cAngularImpulseB;
+    ContactConstraint constraint;
 
     uint16 flag;
 
     int32 toiCount;
     float toi;
+    // Seeds the distance queries of the next TOI computation
+    SimplexCache simplexCache;
 };
 
 inline Collider* Contact::GetColliderA() const
@@ -162,13 +228,13 @@ inline int32 Contact::GetContactCount() const
 inline float Contact::GetNormalImpulse(int32 index) const
 {
     MuliAssert(index == 0 || index == 1);
-    return normalSolvers[index].impulse;
+    return constraint.points[index].normalImpulse;
 }
 
 inline float Contact::GetTangentImpulse(int32 index) const
 {
     MuliAssert(index == 0 || index == 1);
-    return tangentSolvers[index].impulse;
+    return constraint.points[index].tangentImpulse;
 }
 
 inline float Contact::GetFriction() const
@@ -212,10 +278,11 @@ inline void Contact::SaveImpulses()
 {
     for (int32 i = 0; i < manifold.contactCount; ++i)
     {
-        normalSolvers[i].impulseSave = normalSolvers[i].impulse;
-        tangentSolvers[i].impulseSave = tangentSolvers[i].impulse;
-        normalSolvers[i].impulse = 0.0f;
-        tangentSolvers[i].impulse = 0.0f;
+        ContactConstraintPoint& cp = constraint.points[i];
+        cp.normalImpulseSave = cp.normalImpulse;
+        cp.tangentImpulseSave = cp.tangentImpulse;
+        cp.normalImpulse = 0.0f;
+        cp.tangentImpulse = 0.0f;
     }
 }
 
@@ -223,8 +290,9 @@ inline void Contact::RestoreImpulses()
 {
     for (int32 i = 0; i < manifold.contactCount; ++i)
     {
-        normalSolvers[i].impulse = normalSolvers[i].impulseSave;
-        tangentSolvers[i].impulse = tangentSolvers[i].impulseSave;
+        ContactConstraintPoint& cp = constraint.points[i];
+        cp.normalImpulse = cp.normalImpulseSave;
+        cp.tangentImpulse = cp.tangentImpulseSave;
     }
 }
 
@@ -2,6 +2,7 @@
 
 #include "broad_phase.h"
 #include "contact.h"
+#include "pair_set.h"
 
 namespace muli
 {
@@ -20,6 +21,7 @@ public:
 
 protected:
     friend class RigidBody;
+    friend class Collider;
 
     void AddCollider(Collider* collider);
     void RemoveCollider(Collider* collider);
@@ -30,6 +32,13 @@ private:
     friend class World;
     friend class BroadPhase;
 
+    // Contact update that has to be reported on the calling thread
+    struct ContactUpdate
+    {
+        int32 index;
+        bool wasTouching;
+    };
+
     World* world;
 
     BroadPhase broadPhase;
@@ -37,8 +46,19 @@ private:
     Contact* contactList;
     int32 contactCount;
 
+    // Collider pairs of all contacts for the constant time duplicate check
+    PairSet contactPairs;
+
+    // Per-worker buffers filled during the parallel narrow phase
+    std::vector<ContactUpdate> updateBuffers[max_workers];
+
     void Destroy(Contact* c);
+    RigidBody* GetBody(Collider* collider) const;
+    // Only reads the contact graph, so it's safe to call in parallel
+    bool ShouldCollide(Collider* colliderA, Collider* colliderB) const;
     void OnNewContact(Collider*, Collider*);
+
+    static void UpdateContactTask(int32 begin, int32 end, int32 workerIndex, void* taskContext);
 };
 
 inline void ContactManager::UpdateContactGraph()
@@ -1,7 +1,6 @@
 #pragma once
 
-#include "shape.h"
-#include "simplex.h"
+#include "gjk.h"
 
 namespace muli
 {
@@ -12,20 +11,51 @@ struct ClosestFeatures
     Point featuresA[max_simplex_vertex_count - 1];
     Point featuresB[max_simplex_vertex_count - 1];
     int32 count;
+    int32 iterations; // Gjk support points evaluated
 };
 
 // clang-format off
+// The optional cache warm starts the gjk from the last query on the same shape pair
 float GetClosestFeatures(
     const Shape* a, const Transform& tfA,
     const Shape* b, const Transform& tfB, 
-    ClosestFeatures* features
+    ClosestFeatures* features,
+    SimplexCache* cache = nullptr
 );
 
 float ComputeDistance(
     const Shape* a, const Transform& tfA,
     const Shape* b, const Transform& tfB, 
-    Vec2* pointA, Vec2* pointB
+    Vec2* pointA, Vec2* pointB,
+    SimplexCache* cache = nullptr
 );
 // clang-format on
 
+template <typename A, typename B>
+float GetClosestFeatures(
+    const A* a, const Transform& tfA, const B* b, const Transform& tfB, ClosestFeatures* features, SimplexCache* cache = nullptr
+)
+{
+    GJKResult gjkResult;
+
+    bool collide = GJK(a, tfA, b, tfB, &gjkResult, cache);
+    features->iterations = gjkResult.iterations;
+    if (collide == true)
+    {
+        return 0.0f;
+    }
+
+    Simplex& simplex = gjkResult.simplex;
+    MuliAssert(simplex.count < max_simplex_vertex_count);
+
+    features->count = simplex.count;
+    for (int32 i = 0; i < features->count; ++i)
+    {
+        features->featuresA[i] = simplex.vertices[i].pointA;
+        features->featuresB[i] = simplex.vertices[i].pointB;
+    }
+
+    return gjkResult.distance;
+}
+
 } // namespace muli
@@ -20,8 +20,8 @@ public:
         float jointMass = 1.0f
     );
 
-    virtual void Prepare(const Timestep& step) override;
-    virtual void SolveVelocityConstraints(const Timestep& step) override;
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) override;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) override;
 
     const Vec2& GetLocalAnchorA() const;
     const Vec2& GetLocalAnchorB() const;
@@ -41,7 +41,7 @@ private:
     float bias;
     float impulseSum;
 
-    void ApplyImpulse(float lambda);
+    void ApplyImpulse(SolverBodies& bodies, float lambda);
 };
 
 inline const Vec2& DistanceJoint::GetLocalAnchorA() const
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "capsule.h"
+#include "circle.h"
+#include "polygon.h"
+#include "polytope.h"
+
+namespace muli
+{
+
+/*
+ * GJK and EPA instantiated per pair of concrete shape types, so the support functions are inlined into the iteration loops
+ * The functions taking Shape pointers dispatch on the shape types once per call, see DispatchShapes()
+ */
+
+/*
+ * Returns support point in 'Minkowski Difference' set
+ * Minkowski Sum: A ⊕ B = {Pa + Pb| Pa ∈ A, Pb ∈ B}
+ * Minkowski Difference : A ⊖ B = {Pa - Pb| Pa ∈ A, Pb ∈ B}
+ * CSO stands for Configuration Space Object
+ *
+ * 'dir' should be normalized
+ */
+template <typename A, typename B>
+inline SupportPoint CSOSupport(const A* a, const Transform& tfA, const B* b, const Transform& tfB, const Vec2& dir)
+{
+    SupportPoint supportPoint;
+    supportPoint.pointA.id = a->A::GetSupport(MulT(tfA.rotation, dir));
+    supportPoint.pointB.id = b->B::GetSupport(MulT(tfB.rotation, -dir));
+    supportPoint.pointA.p = Mul(tfA, a->A::GetVertex(supportPoint.pointA.id));
+    supportPoint.pointB.p = Mul(tfB, b->B::GetVertex(supportPoint.pointB.id));
+    supportPoint.point = supportPoint.pointA.p - supportPoint.pointB.p;
+
+    return supportPoint;
+}
+
+template <typename A, typename B>
+bool GJK(const A* a, const Transform& tfA, const B* b, const Transform& tfB, GJKResult* result, SimplexCache* cache = nullptr)
+{
+    Simplex simplex;
+
+    // Random initial search direction
+    Vec2 direction = tfB.position - tfA.position;
+    SupportPoint support;
+    int32 iterations = 0;
+
+    if (cache && cache->count > 0)
+    {
+        // Start from the support points of the last call, moved to the current transforms
+        for (int32 i = 0; i < cache->count; ++i)
+        {
+            support.pointA.id = cache->idA[i];
+            support.pointB.id = cache->idB[i];
+            support.pointA.p = Mul(tfA, a->A::GetVertex(support.pointA.id));
+            support.pointB.p = Mul(tfB, b->B::GetVertex(support.pointB.id));
+            support.point = support.pointA.p - support.pointB.p;
+            simplex.AddVertex(support);
+        }
+    }
+    else
+    {
+        support = CSOSupport(a, tfA, b, tfB, direction);
+        simplex.AddVertex(support);
+        ++iterations;
+    }
+
+    Vec2 save[max_simplex_vertex_count];
+    int32 saveCount;
+
+    for (int32 k = 0; k < gjk_max_iteration; ++k)
+    {
+        simplex.Save(save, &saveCount);
+        simplex.Advance(Vec2::zero);
+
+        if (simplex.count == 3)
+        {
+            break;
+        }
+
+        direction = simplex.GetSearchDirection();
+
+        // Simplex contains origin
+        if (Dot(direction, direction) == 0.0f)
+        {
+            break;
+        }
+
+        support = CSOSupport(a, tfA, b, tfB, direction);
+        ++iterations;
+
+        // Check duplicate vertices
+        for (int32 i = 0; i < saveCount; ++i)
+        {
+            if (save[i] == support.point)
+            {
+                goto end;
+            }
+        }
+
+        simplex.AddVertex(support);
+    }
+
+end:
+    Vec2 closest = simplex.GetClosestPoint();
+    float distance = Length(closest);
+
+    result->simplex = simplex;
+    result->direction = Normalize(direction);
+    result->distance = distance;
+    result->iterations = iterations;
+
+    if (cache)
+    {
+        cache->count = simplex.count;
+        for (int32 i = 0; i < simplex.count; ++i)
+        {
+            cache->idA[i] = simplex.vertices[i].pointA.id;
+            cache->idB[i] = simplex.vertices[i].pointB.id;
+        }
+    }
+
+    return distance < gjk_tolerance;
+}
+
+template <typename A, typename B>
+void EPA(const A* a, const Transform& tfA, const B* b, const Transform& tfB, const Simplex& simplex, EPAResult* result)
+{
+    Polytope polytope{ simplex };
+    PolytopeEdge edge{ 0, max_value, Vec2::zero };
+
+    for (int32 k = 0; k < epa_max_iteration; ++k)
+    {
+        edge = polytope.GetClosestEdge();
+        Vec2 supportPoint = CSOSupport(a, tfA, b, tfB, edge.normal).point;
+        float newDistance = Dot(edge.normal, supportPoint);
+
+        if (Abs(edge.distance - newDistance) > epa_tolerance)
+        {
+            // Insert the support vertex so that it expands our polytope
+            polytope.vertices.Insert(edge.index + 1, supportPoint);
+        }
+        else
+        {
+            // We finally reached the closest outer edge!
+            break;
+        }
+    }
+
+    result->contactNormal = edge.normal;
+    result->penetrationDepth = edge.distance;
+}
+
+template <typename A, typename F>
+inline auto DispatchShapeB(const A* a, const Shape* b, F& f)
+{
+    switch (b->GetType())
+    {
+    case Shape::Type::circle:
+        return f(a, (const Circle*)b);
+    case Shape::Type::capsule:
+        return f(a, (const Capsule*)b);
+    default:
+        MuliAssert(b->GetType() == Shape::Type::polygon);
+        return f(a, (const Polygon*)b);
+    }
+}
+
+// Calls f(a, b) with the shapes cast to their concrete types
+template <typename F>
+inline auto DispatchShapes(const Shape* a, const Shape* b, F&& f)
+{
+    switch (a->GetType())
+    {
+    case Shape::Type::circle:
+        return DispatchShapeB((const Circle*)a, b, f);
+    case Shape::Type::capsule:
+        return DispatchShapeB((const Capsule*)a, b, f);
+    default:
+        MuliAssert(a->GetType() == Shape::Type::polygon);
+        return DispatchShapeB((const Polygon*)a, b, f);
+    }
+}
+
+} // namespace muli
@@ -18,8 +18,8 @@ public:
         float jointMass = -1.0f
     );
 
-    virtual void Prepare(const Timestep& step) override;
-    virtual void SolveVelocityConstraints(const Timestep& step) override;
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) override;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) override;
 
     const Vec2& GetLocalAnchor() const;
 
@@ -36,7 +36,7 @@ private:
     Vec2 bias;
     Vec2 impulseSum;
 
-    void ApplyImpulse(const Vec2& lambda);
+    void ApplyImpulse(SolverBodies& bodies, const Vec2& lambda);
 };
 
 inline const Vec2& GrabJoint::GetLocalAnchor() const
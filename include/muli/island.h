@@ -5,12 +5,39 @@
 namespace muli
 {
 
+struct ColorTaskContext;
+
+// Constraints of an island collected for parallel solving
+struct IslandRange
+{
+    int32 bodyBegin;
+    int32 bodyCount;
+    int32 contactBegin;
+    int32 contactCount;
+    int32 jointBegin;
+    int32 jointCount;
+    bool sleeping;
+    bool useWorkers;
+};
+
 class Island
 {
 private:
     friend class World;
 
-    Island(World* world, int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity);
+    // Allocate the island storage from the given allocator
+    Island(World* world, LinearAllocator* allocator, int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity);
+    // Island view over the constraints collected by another island
+    Island(
+        World* world,
+        LinearAllocator* allocator,
+        RigidBody** bodies,
+        int32 bodyCount,
+        Contact** contacts,
+        int32 contactCount,
+        Joint** joints,
+        int32 jointCount
+    );
     ~Island();
 
     void Add(RigidBody* body);
@@ -18,11 +45,27 @@ private:
     void Add(Joint* joint);
 
     void Solve();
+    void SolveColored();
+    void SolveColors(
+        TaskFunction* task, ColorTaskContext* context, Constraint** constraints, const int32* colorOffsets, const int32* batchOffsets
+    );
+    void IntegratePositions(float dt);
     void SolveTOI(float dt);
+    void Report();
     void Clear();
 
+    void LoadSolverBodies();
+    void LoadSolverBody(int32 index, const RigidBody* body);
+    int32 GetSolverIndex(RigidBody* body, int32* staticIndex);
+    void StoreSolverBodies(bool awakeIsland);
+
     World* world;
 
+    // Scratch memory used while solving the island
+    // Each worker has its own allocator so that islands can be solved in parallel
+    LinearAllocator* allocator;
+    bool ownsStorage;
+
     // Static body is not included
     RigidBody** bodies;
     Contact** contacts;
@@ -35,7 +78,16 @@ private:
     int32 contactCount;
     int32 jointCount;
 
+    // Body state the constraints are solved on, indexed by the island index of the body
+    // The slots past bodyCount hold private copies of the static bodies, one for each constraint end
+    SolverBodies solverBodies;
+    int32 solverBodyCount;
+
     bool sleeping;
+
+    // Solve the constraint colors with all workers of the world
+    // Only allowed on the calling thread of World::Step()
+    bool useWorkers;
 };
 
 inline void Island::Add(RigidBody* body)
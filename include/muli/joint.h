@@ -78,9 +78,10 @@ public:
     );
     virtual ~Joint() noexcept;
 
-    virtual bool SolvePositionConstraints(const Timestep& step) override
+    virtual bool SolvePositionConstraints(const Timestep& step, SolverBodies& bodies) override
     {
         MuliNotUsed(step);
+        MuliNotUsed(bodies);
         return true;
     }
 
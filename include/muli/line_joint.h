@@ -19,8 +19,8 @@ public:
         float jointMass = -1.0f
     );
 
-    virtual void Prepare(const Timestep& step) override;
-    virtual void SolveVelocityConstraints(const Timestep& step) override;
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) override;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) override;
 
     const Vec2& GetLocalAnchorA() const;
     const Vec2& GetLocalAnchorB() const;
@@ -39,7 +39,7 @@ private:
     float bias;
     float impulseSum;
 
-    void ApplyImpulse(float lambda);
+    void ApplyImpulse(SolverBodies& bodies, float lambda);
 };
 
 inline const Vec2& LineJoint::GetLocalAnchorA() const
@@ -1455,6 +1455,17 @@ inline Vec2 MulT(const Transform& t, const Vec2& v)
     return Vec2{ x, y };
 }
 
+// Transform b in the frame of transform a
+inline Transform MulT(const Transform& a, const Transform& b)
+{
+    Transform t;
+    t.rotation.c = a.rotation.c * b.rotation.c + a.rotation.s * b.rotation.s;
+    t.rotation.s = a.rotation.c * b.rotation.s - a.rotation.s * b.rotation.c;
+    t.position = MulT(a, b.position);
+
+    return t;
+}
+
 // Generals
 
 template <typename T>
@@ -20,8 +20,8 @@ public:
         float jointMass = 1.0f
     );
 
-    virtual void Prepare(const Timestep& step) override;
-    virtual void SolveVelocityConstraints(const Timestep& step) override;
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) override;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) override;
 
     const Vec2& GetLocalAnchorA() const;
     const Vec2& GetLocalAnchorB() const;
@@ -56,7 +56,7 @@ private:
     Vec2 linearImpulseSum;
     float angularImpulseSum;
 
-    void ApplyImpulse(const Vec2& lambda0, float lambda1);
+    void ApplyImpulse(SolverBodies& bodies, const Vec2& lambda0, float lambda1);
 };
 
 inline const Vec2& MotorJoint::GetLocalAnchorA() const
@@ -3,6 +3,8 @@
 // clang-format off
 
 #include "world.h"
+#include "world_pool.h"
+#include "static_scene.h"
 #include "rigidbody.h"
 #include "collider.h"
 
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "common.h"
+
+namespace muli
+{
+
+// Open addressing hash set of unordered pointer pairs
+// Lookups only read the table, so they are safe to run in parallel as long as nothing is added or removed meanwhile
+class PairSet
+{
+public:
+    PairSet(int32 initialCapacity = 256);
+    ~PairSet();
+
+    PairSet(const PairSet&) = delete;
+    PairSet& operator=(const PairSet&) = delete;
+
+    // Returns false if the pair is already in the set
+    bool Add(const void* a, const void* b);
+    // Returns false if the pair isn't in the set
+    bool Remove(const void* a, const void* b);
+    bool Contains(const void* a, const void* b) const;
+
+    void Clear();
+    int32 Count() const;
+
+private:
+    struct Pair
+    {
+        const void* a;
+        const void* b;
+    };
+
+    Pair* pairs;
+    int32 capacity; // Power of two
+    int32 count;
+
+    static Pair MakePair(const void* a, const void* b);
+    int32 GetSlot(const Pair& pair) const;
+    int32 Find(const Pair& pair) const;
+    void Grow();
+};
+
+inline int32 PairSet::Count() const
+{
+    return count;
+}
+
+inline PairSet::Pair PairSet::MakePair(const void* a, const void* b)
+{
+    return a < b ? Pair{ a, b } : Pair{ b, a };
+}
+
+} // namespace muli
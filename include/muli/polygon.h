@@ -55,6 +55,24 @@ inline int32 Polygon::GetVertexCount() const
     return vertexCount;
 }
 
+inline int32 Polygon::GetSupport(const Vec2& localDir) const
+{
+    int32 index = 0;
+    float maxValue = Dot(localDir, vertices[0]);
+
+    for (int32 i = 1; i < vertexCount; ++i)
+    {
+        float value = Dot(localDir, vertices[i]);
+        if (value > maxValue)
+        {
+            index = i;
+            maxValue = value;
+        }
+    }
+
+    return index;
+}
+
 inline const Vec2* Polygon::GetVertices() const
 {
     return vertices;
@@ -22,8 +22,8 @@ public:
         float jointMass = 1.0f
     );
 
-    virtual void Prepare(const Timestep& step) override;
-    virtual void SolveVelocityConstraints(const Timestep& step) override;
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) override;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) override;
 
     const Vec2& GetGroundAnchorA() const;
     const Vec2& GetGroundAnchorB() const;
@@ -49,7 +49,7 @@ private:
     float bias;
     float impulseSum;
 
-    void ApplyImpulse(float lambda);
+    void ApplyImpulse(SolverBodies& bodies, float lambda);
 };
 
 inline const Vec2& PulleyJoint::GetGroundAnchorA() const
@@ -186,11 +186,10 @@ protected:
     friend class ContactManager;
 
     friend class Collider;
+    friend class StaticScene;
 
+    friend class Constraint;
     friend class Contact;
-    friend class ContactSolver;
-    friend class BlockSolver;
-    friend class PositionSolver;
 
     friend class Joint;
     friend class GrabJoint;
@@ -234,6 +233,9 @@ protected:
     int32 islandIndex;
     int32 islandID;
 
+    // Graph colors of the constraints attached to this body
+    uint32 colorMask;
+
     uint16 flag;
 
     void ResetMassData();
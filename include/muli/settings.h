@@ -1,6 +1,7 @@
 #pragma once
 
 #include "aabb.h"
+#include "task.h"
 
 namespace muli
 {
@@ -27,14 +28,36 @@ constexpr float epa_tolerance = epsilon;
 
 constexpr float contact_merge_threshold = linear_slop * 0.001f;
 
+// Manifold reuse, see WorldSettings::manifold_reuse
+// Bound of the relative motion of the colliders since the last narrow phase call of their contact
+constexpr float manifold_reuse_tolerance = linear_slop * 0.25f; // meters
+
 // Continuous simulation settings
 constexpr int32 max_sub_steps = 8;
 constexpr int32 max_toi_contacts = 32;
 
+// Parallel solver settings
+// Constraints that don't fit in any color are solved serially after the colored ones
+constexpr int32 graph_color_count = 24;
+// Islands with fewer constraints are solved by a single worker
+constexpr int32 graph_coloring_threshold = 256;
+
 // Broad phase settings
 constexpr Vec2 aabb_margin{ 0.03f };
 constexpr float aabb_multiplier = 3.0f;
 
+// Adaptive fat aabb margins, see WorldSettings::adaptive_aabb_margin
+constexpr float aabb_motion_smoothing = 0.2f;     // Weight of the last step in the motion history of a proxy
+constexpr float aabb_max_prediction_steps = 4.0f; // Slow steady motion is predicted up to this many steps ahead
+constexpr float aabb_max_prediction = 1.0f;       // The prediction grows up to this ratio of the proxy size
+constexpr float aabb_jitter_margin = 4.0f;        // The margin covers this many times the recent deviation from the motion
+constexpr float aabb_max_margin = 0.25f; // Fast erratic proxies grow the margin above aabb_margin up to this ratio of their size
+
+// Refit tree, see WorldSettings::refit_tree
+constexpr float refit_rebuild_threshold = 0.05f;     // Tree cost growth that rebuilds the worst subtrees
+constexpr float refit_full_rebuild_threshold = 0.5f; // Tree cost growth that rebuilds the whole tree
+constexpr int32 refit_rebuild_leaves = 512;          // Leaves rebuilt per refit by the partial rebuilds
+
 // Default body/collider settings
 
 // Radius must be greater than 2.0 * linear_slop for stable CCD
@@ -66,6 +89,7 @@ struct Timestep
     int32 position_iterations = 3;
 
     bool warm_starting = true;
+    bool block_solve = true; // Solve two contact points simultaneously
     float dt;
     float inv_dt;
 };
@@ -86,7 +110,46 @@ struct WorldSettings
 
     AABB world_bounds{ Vec2{ -max_value, -max_value }, Vec2{ max_value, max_value } };
 
-    mutable Timestep step;
+    enum BroadPhaseType : uint8
+    {
+        dynamic_tree = 0,
+        sweep_and_prune, // Suits many similar sized bodies spread along one axis
+        uniform_grid,    // Suits many bodies smaller than the cell size
+        refit_tree,      // Dynamic tree refitted in place, suits scenes where most bodies move every step
+    };
+
+    // Read once when the world is created
+    BroadPhaseType broad_phase = dynamic_tree;
+    float grid_cell_size = 1.0f; // meters, fat aabbs larger than this are kept in a tree
+
+    // Size the fat aabb of each proxy by its recent motion: steady motion is predicted further ahead
+    // and fast proxies widen the margin as erratically as they move, both bounded by the size of the proxy.
+    // Slow and resting proxies never get a margin below the constant aabb_margin.
+    // World::GetBroadPhaseStats() shows the reinsertions and the false positive pairs to compare against
+    bool adaptive_aabb_margin = false;
+
+    // Skip the narrow phase of the touching contacts whose bodies barely moved relative to each other since their last
+    // narrow phase call, the cached manifold is moved along with the bodies instead.
+    // World::GetBroadPhaseStats() shows the reused manifolds
+    bool manifold_reuse = false;
+
+    // Multithreading settings
+    // Setting worker_count greater than 1 runs the narrow phase and the awake islands in parallel
+    // The world runs its own thread pool unless the task callbacks are provided
+    int32 worker_count = 1;
+    EnqueueTaskFunction* enqueue_task = nullptr;
+    FinishTaskFunction* finish_task = nullptr;
+    void* user_task_context = nullptr;
+
+    // Split the constraints into colors that share no dynamic body, so a single large island can be solved in parallel
+    // Only islands of at least graph_coloring_threshold constraints are solved by color, and only with more than one worker
+    bool graph_coloring = false;
+
+    // Solve the contacts of each graph color in SIMD lanes, simd_width contacts at a time
+    // Islands are solved color by color when enabled, but spread over the workers only with graph_coloring
+    bool wide_solver = false;
+
+    Timestep step;
 };
 
 } // namespace muli
\ No newline at end of file
@@ -0,0 +1,363 @@
+#pragma once
+
+#include "types.h"
+
+// Lane width is chosen at compile time. It changes the layout of public types such as the wide tree nodes,
+// so the library and its users must agree on it: the build exports the definitions below to its users
+// Define MULI_NO_SIMD to use the portable scalar lanes
+// Define MULI_ENABLE_AVX and compile with AVX to use 8 wide lanes
+#if !defined(MULI_NO_SIMD) && defined(MULI_ENABLE_AVX)
+#if !defined(__AVX__)
+#error "MULI_ENABLE_AVX requires compiling with AVX enabled (-mavx or /arch:AVX)"
+#endif
+#define MULI_SIMD_AVX 1
+#include <immintrin.h>
+#elif !defined(MULI_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MULI_SIMD_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace muli
+{
+
+// Min/Max follow fminf/fmaxf and return the first argument on ties,
+// so the lanes produce bit-identical results to the scalar solver
+
+#if defined(MULI_SIMD_AVX)
+
+constexpr int32 simd_width = 8;
+
+struct FloatW
+{
+    __m256 v;
+};
+
+struct MaskW
+{
+    __m256 v;
+};
+
+inline FloatW SplatW(float s)
+{
+    return FloatW{ _mm256_set1_ps(s) };
+}
+
+inline FloatW LoadW(const float* p)
+{
+    return FloatW{ _mm256_loadu_ps(p) };
+}
+
+inline void StoreW(float* p, const FloatW& a)
+{
+    _mm256_storeu_ps(p, a.v);
+}
+
+inline FloatW operator+(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm256_add_ps(a.v, b.v) };
+}
+
+inline FloatW operator-(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm256_sub_ps(a.v, b.v) };
+}
+
+inline FloatW operator*(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm256_mul_ps(a.v, b.v) };
+}
+
+inline FloatW operator/(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm256_div_ps(a.v, b.v) };
+}
+
+inline FloatW operator-(const FloatW& a)
+{
+    return FloatW{ _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) };
+}
+
+inline FloatW MinW(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm256_min_ps(b.v, a.v) };
+}
+
+inline FloatW MaxW(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm256_max_ps(b.v, a.v) };
+}
+
+inline MaskW operator>(const FloatW& a, const FloatW& b)
+{
+    return MaskW{ _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ) };
+}
+
+inline MaskW operator>=(const FloatW& a, const FloatW& b)
+{
+    return MaskW{ _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ) };
+}
+
+inline MaskW operator<=(const FloatW& a, const FloatW& b)
+{
+    return MaskW{ _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) };
+}
+
+inline MaskW AndW(const MaskW& a, const MaskW& b)
+{
+    return MaskW{ _mm256_and_ps(a.v, b.v) };
+}
+
+inline MaskW OrW(const MaskW& a, const MaskW& b)
+{
+    return MaskW{ _mm256_or_ps(a.v, b.v) };
+}
+
+// Lanes of a where the mask is set, lanes of b elsewhere
+inline FloatW SelectW(const MaskW& mask, const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm256_blendv_ps(b.v, a.v, mask.v) };
+}
+
+inline int32 MaskBits(const MaskW& mask)
+{
+    return _mm256_movemask_ps(mask.v);
+}
+
+#elif defined(MULI_SIMD_SSE)
+
+constexpr int32 simd_width = 4;
+
+struct FloatW
+{
+    __m128 v;
+};
+
+struct MaskW
+{
+    __m128 v;
+};
+
+inline FloatW SplatW(float s)
+{
+    return FloatW{ _mm_set1_ps(s) };
+}
+
+inline FloatW LoadW(const float* p)
+{
+    return FloatW{ _mm_loadu_ps(p) };
+}
+
+inline void StoreW(float* p, const FloatW& a)
+{
+    _mm_storeu_ps(p, a.v);
+}
+
+inline FloatW operator+(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm_add_ps(a.v, b.v) };
+}
+
+inline FloatW operator-(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm_sub_ps(a.v, b.v) };
+}
+
+inline FloatW operator*(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm_mul_ps(a.v, b.v) };
+}
+
+inline FloatW operator/(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm_div_ps(a.v, b.v) };
+}
+
+inline FloatW operator-(const FloatW& a)
+{
+    return FloatW{ _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)) };
+}
+
+inline FloatW MinW(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm_min_ps(b.v, a.v) };
+}
+
+inline FloatW MaxW(const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm_max_ps(b.v, a.v) };
+}
+
+inline MaskW operator>(const FloatW& a, const FloatW& b)
+{
+    return MaskW{ _mm_cmpgt_ps(a.v, b.v) };
+}
+
+inline MaskW operator>=(const FloatW& a, const FloatW& b)
+{
+    return MaskW{ _mm_cmpge_ps(a.v, b.v) };
+}
+
+inline MaskW operator<=(const FloatW& a, const FloatW& b)
+{
+    return MaskW{ _mm_cmple_ps(a.v, b.v) };
+}
+
+inline MaskW AndW(const MaskW& a, const MaskW& b)
+{
+    return MaskW{ _mm_and_ps(a.v, b.v) };
+}
+
+inline MaskW OrW(const MaskW& a, const MaskW& b)
+{
+    return MaskW{ _mm_or_ps(a.v, b.v) };
+}
+
+// Lanes of a where the mask is set, lanes of b elsewhere
+inline FloatW SelectW(const MaskW& mask, const FloatW& a, const FloatW& b)
+{
+    return FloatW{ _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+}
+
+inline int32 MaskBits(const MaskW& mask)
+{
+    return _mm_movemask_ps(mask.v);
+}
+
+#else
+
+// Portable fallback, the compiler may still vectorize the lane loops
+constexpr int32 simd_width = 4;
+
+struct FloatW
+{
+    float v[simd_width];
+};
+
+struct MaskW
+{
+    bool v[simd_width];
+};
+
+inline FloatW SplatW(float s)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = s;
+    return r;
+}
+
+inline FloatW LoadW(const float* p)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = p[i];
+    return r;
+}
+
+inline void StoreW(float* p, const FloatW& a)
+{
+    for (int32 i = 0; i < simd_width; ++i) p[i] = a.v[i];
+}
+
+inline FloatW operator+(const FloatW& a, const FloatW& b)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] + b.v[i];
+    return r;
+}
+
+inline FloatW operator-(const FloatW& a, const FloatW& b)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] - b.v[i];
+    return r;
+}
+
+inline FloatW operator*(const FloatW& a, const FloatW& b)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] * b.v[i];
+    return r;
+}
+
+inline FloatW operator/(const FloatW& a, const FloatW& b)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] / b.v[i];
+    return r;
+}
+
+inline FloatW operator-(const FloatW& a)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = -a.v[i];
+    return r;
+}
+
+inline FloatW MinW(const FloatW& a, const FloatW& b)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i];
+    return r;
+}
+
+inline FloatW MaxW(const FloatW& a, const FloatW& b)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = b.v[i] > a.v[i] ? b.v[i] : a.v[i];
+    return r;
+}
+
+inline MaskW operator>(const FloatW& a, const FloatW& b)
+{
+    MaskW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] > b.v[i];
+    return r;
+}
+
+inline MaskW operator>=(const FloatW& a, const FloatW& b)
+{
+    MaskW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] >= b.v[i];
+    return r;
+}
+
+inline MaskW operator<=(const FloatW& a, const FloatW& b)
+{
+    MaskW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] <= b.v[i];
+    return r;
+}
+
+inline MaskW AndW(const MaskW& a, const MaskW& b)
+{
+    MaskW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] && b.v[i];
+    return r;
+}
+
+inline MaskW OrW(const MaskW& a, const MaskW& b)
+{
+    MaskW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = a.v[i] || b.v[i];
+    return r;
+}
+
+// Lanes of a where the mask is set, lanes of b elsewhere
+inline FloatW SelectW(const MaskW& mask, const FloatW& a, const FloatW& b)
+{
+    FloatW r;
+    for (int32 i = 0; i < simd_width; ++i) r.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+
+inline int32 MaskBits(const MaskW& mask)
+{
+    int32 bits = 0;
+    for (int32 i = 0; i < simd_width; ++i) bits |= int32(mask.v[i]) << i;
+    return bits;
+}
+
+#endif
+
+constexpr int32 simd_all_lanes = (1 << simd_width) - 1;
+
+} // namespace muli
@@ -33,6 +33,14 @@ struct Simplex
     float divisor;
 };
 
+// Support point ids of the last gjk simplex of a shape pair, seeds the next gjk call on the same pair
+struct SimplexCache
+{
+    int32 count = 0;
+    int32 idA[max_simplex_vertex_count];
+    int32 idB[max_simplex_vertex_count];
+};
+
 inline void Simplex::AddVertex(const SupportPoint& vertex)
 {
     MuliAssert(count != max_simplex_vertex_count);
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "aabb_tree.h"
+#include "block_allocator.h"
+#include "collider.h"
+#include "common.h"
+#include "rigidbody.h"
+#include "wide_aabb_tree.h"
+
+namespace muli
+{
+
+class World;
+
+// Immutable static geometry that can be shared by many worlds
+// The colliders of the static bodies are cloned with their shapes baked into world space and put into a separate tree
+// Worlds referencing the scene only read it, so worlds can be stepped in parallel while sharing a scene
+// The scene must outlive the worlds referencing it and must not be modified after creation
+//
+// Contact listeners and world queries report the scene colliders themselves, which are shared by all the worlds.
+// Their GetBody() is the body of the scene: it belongs to no world, its GetWorld() returns nullptr and it must not be
+// modified. Contact::GetReferenceBody() and GetIncidentBody() return the scene body owned by the world instead.
+class StaticScene
+{
+public:
+    // Clones the colliders of all static bodies in the world
+    StaticScene(const World& world);
+    ~StaticScene() noexcept;
+
+    StaticScene(const StaticScene&) = delete;
+    StaticScene& operator=(const StaticScene&) = delete;
+
+    // The colliders of the scene are attached to this body, the body doesn't belong to any world
+    const RigidBody* GetBody() const;
+    const Collider* GetColliderList() const;
+    int32 GetColliderCount() const;
+
+    const AABBTree& GetTree() const;
+
+private:
+    friend class World;
+    friend class BroadPhase;
+    friend class ContactManager;
+
+    void AddCollider(const Collider* source, const Transform& tf);
+
+    BlockAllocator blockAllocator;
+
+    RigidBody body;
+    AABBTree tree;
+    WideAABBTree wideTree;
+};
+
+inline const RigidBody* StaticScene::GetBody() const
+{
+    return &body;
+}
+
+inline const Collider* StaticScene::GetColliderList() const
+{
+    return body.GetColliderList();
+}
+
+inline int32 StaticScene::GetColliderCount() const
+{
+    return body.GetColliderCount();
+}
+
+inline const AABBTree& StaticScene::GetTree() const
+{
+    return tree;
+}
+
+} // namespace muli
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "aabb.h"
+#include "aabb_tree.h"
+#include "raycast.h"
+#include "settings.h"
+
+namespace muli
+{
+
+// Sort and sweep broad phase
+// Proxies are kept sorted by the lower bound of their fat aabb on the sweep axis.
+// A moved proxy is put back in order by an insertion sort step, which is nearly constant time
+// because the proxies move only a little between the steps.
+// New proxies wait in an unsorted tail until the next Sort() and removed ones are left as holes until then.
+// The queries and casts don't scan the sorted order, a tree of the same fat aabbs answers them.
+class SweepAndPrune
+{
+public:
+    static constexpr inline NodeProxy nullProxy = -1;
+
+    SweepAndPrune();
+    ~SweepAndPrune() noexcept = default;
+
+    SweepAndPrune(const SweepAndPrune&) = delete;
+    SweepAndPrune& operator=(const SweepAndPrune&) = delete;
+
+    NodeProxy CreateProxy(Data* data, const AABB& aabb, uint32 categoryBits = all_categories);
+    bool MoveProxy(NodeProxy proxy, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin = aabb_margin);
+    void RemoveProxy(NodeProxy proxy);
+
+    const AABB& GetAABB(NodeProxy proxy) const;
+    void ClearMoved(NodeProxy proxy);
+    bool WasMoved(NodeProxy proxy) const;
+    Data* GetData(NodeProxy proxy) const;
+    void SetCategoryBits(NodeProxy proxy, uint32 categoryBits);
+    int32 GetSweepAxis() const;
+
+    // Merge the new proxies into the sorted order, drop the removed ones and pick the sweep axis
+    void Sort();
+    int32 GetEntryCount() const;
+
+    // Calls callback->PairCallback(int32 entry, Data* dataA, Data* dataB) for the overlapping pairs
+    // of the entries in [begin, end) that have at least one moved proxy, each pair is reported once
+    // Sort() must be called first
+    template <typename T>
+    void FindPairs(int32 begin, int32 end, T* callback) const;
+
+    // Proxies outside the categoryMask are skipped
+    template <typename T>
+    void Query(const Vec2& point, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void Query(const AABB& aabb, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask = all_categories) const;
+
+private:
+    struct Entry
+    {
+        AABB aabb;
+        NodeProxy proxy; // nullProxy if removed
+        bool moved;
+    };
+
+    std::vector<Entry> entries;
+    int32 sortedCount; // Entries after this are appended since the last Sort()
+    int32 removedCount;
+
+    // Proxies are the leaves of the query tree, this maps them to their index in the entries
+    AABBTree queryTree;
+    std::vector<int32> entryIndices;
+
+    int32 axis;
+
+    void Reorder(int32 index);
+    void UpdateEntryIndices(int32 begin, int32 end);
+};
+
+inline const AABB& SweepAndPrune::GetAABB(NodeProxy proxy) const
+{
+    MuliAssert(0 <= proxy && proxy < int32(entryIndices.size()));
+
+    return entries[entryIndices[proxy]].aabb;
+}
+
+inline void SweepAndPrune::ClearMoved(NodeProxy proxy)
+{
+    MuliAssert(0 <= proxy && proxy < int32(entryIndices.size()));
+
+    entries[entryIndices[proxy]].moved = false;
+}
+
+inline bool SweepAndPrune::WasMoved(NodeProxy proxy) const
+{
+    MuliAssert(0 <= proxy && proxy < int32(entryIndices.size()));
+
+    return entries[entryIndices[proxy]].moved;
+}
+
+inline Data* SweepAndPrune::GetData(NodeProxy proxy) const
+{
+    return queryTree.GetData(proxy);
+}
+
+inline void SweepAndPrune::SetCategoryBits(NodeProxy proxy, uint32 categoryBits)
+{
+    queryTree.SetCategoryBits(proxy, categoryBits);
+}
+
+inline int32 SweepAndPrune::GetSweepAxis() const
+{
+    return axis;
+}
+
+inline int32 SweepAndPrune::GetEntryCount() const
+{
+    return int32(entries.size());
+}
+
+template <typename T>
+void SweepAndPrune::FindPairs(int32 begin, int32 end, T* callback) const
+{
+    MuliAssert(sortedCount == int32(entries.size()) && removedCount == 0);
+
+    int32 count = int32(entries.size());
+
+    for (int32 i = begin; i < end; ++i)
+    {
+        const Entry& a = entries[i];
+        float upper = a.aabb.max[axis];
+
+        // Sweep the entries starting inside the extent of this one
+        for (int32 j = i + 1; j < count && entries[j].aabb.min[axis] <= upper; ++j)
+        {
+            const Entry& b = entries[j];
+
+            // Pairs of resting proxies are already known
+            if (a.moved == false && b.moved == false)
+            {
+                continue;
+            }
+
+            if (a.aabb.TestOverlap(b.aabb))
+            {
+                callback->PairCallback(i, queryTree.GetData(a.proxy), queryTree.GetData(b.proxy));
+            }
+        }
+    }
+}
+
+template <typename T>
+void SweepAndPrune::Query(const Vec2& point, T* callback, uint32 categoryMask) const
+{
+    queryTree.Query(point, callback, categoryMask);
+}
+
+template <typename T>
+void SweepAndPrune::Query(const AABB& aabb, T* callback, uint32 categoryMask) const
+{
+    queryTree.Query(aabb, callback, categoryMask);
+}
+
+template <typename T>
+void SweepAndPrune::AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask) const
+{
+    queryTree.AABBCast(input, callback, categoryMask);
+}
+
+} // namespace muli
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "types.h"
+
+namespace muli
+{
+
+// Maximum number of workers a world can utilize
+constexpr int32 max_workers = 64;
+
+// Task callback executed over the item range [begin, end)
+// workerIndex is in [0, WorldSettings::worker_count) and identifies the per-worker scratch memory
+typedef void TaskFunction(int32 begin, int32 end, int32 workerIndex, void* taskContext);
+
+// Hand over a task to the user task system
+// The items should be split into ranges of at least minRange items(except for the last range)
+// Each range must be executed exactly once and no two ranges running at the same time may share the same worker index
+// Return a user task handle that is passed to FinishTaskFunction, or nullptr if the task is already executed
+typedef void* EnqueueTaskFunction(TaskFunction* task, int32 itemCount, int32 minRange, void* taskContext, void* userContext);
+
+// Block until the task returned by EnqueueTaskFunction is completed
+typedef void FinishTaskFunction(void* userTask, void* userContext);
+
+} // namespace muli
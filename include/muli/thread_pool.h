@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common.h"
+#include "task.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace muli
+{
+
+// Minimal fork-join thread pool
+// The thread that calls Finish() participates in the task as worker 0
+// Only one task can be in flight at a time
+// Idle workers spin for a while before going to sleep, so back-to-back tasks are picked up quickly
+class ThreadPool
+{
+public:
+    ThreadPool(int32 workerCount);
+    ~ThreadPool() noexcept;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void* Enqueue(TaskFunction* task, int32 itemCount, int32 minRange, void* taskContext);
+    void Finish(void* userTask);
+
+    int32 GetWorkerCount() const;
+
+    // Adapters for WorldSettings::enqueue_task and WorldSettings::finish_task
+    // Pass the pool through WorldSettings::user_task_context
+    static void* EnqueueTask(TaskFunction* task, int32 itemCount, int32 minRange, void* taskContext, void* userContext);
+    static void FinishTask(void* userTask, void* userContext);
+
+private:
+    struct Task
+    {
+        TaskFunction* function;
+        void* context;
+        int32 itemCount;
+        int32 blockSize;
+        int32 blockCount;
+        std::atomic<int32> nextBlock;
+    };
+
+    void WorkerMain(int32 workerIndex);
+    void Execute(int32 workerIndex);
+
+    int32 workerCount;
+    std::thread* threads;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    Task task;
+    bool taskAvailable;
+    std::atomic<uint64> taskGeneration;
+    std::atomic<int32> activeWorkers;
+    bool exit;
+};
+
+inline int32 ThreadPool::GetWorkerCount() const
+{
+    return workerCount;
+}
+
+} // namespace muli
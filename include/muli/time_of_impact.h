@@ -26,15 +26,28 @@ struct TOIOutput
 
     State state;
     float t;
+
+    int32 gjkCalls;
+    int32 gjkIterations; // Gjk support points evaluated over all the gjk calls
+};
+
+// Continuous collision counters of the last step
+struct TOIStats
+{
+    int32 toiCalls;
+    int32 gjkCalls;
+    int32 gjkIterations; // Divided by the gjk calls, the average support points evaluated per gjk call
 };
 
 // clang-format off
 // Bilateral advancement method by Erin Catto, the author of Box2d(https://box2d.org/)
 // https://www.youtube.com/watch?v=7_nKOET6zwI
+// The optional cache warm starts the distance queries from the last call on the same shape pair
 void ComputeTimeOfImpact(const Shape* shapeA, Sweep sweepA,
                          const Shape* shapeB, Sweep sweepB, 
                          float tMax,
-                         TOIOutput* output);
+                         TOIOutput* output,
+                         SimplexCache* cache = nullptr);
 // clang-format on
 
 inline void ComputeTimeOfImpact(const TOIInput& input, TOIOutput* output)
@@ -0,0 +1,325 @@
+#pragma once
+
+#include "aabb.h"
+#include "aabb_tree.h"
+#include "hash.h"
+#include "raycast.h"
+#include "settings.h"
+
+namespace muli
+{
+
+// Cell list broad phase for many bodies of about the same size
+// Each proxy is listed in the cell holding the lower corner of its fat aabb, so the proxies overlapping it are found
+// in the neighboring cells. The cells are hashed into a flat table of proxy ranges filled by a counting sort.
+// Proxies larger than a cell fall back to a dynamic tree.
+// Proxies that changed their cell since the last Rebuild() are kept in a list scanned by every query.
+class UniformGrid
+{
+public:
+    static constexpr inline NodeProxy nullProxy = -1;
+
+    UniformGrid(float cellSize);
+    ~UniformGrid() noexcept = default;
+
+    UniformGrid(const UniformGrid&) = delete;
+    UniformGrid& operator=(const UniformGrid&) = delete;
+
+    NodeProxy CreateProxy(Data* data, const AABB& aabb);
+    bool MoveProxy(NodeProxy proxy, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin = aabb_margin);
+    void RemoveProxy(NodeProxy proxy);
+
+    const AABB& GetAABB(NodeProxy proxy) const;
+    void ClearMoved(NodeProxy proxy);
+    bool WasMoved(NodeProxy proxy) const;
+    Data* GetData(NodeProxy proxy) const;
+    float GetCellSize() const;
+    const AABBTree& GetLargeProxyTree() const;
+
+    // Rebuild the cell table if any proxy changed its cell
+    void Rebuild();
+
+    // Calls callback->PairCallback(int32 key, Data* dataA, Data* dataB) for the proxies overlapping the given proxy,
+    // the pair of two moved proxies is reported only by the proxy with the greater id
+    template <typename T>
+    void FindPairs(NodeProxy proxy, int32 key, T* callback) const;
+
+    // Proxies outside the categoryMask are skipped
+    template <typename T>
+    void Query(const Vec2& point, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void Query(const AABB& aabb, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask = all_categories) const;
+
+private:
+    struct Proxy
+    {
+        AABB aabb;
+        Data* data; // nullptr if free
+        int32 cellX;
+        int32 cellY;
+        NodeProxy node; // Node in the large proxy tree, or the next free proxy
+        bool large;
+        bool moved;
+        bool inTable; // Listed in the cell table at its current cell
+        bool pending; // Listed in the pending proxies
+    };
+
+    float cellSize;
+    float invCellSize;
+
+    std::vector<Proxy> proxies;
+    NodeProxy freeList;
+
+    // Proxies of each hashed cell are cellProxies[cellStart[i], cellStart[i + 1])
+    std::vector<int32> cellStart;
+    std::vector<NodeProxy> cellProxies;
+    // Proxies not found in the table at their current cell
+    std::vector<NodeProxy> pendingProxies;
+
+    AABBTree tree;
+    std::vector<NodeProxy> nodeProxies;
+
+    bool IsLarge(const AABB& aabb) const;
+    void SetCell(NodeProxy proxy);
+    void InsertLarge(NodeProxy proxy);
+
+    int32 GetCell(float v) const;
+    int32 GetBucket(int32 x, int32 y) const;
+
+    // Calls f(NodeProxy) for the proxies overlapping the aabb until it returns false
+    template <typename F>
+    bool ForEach(const AABB& aabb, F f) const;
+};
+
+inline const AABB& UniformGrid::GetAABB(NodeProxy proxy) const
+{
+    MuliAssert(0 <= proxy && proxy < int32(proxies.size()));
+
+    return proxies[proxy].aabb;
+}
+
+inline void UniformGrid::ClearMoved(NodeProxy proxy)
+{
+    MuliAssert(0 <= proxy && proxy < int32(proxies.size()));
+
+    proxies[proxy].moved = false;
+}
+
+inline bool UniformGrid::WasMoved(NodeProxy proxy) const
+{
+    MuliAssert(0 <= proxy && proxy < int32(proxies.size()));
+
+    return proxies[proxy].moved;
+}
+
+inline Data* UniformGrid::GetData(NodeProxy proxy) const
+{
+    MuliAssert(0 <= proxy && proxy < int32(proxies.size()));
+
+    return proxies[proxy].data;
+}
+
+inline float UniformGrid::GetCellSize() const
+{
+    return cellSize;
+}
+
+inline const AABBTree& UniformGrid::GetLargeProxyTree() const
+{
+    return tree;
+}
+
+inline bool UniformGrid::IsLarge(const AABB& aabb) const
+{
+    return aabb.max.x - aabb.min.x > cellSize || aabb.max.y - aabb.min.y > cellSize;
+}
+
+inline int32 UniformGrid::GetCell(float v) const
+{
+    // Clamp to keep far away proxies representable, they only share cells then
+    constexpr float max_cell = float(1 << 30);
+    return int32(std::floor(Clamp(v * invCellSize, -max_cell, max_cell)));
+}
+
+inline int32 UniformGrid::GetBucket(int32 x, int32 y) const
+{
+    uint64 h = MixBits((uint64(uint32(x)) << 32) | uint64(uint32(y)));
+    return int32(h & uint64(cellStart.size() - 2));
+}
+
+template <typename F>
+bool UniformGrid::ForEach(const AABB& aabb, F f) const
+{
+    struct TreeQuery
+    {
+        const UniformGrid* grid;
+        F& f;
+        bool proceed;
+
+        bool QueryCallback(NodeProxy node, Data* data)
+        {
+            MuliNotUsed(data);
+
+            proceed = f(grid->nodeProxies[node]);
+            return proceed;
+        }
+    } treeQuery{ this, f, true };
+
+    tree.Query(aabb, &treeQuery);
+    if (treeQuery.proceed == false)
+    {
+        return false;
+    }
+
+    // Small proxies overlapping the aabb have their lower corner within a cell from it
+    int32 x0 = GetCell(aabb.min.x - cellSize);
+    int32 y0 = GetCell(aabb.min.y - cellSize);
+    int32 x1 = GetCell(aabb.max.x);
+    int32 y1 = GetCell(aabb.max.y);
+
+    int64 cellCount = (int64(x1) - x0 + 1) * (int64(y1) - y0 + 1);
+
+    if (cellCount > int64(cellProxies.size()))
+    {
+        // Scanning all proxies is cheaper than visiting the cells
+        for (NodeProxy i : cellProxies)
+        {
+            const Proxy& p = proxies[i];
+            if (p.inTable && p.aabb.TestOverlap(aabb) && f(i) == false)
+            {
+                return false;
+            }
+        }
+    }
+    else if (cellProxies.size() > 0)
+    {
+        for (int32 y = y0; y <= y1; ++y)
+        {
+            for (int32 x = x0; x <= x1; ++x)
+            {
+                int32 bucket = GetBucket(x, y);
+
+                for (int32 k = cellStart[bucket]; k < cellStart[bucket + 1]; ++k)
+                {
+                    NodeProxy i = cellProxies[k];
+                    const Proxy& p = proxies[i];
+
+                    // Buckets are shared by the colliding cells and hold the proxies moved out since the last rebuild
+                    if (p.inTable == false || p.cellX != x || p.cellY != y)
+                    {
+                        continue;
+                    }
+
+                    if (p.aabb.TestOverlap(aabb) && f(i) == false)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    for (NodeProxy i : pendingProxies)
+    {
+        const Proxy& p = proxies[i];
+        if (p.data == nullptr || p.large || p.inTable)
+        {
+            continue;
+        }
+
+        if (p.aabb.TestOverlap(aabb) && f(i) == false)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename T>
+void UniformGrid::FindPairs(NodeProxy proxy, int32 key, T* callback) const
+{
+    MuliAssert(0 <= proxy && proxy < int32(proxies.size()));
+
+    const Proxy& a = proxies[proxy];
+
+    ForEach(a.aabb, [&](NodeProxy i) -> bool {
+        const Proxy& b = proxies[i];
+
+        if (i != proxy && (b.moved == false || i < proxy))
+        {
+            callback->PairCallback(key, a.data, b.data);
+        }
+
+        return true;
+    });
+}
+
+template <typename T>
+void UniformGrid::Query(const Vec2& point, T* callback, uint32 categoryMask) const
+{
+    Query(AABB{ point, point }, callback, categoryMask);
+}
+
+template <typename T>
+void UniformGrid::Query(const AABB& aabb, T* callback, uint32 categoryMask) const
+{
+    ForEach(aabb, [&](NodeProxy i) -> bool {
+        if ((proxies[i].data->GetFilter().bit & categoryMask) == 0)
+        {
+            return true;
+        }
+
+        return callback->QueryCallback(i, proxies[i].data);
+    });
+}
+
+template <typename T>
+void UniformGrid::AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask) const
+{
+    const Vec2 p1 = input.from;
+    const Vec2 p2 = input.to;
+    const Vec2 halfExtents = input.halfExtents;
+
+    float maxFraction = input.maxFraction;
+
+    if (p1 == p2)
+    {
+        return;
+    }
+
+    Vec2 end = p1 + (p2 - p1) * maxFraction;
+    AABB bounds{ Min(p1, end) - halfExtents, Max(p1, end) + halfExtents };
+
+    ForEach(bounds, [&](NodeProxy i) -> bool {
+        const Proxy& p = proxies[i];
+        if (p.aabb.RayCast(p1, p2, 0.0f, maxFraction, halfExtents) == max_value || (p.data->GetFilter().bit & categoryMask) == 0)
+        {
+            return true;
+        }
+
+        AABBCastInput subInput;
+        subInput.from = p1;
+        subInput.to = p2;
+        subInput.maxFraction = maxFraction;
+        subInput.halfExtents = halfExtents;
+
+        float newFraction = callback->AABBCastCallback(subInput, p.data);
+        if (newFraction == 0.0f)
+        {
+            return false;
+        }
+
+        if (newFraction > 0.0f)
+        {
+            // Shorten the ray
+            maxFraction = newFraction;
+        }
+
+        return true;
+    });
+}
+
+} // namespace muli
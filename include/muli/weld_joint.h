@@ -18,8 +18,8 @@ public:
         float jointMass = 1.0f
     );
 
-    virtual void Prepare(const Timestep& step) override;
-    virtual void SolveVelocityConstraints(const Timestep& step) override;
+    virtual void Prepare(const Timestep& step, SolverBodies& bodies) override;
+    virtual void SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies) override;
 
     const Vec2& GetLocalAnchorA() const;
     const Vec2& GetLocalAnchorB() const;
@@ -39,7 +39,7 @@ private:
     Vec3 bias;
     Vec3 impulseSum;
 
-    void ApplyImpulse(const Vec3& lambda);
+    void ApplyImpulse(SolverBodies& bodies, const Vec3& lambda);
 };
 
 inline const Vec2& WeldJoint::GetLocalAnchorA() const
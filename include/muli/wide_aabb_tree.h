@@ -0,0 +1,267 @@
+#pragma once
+
+#include "aabb_tree.h"
+#include "simd.h"
+
+#include <bit>
+
+namespace muli
+{
+
+// Read only copy of an AABBTree collapsed to simd_width children per node (BVH4 with SSE, BVH8 with AVX)
+// The bounds of the children are stored in SIMD lanes, so a traversal step tests all children at once.
+// The binary tree stays the source of truth, the copy has to be built again after the tree is modified.
+class WideAABBTree
+{
+public:
+    WideAABBTree();
+    ~WideAABBTree() noexcept = default;
+
+    WideAABBTree(const WideAABBTree&) = delete;
+    WideAABBTree& operator=(const WideAABBTree&) = delete;
+
+    void Build(const AABBTree& tree);
+    void Clear();
+
+    // Returns true if the copy is built from the current state of the tree
+    bool IsCurrent(const AABBTree& tree) const;
+
+    int32 GetNodeCount() const;
+
+    // Same callbacks as the AABBTree, the node proxies reported are the leaves of the binary tree
+    template <typename T>
+    void Query(const Vec2& point, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void Query(const AABB& aabb, T* callback, uint32 categoryMask = all_categories) const;
+    template <typename T>
+    void AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask = all_categories) const;
+
+private:
+    struct Node
+    {
+        // Empty lanes have inverted bounds, so they never pass any test
+        float minX[simd_width];
+        float minY[simd_width];
+        float maxX[simd_width];
+        float maxY[simd_width];
+
+        int32 children[simd_width]; // Index of the child node, or of the leaf if the lane is set in the leafMask
+        uint32 categoryBits[simd_width];
+        int32 leafMask;
+    };
+
+    struct Leaf
+    {
+        NodeProxy node;
+        Data* data;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Leaf> leaves;
+
+    const AABBTree* source;
+    uint32 revision;
+
+    int32 Collapse(const AABBTree& tree, NodeProxy node);
+
+    int32 TestOverlap(const Node& node, const FloatW& minX, const FloatW& minY, const FloatW& maxX, const FloatW& maxY) const;
+};
+
+inline bool WideAABBTree::IsCurrent(const AABBTree& tree) const
+{
+    return source == &tree && revision == tree.GetRevision();
+}
+
+inline int32 WideAABBTree::GetNodeCount() const
+{
+    return int32(nodes.size());
+}
+
+// Returns the lanes of the node overlapping the aabb as bits
+inline int32 WideAABBTree::TestOverlap(
+    const Node& node, const FloatW& minX, const FloatW& minY, const FloatW& maxX, const FloatW& maxY
+) const
+{
+    MaskW x = AndW(LoadW(node.minX) <= maxX, LoadW(node.maxX) >= minX);
+    MaskW y = AndW(LoadW(node.minY) <= maxY, LoadW(node.maxY) >= minY);
+
+    return MaskBits(AndW(x, y));
+}
+
+template <typename T>
+void WideAABBTree::Query(const Vec2& point, T* callback, uint32 categoryMask) const
+{
+    Query(AABB{ point, point }, callback, categoryMask);
+}
+
+template <typename T>
+void WideAABBTree::Query(const AABB& aabb, T* callback, uint32 categoryMask) const
+{
+    if (nodes.size() == 0)
+    {
+        return;
+    }
+
+    FloatW minX = SplatW(aabb.min.x);
+    FloatW minY = SplatW(aabb.min.y);
+    FloatW maxX = SplatW(aabb.max.x);
+    FloatW maxY = SplatW(aabb.max.y);
+
+    GrowableArray<int32, 256> stack;
+    stack.EmplaceBack(0);
+
+    while (stack.Count() != 0)
+    {
+        const Node& node = nodes[stack.PopBack()];
+
+        int32 hits = TestOverlap(node, minX, minY, maxX, maxY);
+        while (hits)
+        {
+            int32 lane = std::countr_zero(uint32(hits));
+            hits &= hits - 1;
+
+            if ((node.categoryBits[lane] & categoryMask) == 0)
+            {
+                continue;
+            }
+
+            int32 child = node.children[lane];
+
+            if (node.leafMask & (1 << lane))
+            {
+                bool proceed = callback->QueryCallback(leaves[child].node, leaves[child].data);
+                if (proceed == false)
+                {
+                    return;
+                }
+            }
+            else
+            {
+                stack.EmplaceBack(child);
+            }
+        }
+    }
+}
+
+template <typename T>
+void WideAABBTree::AABBCast(const AABBCastInput& input, T* callback, uint32 categoryMask) const
+{
+    const Vec2 p1 = input.from;
+    const Vec2 p2 = input.to;
+    const Vec2 halfExtents = input.halfExtents;
+
+    float maxFraction = input.maxFraction;
+
+    Vec2 d = p2 - p1;
+    if (d.Length() == 0.0f || nodes.size() == 0)
+    {
+        return;
+    }
+
+    // Slab test of all lanes, same as AABB::RayCast()
+    FloatW invDX = SplatW(1.0f / d.x);
+    FloatW invDY = SplatW(1.0f / d.y);
+    FloatW originX = SplatW(p1.x);
+    FloatW originY = SplatW(p1.y);
+    FloatW marginX = SplatW(halfExtents.x);
+    FloatW marginY = SplatW(halfExtents.y);
+    FloatW zero = SplatW(0.0f);
+
+    // Leaves are pushed with inverted bits, so the traversal stays ordered by the distance
+    GrowableArray<int32, 256> stack;
+    stack.EmplaceBack(0);
+
+    while (stack.Count() > 0)
+    {
+        int32 current = stack.PopBack();
+
+        if (current < 0)
+        {
+            const Leaf& leaf = leaves[~current];
+
+            AABBCastInput subInput;
+            subInput.from = p1;
+            subInput.to = p2;
+            subInput.maxFraction = maxFraction;
+            subInput.halfExtents = halfExtents;
+
+            float newFraction = callback->AABBCastCallback(subInput, leaf.data);
+            if (newFraction == 0.0f)
+            {
+                return;
+            }
+
+            if (newFraction > 0.0f)
+            {
+                // Shorten the ray
+                maxFraction = newFraction;
+            }
+
+            continue;
+        }
+
+        const Node& node = nodes[current];
+
+        FloatW tMin = zero;
+        FloatW tMax = SplatW(maxFraction);
+
+        FloatW t0 = (LoadW(node.minX) - marginX - originX) * invDX;
+        FloatW t1 = (LoadW(node.maxX) + marginX - originX) * invDX;
+        MaskW flip = zero > invDX;
+        FloatW lo = SelectW(flip, t1, t0);
+        FloatW hi = SelectW(flip, t0, t1);
+        tMin = SelectW(lo > tMin, lo, tMin);
+        tMax = SelectW(tMax > hi, hi, tMax);
+        MaskW hit = tMax > tMin;
+
+        t0 = (LoadW(node.minY) - marginY - originY) * invDY;
+        t1 = (LoadW(node.maxY) + marginY - originY) * invDY;
+        flip = zero > invDY;
+        lo = SelectW(flip, t1, t0);
+        hi = SelectW(flip, t0, t1);
+        tMin = SelectW(lo > tMin, lo, tMin);
+        tMax = SelectW(tMax > hi, hi, tMax);
+        hit = AndW(hit, tMax > tMin);
+
+        int32 hits = MaskBits(hit);
+        if (hits == 0)
+        {
+            continue;
+        }
+
+        float dist[simd_width];
+        StoreW(dist, tMin);
+
+        // Push the far children first, so the nearest one is visited next
+        int32 order[simd_width];
+        int32 count = 0;
+        while (hits)
+        {
+            int32 lane = std::countr_zero(uint32(hits));
+            hits &= hits - 1;
+
+            if ((node.categoryBits[lane] & categoryMask) == 0)
+            {
+                continue;
+            }
+
+            int32 i = count++;
+            while (i > 0 && dist[order[i - 1]] < dist[lane])
+            {
+                order[i] = order[i - 1];
+                --i;
+            }
+            order[i] = lane;
+        }
+
+        for (int32 i = 0; i < count; ++i)
+        {
+            int32 lane = order[i];
+            int32 child = node.children[lane];
+
+            stack.EmplaceBack((node.leafMask & (1 << lane)) ? ~child : child);
+        }
+    }
+}
+
+} // namespace muli
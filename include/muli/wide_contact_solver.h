@@ -0,0 +1,104 @@
+#pragma once
+
+#include "collision.h"
+#include "linear_allocator.h"
+#include "simd.h"
+
+namespace muli
+{
+
+class Contact;
+struct Timestep;
+struct SolverBodies;
+
+// Contacts packed into SIMD lanes, one contact per lane
+// All contacts of a batch have the same number of contact points
+struct WideContactBatch
+{
+    Contact* contacts[simd_width];
+    int32 index1[simd_width];
+    int32 index2[simd_width];
+
+    int32 contactCount;
+    int32 pointCount;
+
+    float invMass1[simd_width];
+    float invInertia1[simd_width];
+    float invMass2[simd_width];
+    float invInertia2[simd_width];
+
+    float friction[simd_width];
+    float tangentBias[simd_width];
+
+    // Jacobians of the normal and tangent constraints: [-dir, -ra × dir, dir, rb × dir]
+    float normalX[simd_width];
+    float normalY[simd_width];
+    float tangentX[simd_width];
+    float tangentY[simd_width];
+
+    float normalWA[max_contact_point_count][simd_width];
+    float normalWB[max_contact_point_count][simd_width];
+    float normalBias[max_contact_point_count][simd_width];
+    float normalMass[max_contact_point_count][simd_width];
+    float normalImpulse[max_contact_point_count][simd_width];
+
+    float tangentWA[max_contact_point_count][simd_width];
+    float tangentWB[max_contact_point_count][simd_width];
+    float tangentMass[max_contact_point_count][simd_width];
+    float tangentImpulse[max_contact_point_count][simd_width];
+
+    // Block solver matrices, K and its inverse M
+    bool blockSolve[simd_width];
+    float kxx[simd_width], kxy[simd_width], kyx[simd_width], kyy[simd_width];
+    float mxx[simd_width], mxy[simd_width], myx[simd_width], myy[simd_width];
+
+    // Position constraint in local space
+    float localPlainPointX[simd_width];
+    float localPlainPointY[simd_width];
+    float localNormalX[simd_width];
+    float localNormalY[simd_width];
+    float localClipPointX[max_contact_point_count][simd_width];
+    float localClipPointY[max_contact_point_count][simd_width];
+};
+
+// Solves the contact constraints of simd_width contacts with a single instruction stream
+// Contacts in a batch must not share any non-static body, so they are packed from a single graph color
+// The constraints are prepared by Contact::Prepare() and the accumulated impulses are written back after solving
+class WideContactSolver
+{
+public:
+    // groupCount is the maximum number of AddContacts() calls
+    WideContactSolver(LinearAllocator* allocator, int32 contactCount, int32 groupCount);
+    ~WideContactSolver();
+
+    WideContactSolver(const WideContactSolver&) = delete;
+    WideContactSolver& operator=(const WideContactSolver&) = delete;
+
+    // Pack the contacts into new batches, the contacts must not share any non-static body
+    void AddContacts(Contact** contacts, int32 count);
+
+    void Prepare(int32 batchIndex, const Timestep& step, SolverBodies& bodies);
+    void SolveVelocityConstraints(int32 batchIndex, SolverBodies& bodies);
+    bool SolvePositionConstraints(int32 batchIndex, SolverBodies& bodies);
+
+    // Write the accumulated impulses back to the contacts for warm starting and reporting
+    void StoreImpulses(int32 batchIndex);
+
+    int32 GetBatchCount() const;
+
+private:
+    void AddBatches(Contact** contacts, int32 count, int32 pointCount);
+
+    LinearAllocator* allocator;
+
+    WideContactBatch* batches;
+    int32 batchCapacity;
+    int32 batchCount;
+};
+
+inline int32 WideContactSolver::GetBatchCount() const
+{
+    return batchCount;
+}
+
+} // namespace muli
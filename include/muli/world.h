@@ -6,6 +6,9 @@
 #include "common.h"
 #include "contact_manager.h"
 #include "linear_allocator.h"
+#include "static_scene.h"
+#include "thread_pool.h"
+#include "time_of_impact.h"
 
 #include "collider.h"
 #include "rigidbody.h"
@@ -27,7 +30,8 @@ namespace muli
 class World
 {
 public:
-    World(const WorldSettings& settings);
+    // The static scene is shared read-only and must outlive the world
+    World(const WorldSettings& settings, const StaticScene* staticScene = nullptr);
     ~World() noexcept;
 
     World(const World&) noexcept = delete;
@@ -218,38 +222,63 @@ public:
     );
     // clang-format on
 
-    void Query(const Vec2& point, WorldQueryCallback* callback);
-    void Query(const AABB& aabb, WorldQueryCallback* callback);
-    void RayCastAny(const Vec2& from, const Vec2& to, float radius, RayCastAnyCallback* callback);
-    bool RayCastClosest(const Vec2& from, const Vec2& to, float radius, RayCastClosestCallback* callback);
-    void ShapeCastAny(const Shape* shape, const Transform& tf, const Vec2& translation, ShapeCastAnyCallback* callback);
-    bool ShapeCastClosest(const Shape* shape, const Transform& tf, const Vec2& translation, ShapeCastClosestCallback* callback);
+    // The colliders whose filter bit is outside the categoryMask are skipped by the broad phase
+    void Query(const Vec2& point, WorldQueryCallback* callback, uint32 categoryMask = all_categories);
+    void Query(const AABB& aabb, WorldQueryCallback* callback, uint32 categoryMask = all_categories);
+    void RayCastAny(
+        const Vec2& from, const Vec2& to, float radius, RayCastAnyCallback* callback, uint32 categoryMask = all_categories
+    );
+    bool RayCastClosest(
+        const Vec2& from, const Vec2& to, float radius, RayCastClosestCallback* callback, uint32 categoryMask = all_categories
+    );
+    void ShapeCastAny(
+        const Shape* shape,
+        const Transform& tf,
+        const Vec2& translation,
+        ShapeCastAnyCallback* callback,
+        uint32 categoryMask = all_categories
+    );
+    bool ShapeCastClosest(
+        const Shape* shape,
+        const Transform& tf,
+        const Vec2& translation,
+        ShapeCastClosestCallback* callback,
+        uint32 categoryMask = all_categories
+    );
 
-    void Query(const Vec2& point, std::function<bool(Collider* collider)> callback) const;
-    void Query(const AABB& aabb, std::function<bool(Collider* collider)> callback) const;
+    void Query(
+        const Vec2& point, std::function<bool(Collider* collider)> callback, uint32 categoryMask = all_categories
+    ) const;
+    void Query(
+        const AABB& aabb, std::function<bool(Collider* collider)> callback, uint32 categoryMask = all_categories
+    ) const;
     void RayCastAny(
         const Vec2& from,
         const Vec2& to,
         float radius,
-        std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback
+        std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback,
+        uint32 categoryMask = all_categories
     );
     bool RayCastClosest(
         const Vec2& from,
         const Vec2& to,
         float radius,
-        std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback
+        std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback,
+        uint32 categoryMask = all_categories
     );
     void ShapeCastAny(
         const Shape* shape,
         const Transform& tf,
         const Vec2& translation,
-        std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback
+        std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback,
+        uint32 categoryMask = all_categories
     );
     bool ShapeCastClosest(
         const Shape* shape,
         const Transform& tf,
         const Vec2& translation,
-        std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback
+        std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback,
+        uint32 categoryMask = all_categories
     );
 
     RigidBody* GetBodyList() const;
@@ -260,19 +289,28 @@ public:
 
     const Contact* GetContacts() const;
     int32 GetContactCount() const;
+    // Counters of the last step, to tune the fat aabb margins
+    const BroadPhaseStats& GetBroadPhaseStats() const;
+    const TOIStats& GetTOIStats() const;
 
     int32 GetSleepingBodyCount() const;
     int32 GetAwakeIslandCount() const;
 
+    // Broad phase trees of the awake, static and sleeping colliders
     const AABBTree& GetDynamicTree() const;
+    const AABBTree& GetStaticTree() const;
+    const AABBTree& GetSleepingTree() const;
     void RebuildDynamicTree();
 
     const WorldSettings& GetWorldSettings() const;
+    int32 GetWorkerCount() const;
+    const StaticScene* GetStaticScene() const;
 
     void Awake();
 
 private:
     friend class RigidBody;
+    friend class Collider;
     friend class Island;
     friend class ContactManager;
     friend class BroadPhase;
@@ -280,11 +318,22 @@ private:
     void Solve();
     float SolveTOI();
 
+    void UpdateWorkers();
+    void RunTask(TaskFunction* task, int32 itemCount, int32 minRange, void* taskContext);
+    static void SolveIslandTask(int32 begin, int32 end, int32 workerIndex, void* taskContext);
+
     void FreeBody(RigidBody* body);
     void AddJoint(Joint* joint);
     void FreeJoint(Joint* joint);
 
     const WorldSettings& settings;
+    // Copied from the settings at every Step(), so the settings are never written by the world
+    Timestep step;
+
+    // Shared static geometry, the contacts against the scene are attached to the scene body owned by this world
+    const StaticScene* staticScene;
+    RigidBody* sceneBody;
+
     ContactManager contactManager;
 
     // Doubly linked list of all registered rigid bodies
@@ -299,12 +348,18 @@ private:
     int32 sleepingBodyCount;
 
     bool stepComplete;
+    TOIStats toiStats;
 
     std::vector<RigidBody*> destroyBodyBuffer;
     std::vector<Joint*> destroyJointBuffer;
 
     LinearAllocator linearAllocator;
     BlockAllocator blockAllocator;
+
+    // Per-worker scratch memory and the built-in thread pool
+    int32 workerCount;
+    LinearAllocator* workerAllocators;
+    ThreadPool* threadPool;
 };
 
 inline void World::Awake()
@@ -350,6 +405,16 @@ inline int32 World::GetContactCount() const
     return contactManager.contactCount;
 }
 
+inline const BroadPhaseStats& World::GetBroadPhaseStats() const
+{
+    return contactManager.broadPhase.GetStats();
+}
+
+inline const TOIStats& World::GetTOIStats() const
+{
+    return toiStats;
+}
+
 inline Joint* World::GetJoints() const
 {
     return jointList;
@@ -362,12 +427,22 @@ inline int32 World::GetJointCount() const
 
 inline const AABBTree& World::GetDynamicTree() const
 {
-    return contactManager.broadPhase.tree;
+    return contactManager.broadPhase.trees[BroadPhase::active_tree];
+}
+
+inline const AABBTree& World::GetStaticTree() const
+{
+    return contactManager.broadPhase.trees[BroadPhase::static_tree];
+}
+
+inline const AABBTree& World::GetSleepingTree() const
+{
+    return contactManager.broadPhase.trees[BroadPhase::sleeping_tree];
 }
 
 inline void World::RebuildDynamicTree()
 {
-    contactManager.broadPhase.tree.Rebuild();
+    contactManager.broadPhase.trees[BroadPhase::active_tree].Rebuild();
 }
 
 inline const WorldSettings& World::GetWorldSettings() const
@@ -375,4 +450,14 @@ inline const WorldSettings& World::GetWorldSettings() const
     return settings;
 }
 
+inline int32 World::GetWorkerCount() const
+{
+    return workerCount;
+}
+
+inline const StaticScene* World::GetStaticScene() const
+{
+    return staticScene;
+}
+
 } // namespace muli
\ No newline at end of file
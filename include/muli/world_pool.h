@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common.h"
+#include "thread_pool.h"
+#include "world.h"
+
+namespace muli
+{
+
+// Steps many independent worlds in parallel, e.g. for batch simulation
+// Worlds don't share any mutable state, so each world can be stepped on a different thread
+// The pooled worlds should use a single worker(WorldSettings::worker_count = 1), the parallelism comes from the pool
+class WorldPool
+{
+public:
+    WorldPool(int32 workerCount);
+    ~WorldPool() noexcept = default;
+
+    WorldPool(const WorldPool&) = delete;
+    WorldPool& operator=(const WorldPool&) = delete;
+
+    // Advance each world by stepCount steps
+    void Step(std::span<World*> worlds, float dt, int32 stepCount = 1);
+
+    int32 GetWorkerCount() const;
+
+private:
+    static void StepTask(int32 begin, int32 end, int32 workerIndex, void* taskContext);
+
+    ThreadPool threadPool;
+};
+
+inline int32 WorldPool::GetWorkerCount() const
+{
+    return threadPool.GetWorkerCount();
+}
+
+} // namespace muli
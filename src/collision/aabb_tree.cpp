@@ -1,6 +1,8 @@
 #include "muli/aabb_tree.h"
 #include "muli/growable_array.h"
 
+#include <bit>
+
 namespace muli
 {
 
@@ -8,6 +10,8 @@ AABBTree::AABBTree()
     : root{ nullNode }
     , nodeCapacity{ 32 }
     , nodeCount{ 0 }
+    , revision{ 0 }
+    , refitQuality{ 0.0f }
 {
     nodes = (Node*)muli::Alloc(nodeCapacity * sizeof(Node));
     memset(nodes, 0, nodeCapacity * sizeof(Node));
@@ -40,6 +44,8 @@ AABBTree::AABBTree(AABBTree&& other) noexcept
     nodeCapacity = other.nodeCapacity;
 
     freeList = other.freeList;
+    revision = other.revision;
+    refitQuality = other.refitQuality;
 
     other.root = nullNode;
 
@@ -63,6 +69,8 @@ AABBTree& AABBTree::operator=(AABBTree&& other) noexcept
     nodeCapacity = other.nodeCapacity;
 
     freeList = other.freeList;
+    revision = other.revision;
+    refitQuality = other.refitQuality;
 
     other.root = nullNode;
 
@@ -80,6 +88,8 @@ NodeProxy AABBTree::InsertLeaf(NodeProxy leaf)
     MuliAssert(0 <= leaf && leaf < nodeCapacity);
     MuliAssert(nodes[leaf].IsLeaf());
 
+    ++revision;
+
     if (root == nullNode)
     {
         root = leaf;
@@ -192,6 +202,7 @@ NodeProxy AABBTree::InsertLeaf(NodeProxy leaf)
     NodeProxy oldParent = nodes[bestSibling].parent;
     NodeProxy newParent = AllocateNode();
     nodes[newParent].aabb = AABB::Union(aabb, nodes[bestSibling].aabb);
+    nodes[newParent].categoryBits = nodes[leaf].categoryBits | nodes[bestSibling].categoryBits;
     nodes[newParent].data = nullptr;
     nodes[newParent].parent = oldParent;
 
@@ -225,6 +236,8 @@ NodeProxy AABBTree::InsertLeaf(NodeProxy leaf)
         NodeProxy child2 = nodes[ancestor].child2;
 
         nodes[ancestor].aabb = AABB::Union(nodes[child1].aabb, nodes[child2].aabb);
+        nodes[ancestor].moved = nodes[child1].moved || nodes[child2].moved;
+        nodes[ancestor].categoryBits = nodes[child1].categoryBits | nodes[child2].categoryBits;
 
         Rotate(ancestor);
 
@@ -239,6 +252,8 @@ void AABBTree::RemoveLeaf(NodeProxy leaf)
     MuliAssert(0 <= leaf && leaf < nodeCapacity);
     MuliAssert(nodes[leaf].IsLeaf());
 
+    ++revision;
+
     NodeProxy parent = nodes[leaf].parent;
     if (parent == nullNode) // node is root
     {
@@ -280,6 +295,8 @@ void AABBTree::RemoveLeaf(NodeProxy leaf)
             NodeProxy child2 = nodes[ancestor].child2;
 
             nodes[ancestor].aabb = AABB::Union(nodes[child1].aabb, nodes[child2].aabb);
+            nodes[ancestor].moved = nodes[child1].moved || nodes[child2].moved;
+            nodes[ancestor].categoryBits = nodes[child1].categoryBits | nodes[child2].categoryBits;
 
             Rotate(ancestor);
 
@@ -293,7 +310,7 @@ void AABBTree::RemoveLeaf(NodeProxy leaf)
     }
 }
 
-NodeProxy AABBTree::CreateNode(Data* data, const AABB& aabb)
+NodeProxy AABBTree::CreateNode(Data* data, const AABB& aabb, uint32 categoryBits)
 {
     NodeProxy newNode = AllocateNode();
 
@@ -303,13 +320,29 @@ NodeProxy AABBTree::CreateNode(Data* data, const AABB& aabb)
     nodes[newNode].data = data;
     nodes[newNode].parent = nullNode;
     nodes[newNode].moved = true;
+    nodes[newNode].categoryBits = categoryBits;
+
+    InsertLeaf(newNode);
+
+    return newNode;
+}
+
+NodeProxy AABBTree::InsertNode(Data* data, const AABB& fatAABB, bool moved, uint32 categoryBits)
+{
+    NodeProxy newNode = AllocateNode();
+
+    nodes[newNode].aabb = fatAABB;
+    nodes[newNode].data = data;
+    nodes[newNode].parent = nullNode;
+    nodes[newNode].moved = moved;
+    nodes[newNode].categoryBits = categoryBits;
 
     InsertLeaf(newNode);
 
     return newNode;
 }
 
-bool AABBTree::MoveNode(NodeProxy node, AABB aabb, const Vec2& displacement, bool forceMove)
+bool AABBTree::MoveNode(NodeProxy node, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin)
 {
     MuliAssert(0 <= node && node < nodeCapacity);
     MuliAssert(nodes[node].IsLeaf());
@@ -320,41 +353,74 @@ bool AABBTree::MoveNode(NodeProxy node, AABB aabb, const Vec2& displacement, boo
         return false;
     }
 
-    Vec2 d = displacement * aabb_multiplier;
+    aabb.Fatten(displacement * aabb_multiplier, margin);
 
-    if (d.x > 0.0f)
-    {
-        aabb.max.x += d.x;
-    }
-    else
-    {
-        aabb.min.x += d.x;
-    }
+    RemoveLeaf(node);
 
-    if (d.y > 0.0f)
-    {
-        aabb.max.y += d.y;
-    }
-    else
+    nodes[node].aabb = aabb;
+    nodes[node].moved = true;
+
+    InsertLeaf(node);
+
+    return true;
+}
+
+bool AABBTree::RefitNode(NodeProxy node, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin)
+{
+    MuliAssert(0 <= node && node < nodeCapacity);
+    MuliAssert(nodes[node].IsLeaf());
+
+    const AABB& treeAABB = nodes[node].aabb;
+    if (treeAABB.Contains(aabb) && forceMove == false)
     {
-        aabb.min.y += d.y;
+        return false;
     }
 
-    // Fatten the aabb
-    aabb.max += aabb_margin;
-    aabb.min -= aabb_margin;
-
-    RemoveLeaf(node);
+    aabb.Fatten(displacement * aabb_multiplier, margin);
 
     nodes[node].aabb = aabb;
+    nodes[node].moved = true;
+    ++revision;
 
-    InsertLeaf(node);
+    // Keep the tree valid for the queries until the next refit
+    NodeProxy ancestor = nodes[node].parent;
+    while (ancestor != nullNode)
+    {
+        if (nodes[ancestor].moved && nodes[ancestor].aabb.Contains(aabb))
+        {
+            break;
+        }
 
-    nodes[node].moved = true;
+        nodes[ancestor].aabb = AABB::Union(nodes[ancestor].aabb, aabb);
+        nodes[ancestor].moved = true;
+        ancestor = nodes[ancestor].parent;
+    }
 
     return true;
 }
 
+void AABBTree::SetCategoryBits(NodeProxy node, uint32 categoryBits)
+{
+    MuliAssert(0 <= node && node < nodeCapacity);
+    MuliAssert(nodes[node].IsLeaf());
+
+    nodes[node].categoryBits = categoryBits;
+    ++revision;
+
+    NodeProxy ancestor = nodes[node].parent;
+    while (ancestor != nullNode)
+    {
+        uint32 bits = nodes[nodes[ancestor].child1].categoryBits | nodes[nodes[ancestor].child2].categoryBits;
+        if (bits == nodes[ancestor].categoryBits)
+        {
+            break;
+        }
+
+        nodes[ancestor].categoryBits = bits;
+        ancestor = nodes[ancestor].parent;
+    }
+}
+
 void AABBTree::RemoveNode(NodeProxy node)
 {
     MuliAssert(0 <= node && node < nodeCapacity);
@@ -364,6 +430,80 @@ void AABBTree::RemoveNode(NodeProxy node)
     FreeNode(node);
 }
 
+void AABBTree::RemoveNodes(std::span<const NodeProxy> leaves)
+{
+    // Ancestors whose subtree lost a leaf
+    GrowableArray<NodeProxy, 256> refitNodes;
+
+    for (NodeProxy leaf : leaves)
+    {
+        MuliAssert(0 <= leaf && leaf < nodeCapacity);
+        MuliAssert(nodes[leaf].IsLeaf());
+
+        NodeProxy parent = nodes[leaf].parent;
+        if (parent == nullNode) // node is root
+        {
+            MuliAssert(root == leaf);
+            root = nullNode;
+        }
+        else
+        {
+            // Replace the parent with the sibling
+            NodeProxy grandParent = nodes[parent].parent;
+            NodeProxy sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+            FreeNode(parent);
+            nodes[sibling].parent = grandParent;
+
+            if (grandParent != nullNode)
+            {
+                if (nodes[grandParent].child1 == parent)
+                {
+                    nodes[grandParent].child1 = sibling;
+                }
+                else
+                {
+                    nodes[grandParent].child2 = sibling;
+                }
+
+                refitNodes.PushBack(grandParent);
+            }
+            else
+            {
+                root = sibling;
+            }
+        }
+
+        FreeNode(leaf);
+    }
+
+    for (int32 i = 0; i < refitNodes.Count(); ++i)
+    {
+        NodeProxy ancestor = refitNodes[i];
+
+        // Skip the nodes freed by a later removal and stop where the aabb doesn't change anymore
+        while (ancestor != nullNode && nodes[ancestor].parent != ancestor)
+        {
+            NodeProxy child1 = nodes[ancestor].child1;
+            NodeProxy child2 = nodes[ancestor].child2;
+
+            AABB aabb = AABB::Union(nodes[child1].aabb, nodes[child2].aabb);
+            bool moved = nodes[child1].moved || nodes[child2].moved;
+            uint32 categoryBits = nodes[child1].categoryBits | nodes[child2].categoryBits;
+            if (aabb.min == nodes[ancestor].aabb.min && aabb.max == nodes[ancestor].aabb.max && moved == nodes[ancestor].moved &&
+                categoryBits == nodes[ancestor].categoryBits)
+            {
+                break;
+            }
+
+            nodes[ancestor].aabb = aabb;
+            nodes[ancestor].moved = moved;
+            nodes[ancestor].categoryBits = categoryBits;
+            ancestor = nodes[ancestor].parent;
+        }
+    }
+}
+
 void AABBTree::Rotate(NodeProxy node)
 {
     if (nodes[node].IsLeaf())
@@ -418,6 +558,8 @@ void AABBTree::Rotate(NodeProxy node)
         nodes[child2].parent = child1;
 
         nodes[child1].aabb = AABB::Union(nodes[nodes[child1].child1].aabb, nodes[nodes[child1].child2].aabb);
+        nodes[child1].moved = nodes[nodes[child1].child1].moved || nodes[nodes[child1].child2].moved;
+        nodes[child1].categoryBits = nodes[nodes[child1].child1].categoryBits | nodes[nodes[child1].child2].categoryBits;
     }
     break;
     case 1:
@@ -430,6 +572,8 @@ void AABBTree::Rotate(NodeProxy node)
         nodes[child2].parent = child1;
 
         nodes[child1].aabb = AABB::Union(nodes[nodes[child1].child1].aabb, nodes[nodes[child1].child2].aabb);
+        nodes[child1].moved = nodes[nodes[child1].child1].moved || nodes[nodes[child1].child2].moved;
+        nodes[child1].categoryBits = nodes[nodes[child1].child1].categoryBits | nodes[nodes[child1].child2].categoryBits;
     }
     break;
     case 2:
@@ -442,6 +586,8 @@ void AABBTree::Rotate(NodeProxy node)
         nodes[child1].parent = child2;
 
         nodes[child2].aabb = AABB::Union(nodes[nodes[child2].child1].aabb, nodes[nodes[child2].child2].aabb);
+        nodes[child2].moved = nodes[nodes[child2].child1].moved || nodes[nodes[child2].child2].moved;
+        nodes[child2].categoryBits = nodes[nodes[child2].child1].categoryBits | nodes[nodes[child2].child2].categoryBits;
     }
     break;
     case 3:
@@ -454,6 +600,8 @@ void AABBTree::Rotate(NodeProxy node)
         nodes[child1].parent = child2;
 
         nodes[child2].aabb = AABB::Union(nodes[nodes[child2].child1].aabb, nodes[nodes[child2].child2].aabb);
+        nodes[child2].moved = nodes[nodes[child2].child1].moved || nodes[nodes[child2].child2].moved;
+        nodes[child2].categoryBits = nodes[nodes[child2].child1].categoryBits | nodes[nodes[child2].child2].categoryBits;
     }
     break;
     }
@@ -517,7 +665,7 @@ void AABBTree::Traverse(std::function<void(const Node*)> callback) const
     }
 }
 
-void AABBTree::Query(const Vec2& point, std::function<bool(NodeProxy, Data*)> callback) const
+void AABBTree::Query(const Vec2& point, std::function<bool(NodeProxy, Data*)> callback, uint32 categoryMask) const
 {
     if (root == nullNode)
     {
@@ -531,7 +679,7 @@ void AABBTree::Query(const Vec2& point, std::function<bool(NodeProxy, Data*)> ca
     {
         NodeProxy current = stack.PopBack();
 
-        if (nodes[current].aabb.TestPoint(point) == false)
+        if ((nodes[current].categoryBits & categoryMask) == 0 || nodes[current].aabb.TestPoint(point) == false)
         {
             continue;
         }
@@ -552,7 +700,7 @@ void AABBTree::Query(const Vec2& point, std::function<bool(NodeProxy, Data*)> ca
     }
 }
 
-void AABBTree::Query(const AABB& aabb, std::function<bool(NodeProxy, Data*)> callback) const
+void AABBTree::Query(const AABB& aabb, std::function<bool(NodeProxy, Data*)> callback, uint32 categoryMask) const
 {
     if (root == nullNode)
     {
@@ -566,7 +714,7 @@ void AABBTree::Query(const AABB& aabb, std::function<bool(NodeProxy, Data*)> cal
     {
         NodeProxy current = stack.PopBack();
 
-        if (nodes[current].aabb.TestOverlap(aabb) == false)
+        if ((nodes[current].categoryBits & categoryMask) == 0 || nodes[current].aabb.TestOverlap(aabb) == false)
         {
             continue;
         }
@@ -587,7 +735,9 @@ void AABBTree::Query(const AABB& aabb, std::function<bool(NodeProxy, Data*)> cal
     }
 }
 
-void AABBTree::AABBCast(const AABBCastInput& input, std::function<float(const AABBCastInput& input, Data* data)> callback) const
+void AABBTree::AABBCast(
+    const AABBCastInput& input, std::function<float(const AABBCastInput& input, Data* data)> callback, uint32 categoryMask
+) const
 {
     const Vec2 p1 = input.from;
     const Vec2 p2 = input.to;
@@ -608,7 +758,7 @@ void AABBTree::AABBCast(const AABBCastInput& input, std::function<float(const AA
     while (stack.Count() > 0)
     {
         NodeProxy current = stack.PopBack();
-        if (current == nullNode)
+        if (current == nullNode || (nodes[current].categoryBits & categoryMask) == 0)
         {
             continue;
         }
@@ -666,10 +816,34 @@ void AABBTree::AABBCast(const AABBCastInput& input, std::function<float(const AA
     }
 }
 
+void AABBTree::QueryPairs(std::function<bool(NodeProxy, Data*, NodeProxy, Data*)> callback, bool movedOnly) const
+{
+    QueryPairs(*this, callback, movedOnly);
+}
+
+void AABBTree::QueryPairs(
+    const AABBTree& other, std::function<bool(NodeProxy, Data*, NodeProxy, Data*)> callback, bool movedOnly
+) const
+{
+    struct FunctionCallback
+    {
+        std::function<bool(NodeProxy, Data*, NodeProxy, Data*)>& callback;
+
+        bool PairCallback(NodeProxy nodeA, Data* dataA, NodeProxy nodeB, Data* dataB)
+        {
+            return callback(nodeA, dataA, nodeB, dataB);
+        }
+    } functionCallback{ callback };
+
+    QueryPairs(other, &functionCallback, movedOnly);
+}
+
 void AABBTree::Reset()
 {
     root = nullNode;
     nodeCount = 0;
+    ++revision;
+    refitQuality = 0.0f;
     memset(nodes, 0, nodeCapacity * sizeof(Node));
 
     // Build a linked list for the free list.
@@ -716,7 +890,9 @@ NodeProxy AABBTree::AllocateNode()
     nodes[node].child1 = nullNode;
     nodes[node].child2 = nullNode;
     nodes[node].moved = false;
+    nodes[node].categoryBits = 0;
     ++nodeCount;
+    ++revision;
 
     return node;
 }
@@ -731,16 +907,13 @@ void AABBTree::FreeNode(NodeProxy node)
     freeList = node;
 
     --nodeCount;
+    ++revision;
 }
 
-void AABBTree::Rebuild()
+int32 AABBTree::CollectLeaves(NodeProxy* leaves)
 {
-    // Rebuild tree with bottom up approach
-
-    NodeProxy* leaves = (NodeProxy*)muli::Alloc(nodeCount * sizeof(NodeProxy));
     int32 count = 0;
 
-    // Collect all leaves
     for (int32 i = 0; i < nodeCapacity; ++i)
     {
         // Already in the free list
@@ -763,58 +936,632 @@ void AABBTree::Rebuild()
         }
     }
 
-    while (count > 1)
+    root = nullNode;
+
+    return count;
+}
+
+void AABBTree::Rebuild()
+{
+    // Rebuild tree top down with binned surface area heuristic(SAH)
+    // O(n log n) for n leaves, the leaves are split along the axis and bin boundary with the lowest SAH cost
+
+    NodeProxy* leaves = (NodeProxy*)muli::Alloc(nodeCount * sizeof(NodeProxy));
+    int32 count = CollectLeaves(leaves);
+
+    if (count != 0)
+    {
+        Build(leaves, count, nullNode, true);
+    }
+
+    muli::Free(leaves);
+}
+
+void AABBTree::RebuildLinear()
+{
+    NodeProxy* leaves = (NodeProxy*)muli::Alloc(nodeCount * sizeof(NodeProxy));
+    int32 count = CollectLeaves(leaves);
+
+    if (count != 0)
     {
-        float minCost = max_value;
-        int32 minI = -1;
-        int32 minJ = -1;
+        BuildLinear(leaves, count);
+    }
 
-        // Find the best aabb pair
-        for (int32 i = 0; i < count; ++i)
+    muli::Free(leaves);
+}
+
+// AABB::Union() goes through fminf and fmaxf, which are library calls unless fast math is enabled
+// The build unions every leaf on every level, so it compares directly
+static inline AABB UnionBounds(const AABB& a, const AABB& b)
+{
+    return AABB{ Vec2{ a.min.x < b.min.x ? a.min.x : b.min.x, a.min.y < b.min.y ? a.min.y : b.min.y },
+                 Vec2{ a.max.x > b.max.x ? a.max.x : b.max.x, a.max.y > b.max.y ? a.max.y : b.max.y } };
+}
+
+void AABBTree::Build(NodeProxy* leaves, int32 count, NodeProxy parent, bool isChild1)
+{
+    constexpr int32 bin_count = 16;
+
+    // Leaves are copied into a flat array once, so the build passes don't touch the node array
+    struct BuildLeaf
+    {
+        AABB aabb;
+        Vec2 center;
+        NodeProxy node;
+        uint32 categoryBits;
+        bool moved;
+    };
+
+    // Bounds of a group of leaves and of their centers
+    struct Bounds
+    {
+        AABB aabb;
+        AABB centerBounds;
+        uint32 categoryBits;
+        bool moved;
+
+        void Add(const BuildLeaf& leaf)
+        {
+            aabb = UnionBounds(aabb, leaf.aabb);
+            centerBounds = UnionBounds(centerBounds, AABB{ leaf.center, leaf.center });
+            categoryBits |= leaf.categoryBits;
+            moved = moved || leaf.moved;
+        }
+
+        void Add(const Bounds& other)
+        {
+            aabb = UnionBounds(aabb, other.aabb);
+            centerBounds = UnionBounds(centerBounds, other.centerBounds);
+            categoryBits |= other.categoryBits;
+            moved = moved || other.moved;
+        }
+    };
+
+    struct Bin
+    {
+        Bounds bounds;
+        int32 count;
+    };
+
+    // Range of leaves to be built under the parent node
+    struct Range
+    {
+        int32 begin;
+        int32 end;
+        Bounds bounds;
+        NodeProxy parent;
+        bool isChild1;
+    };
+
+    auto computeBounds = [](const BuildLeaf* first, const BuildLeaf* last) -> Bounds {
+        Bounds bounds{ first->aabb, AABB{ first->center, first->center }, first->categoryBits, first->moved };
+        for (const BuildLeaf* leaf = first + 1; leaf < last; ++leaf)
         {
-            AABB aabbI = nodes[leaves[i]].aabb;
+            bounds.Add(*leaf);
+        }
+        return bounds;
+    };
 
-            for (int32 j = i + 1; j < count; ++j)
+    BuildLeaf* buildLeaves = (BuildLeaf*)muli::Alloc(count * sizeof(BuildLeaf));
+    for (int32 i = 0; i < count; ++i)
+    {
+        const Node& leaf = nodes[leaves[i]];
+        buildLeaves[i] = BuildLeaf{ leaf.aabb, leaf.aabb.GetCenter(), leaves[i], leaf.categoryBits, leaf.moved };
+    }
+
+    GrowableArray<Range, 256> stack;
+    stack.EmplaceBack(0, count, computeBounds(buildLeaves, buildLeaves + count), parent, isChild1);
+
+    while (stack.Count() != 0)
+    {
+        Range range = stack.PopBack();
+
+        NodeProxy node;
+
+        if (range.end - range.begin == 1)
+        {
+            node = buildLeaves[range.begin].node;
+        }
+        else
+        {
+            const AABB& centerBounds = range.bounds.centerBounds;
+            int32 binCount = Min(bin_count, range.end - range.begin);
+
+            // Bin the leaves along both axes in a single pass
+            Vec2 extent = centerBounds.max - centerBounds.min;
+            Vec2 binScale{ extent.x > epsilon ? binCount / extent.x : 0.0f, extent.y > epsilon ? binCount / extent.y : 0.0f };
+
+            Bin bins[2][bin_count];
+            for (int32 axis = 0; axis < 2; ++axis)
             {
-                AABB aabbJ = nodes[leaves[j]].aabb;
+                for (int32 i = 0; i < binCount; ++i)
+                {
+                    bins[axis][i].count = 0;
+                }
+            }
 
-                AABB combined = AABB::Union(aabbI, aabbJ);
-                float cost = SurfaceArea(combined);
+            for (int32 i = range.begin; i < range.end; ++i)
+            {
+                const BuildLeaf& leaf = buildLeaves[i];
 
-                if (cost < minCost)
+                for (int32 axis = 0; axis < 2; ++axis)
                 {
-                    minCost = cost;
-                    minI = i;
-                    minJ = j;
+                    int32 b = Min(int32((leaf.center[axis] - centerBounds.min[axis]) * binScale[axis]), binCount - 1);
+
+                    Bin& bin = bins[axis][b];
+                    if (bin.count++ == 0)
+                    {
+                        bin.bounds = Bounds{ leaf.aabb, AABB{ leaf.center, leaf.center }, leaf.categoryBits, leaf.moved };
+                    }
+                    else
+                    {
+                        bin.bounds.Add(leaf);
+                    }
                 }
             }
+
+            float bestCost = max_value;
+            int32 bestAxis = -1;
+            int32 bestSplit = 0;
+
+            for (int32 axis = 0; axis < 2; ++axis)
+            {
+                if (binScale[axis] == 0.0f)
+                {
+                    continue;
+                }
+
+                // Sweep from the right to get the cost of the right side of each split
+                float rightCosts[bin_count];
+                AABB rightAABB;
+                int32 rightCount = 0;
+
+                for (int32 i = binCount - 1; i > 0; --i)
+                {
+                    const Bin& bin = bins[axis][i];
+                    if (bin.count != 0)
+                    {
+                        rightAABB = rightCount == 0 ? bin.bounds.aabb : UnionBounds(rightAABB, bin.bounds.aabb);
+                        rightCount += bin.count;
+                    }
+
+                    rightCosts[i] = rightCount == 0 ? max_value : SurfaceArea(rightAABB) * rightCount;
+                }
+
+                // Sweep from the left, splitting between bin i - 1 and i
+                AABB leftAABB;
+                int32 leftCount = 0;
+
+                for (int32 i = 1; i < binCount; ++i)
+                {
+                    const Bin& bin = bins[axis][i - 1];
+                    if (bin.count != 0)
+                    {
+                        leftAABB = leftCount == 0 ? bin.bounds.aabb : UnionBounds(leftAABB, bin.bounds.aabb);
+                        leftCount += bin.count;
+                    }
+
+                    if (leftCount == 0 || rightCosts[i] == max_value)
+                    {
+                        continue;
+                    }
+
+                    float cost = SurfaceArea(leftAABB) * leftCount + rightCosts[i];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            int32 mid;
+            Bounds left, right;
+
+            if (bestAxis != -1)
+            {
+                float min = centerBounds.min[bestAxis];
+                float scale = binScale[bestAxis];
+
+                BuildLeaf* split =
+                    std::partition(buildLeaves + range.begin, buildLeaves + range.end, [&](const BuildLeaf& leaf) -> bool {
+                        return Min(int32((leaf.center[bestAxis] - min) * scale), binCount - 1) < bestSplit;
+                    });
+
+                mid = int32(split - buildLeaves);
+
+                // The bounds of both sides are the unions of their bins
+                const Bin* axisBins = bins[bestAxis];
+                int32 i = 0;
+                while (axisBins[i].count == 0) ++i;
+                left = axisBins[i].bounds;
+                for (++i; i < bestSplit; ++i)
+                {
+                    if (axisBins[i].count != 0) left.Add(axisBins[i].bounds);
+                }
+                while (axisBins[i].count == 0) ++i;
+                right = axisBins[i].bounds;
+                for (++i; i < binCount; ++i)
+                {
+                    if (axisBins[i].count != 0) right.Add(axisBins[i].bounds);
+                }
+            }
+            else
+            {
+                // All centers are at the same point, split in half
+                mid = range.begin + (range.end - range.begin) / 2;
+                left = computeBounds(buildLeaves + range.begin, buildLeaves + mid);
+                right = computeBounds(buildLeaves + mid, buildLeaves + range.end);
+            }
+
+            // Create a parent(internal) node
+            node = AllocateNode();
+            nodes[node].aabb = range.bounds.aabb;
+            nodes[node].moved = range.bounds.moved;
+            nodes[node].categoryBits = range.bounds.categoryBits;
+            nodes[node].data = nullptr;
+
+            stack.EmplaceBack(range.begin, mid, left, node, true);
+            stack.EmplaceBack(mid, range.end, right, node, false);
+        }
+
+        nodes[node].parent = range.parent;
+
+        if (range.parent == nullNode)
+        {
+            root = node;
+        }
+        else if (range.isChild1)
+        {
+            nodes[range.parent].child1 = node;
+        }
+        else
+        {
+            nodes[range.parent].child2 = node;
+        }
+    }
+
+    muli::Free(buildLeaves);
+}
+
+// Interleave the lower 16 bits of x and y
+static inline uint32 MortonCode(uint32 x, uint32 y)
+{
+    auto spread = [](uint32 v) -> uint32 {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+
+    return spread(x) | (spread(y) << 1);
+}
+
+void AABBTree::BuildLinear(NodeProxy* leaves, int32 count)
+{
+    struct MortonLeaf
+    {
+        uint32 code;
+        NodeProxy node;
+    };
+
+    // Range of sorted leaves to be built under the parent node
+    struct Range
+    {
+        int32 begin;
+        int32 end;
+        NodeProxy parent;
+        bool isChild1;
+    };
+
+    AABB centerBounds{ nodes[leaves[0]].aabb.GetCenter(), nodes[leaves[0]].aabb.GetCenter() };
+    for (int32 i = 1; i < count; ++i)
+    {
+        Vec2 center = nodes[leaves[i]].aabb.GetCenter();
+        centerBounds = UnionBounds(centerBounds, AABB{ center, center });
+    }
+
+    // Quantize the leaf centers to a 16 bit grid over their bounds
+    Vec2 extent = centerBounds.max - centerBounds.min;
+    Vec2 scale{ extent.x > epsilon ? 65535.0f / extent.x : 0.0f, extent.y > epsilon ? 65535.0f / extent.y : 0.0f };
+
+    MortonLeaf* sorted = (MortonLeaf*)muli::Alloc(2 * count * sizeof(MortonLeaf));
+    MortonLeaf* buffer = sorted + count;
+
+    for (int32 i = 0; i < count; ++i)
+    {
+        Vec2 p = nodes[leaves[i]].aabb.GetCenter() - centerBounds.min;
+        sorted[i] = MortonLeaf{ MortonCode(uint32(p.x * scale.x), uint32(p.y * scale.y)), leaves[i] };
+    }
+
+    // Radix sort the codes 8 bits at a time
+    for (int32 shift = 0; shift < 32; shift += 8)
+    {
+        int32 offsets[256] = {};
+        for (int32 i = 0; i < count; ++i)
+        {
+            ++offsets[(sorted[i].code >> shift) & 0xff];
+        }
+
+        int32 sum = 0;
+        for (int32 i = 0; i < 256; ++i)
+        {
+            int32 c = offsets[i];
+            offsets[i] = sum;
+            sum += c;
+        }
+
+        for (int32 i = 0; i < count; ++i)
+        {
+            buffer[offsets[(sorted[i].code >> shift) & 0xff]++] = sorted[i];
+        }
+
+        std::swap(sorted, buffer);
+    }
+
+    // Internal nodes in the order of creation, so that the children of a node come after it
+    NodeProxy* internalNodes = (NodeProxy*)muli::Alloc(count * sizeof(NodeProxy));
+    int32 internalCount = 0;
+
+    GrowableArray<Range, 256> stack;
+    stack.EmplaceBack(0, count, nullNode, true);
+
+    while (stack.Count() != 0)
+    {
+        Range range = stack.PopBack();
+
+        NodeProxy node;
+
+        if (range.end - range.begin == 1)
+        {
+            node = sorted[range.begin].node;
+        }
+        else
+        {
+            // Split where the highest differing bit of the codes in the range flips
+            int32 first = range.begin;
+            int32 last = range.end - 1;
+            uint32 firstCode = sorted[first].code;
+            uint32 lastCode = sorted[last].code;
+
+            int32 mid;
+            if (firstCode == lastCode)
+            {
+                mid = first + (range.end - range.begin) / 2;
+            }
+            else
+            {
+                int32 prefix = std::countl_zero(firstCode ^ lastCode);
+
+                // Binary search for the last code sharing more than the common prefix with the first one
+                int32 split = first;
+                int32 step = last - first;
+                do
+                {
+                    step = (step + 1) >> 1;
+                    int32 newSplit = split + step;
+
+                    if (newSplit < last && std::countl_zero(firstCode ^ sorted[newSplit].code) > prefix)
+                    {
+                        split = newSplit;
+                    }
+                } while (step > 1);
+
+                mid = split + 1;
+            }
+
+            // Create a parent(internal) node, the bounds are computed bottom up once the children are built
+            node = AllocateNode();
+            nodes[node].data = nullptr;
+            internalNodes[internalCount++] = node;
+
+            stack.EmplaceBack(range.begin, mid, node, true);
+            stack.EmplaceBack(mid, range.end, node, false);
+        }
+
+        nodes[node].parent = range.parent;
+
+        if (range.parent == nullNode)
+        {
+            root = node;
+        }
+        else if (range.isChild1)
+        {
+            nodes[range.parent].child1 = node;
+        }
+        else
+        {
+            nodes[range.parent].child2 = node;
         }
+    }
+
+    for (int32 i = internalCount - 1; i >= 0; --i)
+    {
+        Node& node = nodes[internalNodes[i]];
+        const Node& child1 = nodes[node.child1];
+        const Node& child2 = nodes[node.child2];
+
+        node.aabb = UnionBounds(child1.aabb, child2.aabb);
+        node.moved = child1.moved || child2.moved;
+        node.categoryBits = child1.categoryBits | child2.categoryBits;
+    }
 
-        NodeProxy index1 = leaves[minI];
-        NodeProxy index2 = leaves[minJ];
-        Node* child1 = nodes + index1;
-        Node* child2 = nodes + index2;
+    muli::Free(internalNodes);
+    muli::Free(sorted < buffer ? sorted : buffer);
+}
+
+void AABBTree::RebuildSubtree(NodeProxy node)
+{
+    MuliAssert(0 <= node && node < nodeCapacity);
+
+    if (nodes[node].IsLeaf())
+    {
+        return;
+    }
 
-        // Create a parent(internal) node
-        NodeProxy parentIndex = AllocateNode();
-        Node* parent = nodes + parentIndex;
+    NodeProxy parent = nodes[node].parent;
+    bool isChild1 = parent == nullNode || nodes[parent].child1 == node;
 
-        parent->child1 = index1;
-        parent->child2 = index2;
-        parent->aabb = AABB::Union(child1->aabb, child2->aabb);
-        parent->parent = nullNode;
+    NodeProxy* leaves = (NodeProxy*)muli::Alloc(nodeCount * sizeof(NodeProxy));
+    int32 count = 0;
 
-        child1->parent = parentIndex;
-        child2->parent = parentIndex;
+    // Collect the leaves and free the internal nodes of the subtree
+    GrowableArray<NodeProxy, 256> stack;
+    stack.EmplaceBack(node);
 
-        leaves[minI] = parentIndex;
+    while (stack.Count() != 0)
+    {
+        NodeProxy current = stack.PopBack();
 
-        leaves[minJ] = leaves[count - 1];
-        --count;
+        if (nodes[current].IsLeaf())
+        {
+            leaves[count++] = current;
+        }
+        else
+        {
+            stack.EmplaceBack(nodes[current].child1);
+            stack.EmplaceBack(nodes[current].child2);
+            FreeNode(current);
+        }
     }
 
-    root = leaves[0];
+    // The new subtree bounds the same leaves, so the ancestors stay as they are
+    Build(leaves, count, parent, isChild1);
+
     muli::Free(leaves);
 }
 
+int32 AABBTree::Refit()
+{
+    if (root == nullNode)
+    {
+        return 0;
+    }
+
+    int32 rebuiltCount = 0;
+
+    // Start from a well built tree, its quality is the reference for the refits
+    if (refitQuality == 0.0f)
+    {
+        Rebuild();
+        rebuiltCount = (nodeCount + 1) / 2;
+    }
+
+    struct SubtreeCost
+    {
+        int32 leafCount;
+        float cost;     // Surface area of the internal nodes
+        float leafCost; // Surface area of the leaves
+    };
+
+    NodeProxy* order = (NodeProxy*)muli::Alloc(nodeCount * sizeof(NodeProxy));
+    SubtreeCost* costs = (SubtreeCost*)muli::Alloc(nodeCapacity * sizeof(SubtreeCost));
+
+    // Parents come before their children
+    int32 count = 0;
+    order[count++] = root;
+    for (int32 i = 0; i < count; ++i)
+    {
+        const Node& node = nodes[order[i]];
+        if (node.IsLeaf() == false)
+        {
+            order[count++] = node.child1;
+            order[count++] = node.child2;
+        }
+    }
+
+    // Refit the children before their parents
+    for (int32 i = count - 1; i >= 0; --i)
+    {
+        NodeProxy current = order[i];
+        Node& node = nodes[current];
+
+        if (node.IsLeaf())
+        {
+            costs[current] = SubtreeCost{ 1, 0.0f, SurfaceArea(node.aabb) };
+            continue;
+        }
+
+        NodeProxy child1 = node.child1;
+        NodeProxy child2 = node.child2;
+
+        node.aabb = AABB::Union(nodes[child1].aabb, nodes[child2].aabb);
+        node.moved = nodes[child1].moved || nodes[child2].moved;
+        node.categoryBits = nodes[child1].categoryBits | nodes[child2].categoryBits;
+
+        costs[current].leafCount = costs[child1].leafCount + costs[child2].leafCount;
+        costs[current].cost = SurfaceArea(node.aabb) + costs[child1].cost + costs[child2].cost;
+        costs[current].leafCost = costs[child1].leafCost + costs[child2].leafCost;
+    }
+
+    ++revision;
+
+    const SubtreeCost& total = costs[root];
+    if (total.leafCost > 0.0f)
+    {
+        float quality = total.cost / total.leafCost;
+        if (rebuiltCount > 0 || quality < refitQuality)
+        {
+            refitQuality = quality;
+        }
+
+        if (quality > refitQuality * (1.0f + refit_full_rebuild_threshold))
+        {
+            Rebuild();
+            rebuiltCount = total.leafCount;
+
+            // Tree cost counts the leaves too
+            refitQuality = (ComputeTreeCost() - total.leafCost) / total.leafCost;
+        }
+        else if (quality > refitQuality * (1.0f + refit_rebuild_threshold))
+        {
+            // Candidates are the largest subtrees within the rebuild budget, the worst relative to their leaves go first
+            struct Candidate
+            {
+                NodeProxy node;
+                float quality;
+            };
+
+            std::vector<Candidate> candidates;
+            for (int32 i = 1; i < count; ++i)
+            {
+                NodeProxy current = order[i];
+                const SubtreeCost& c = costs[current];
+
+                if (nodes[current].IsLeaf() || c.leafCount > refit_rebuild_leaves ||
+                    costs[nodes[current].parent].leafCount <= refit_rebuild_leaves)
+                {
+                    continue;
+                }
+
+                candidates.push_back(Candidate{ current, c.cost / Max(c.leafCost, epsilon) });
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+                return a.quality > b.quality;
+            });
+
+            for (const Candidate& candidate : candidates)
+            {
+                int32 leafCount = costs[candidate.node].leafCount;
+                if (rebuiltCount + leafCount > refit_rebuild_leaves)
+                {
+                    break;
+                }
+
+                RebuildSubtree(candidate.node);
+                rebuiltCount += leafCount;
+            }
+        }
+    }
+
+    muli::Free(costs);
+    muli::Free(order);
+
+    return rebuiltCount;
+}
+
 } // namespace muli
\ No newline at end of file
@@ -8,10 +8,16 @@ namespace muli
 BroadPhase::BroadPhase(World* world, ContactManager* contactManager)
     : world{ world }
     , contactManager{ contactManager }
+    , type{ world->settings.broad_phase }
+    , staleQueryCounts{}
+    , grid{ world->settings.grid_cell_size }
+    , sceneTree{ world->staticScene ? &world->staticScene->tree : nullptr }
+    , sceneWideTree{ world->staticScene ? &world->staticScene->wideTree : nullptr }
+    , stats{}
     , moveCapacity{ 16 }
     , moveCount{ 0 }
 {
-    moveBuffer = (NodeProxy*)muli::Alloc(moveCapacity * sizeof(NodeProxy));
+    moveBuffer = (Collider**)muli::Alloc(moveCapacity * sizeof(Collider*));
 }
 
 BroadPhase::~BroadPhase()
@@ -19,61 +25,393 @@ BroadPhase::~BroadPhase()
     muli::Free(moveBuffer);
 }
 
-void BroadPhase::BufferMove(NodeProxy node)
+void BroadPhase::BufferMove(Collider* collider)
 {
+    // A proxy is buffered once per step, its pairs are searched with the latest aabb anyway
+    if (collider->moveIndex != -1)
+    {
+        return;
+    }
+
     // Grow the buffer as needed
     if (moveCount == moveCapacity)
     {
-        NodeProxy* old = moveBuffer;
+        Collider** old = moveBuffer;
         moveCapacity *= 2;
-        moveBuffer = (NodeProxy*)muli::Alloc(moveCapacity * sizeof(NodeProxy));
-        memcpy(moveBuffer, old, moveCount * sizeof(NodeProxy));
+        moveBuffer = (Collider**)muli::Alloc(moveCapacity * sizeof(Collider*));
+        memcpy(moveBuffer, old, moveCount * sizeof(Collider*));
         muli::Free(old);
     }
 
-    moveBuffer[moveCount] = node;
+    collider->moveIndex = moveCount;
+    moveBuffer[moveCount] = collider;
     ++moveCount;
 }
 
-void BroadPhase::UnBufferMove(NodeProxy node)
+void BroadPhase::UnBufferMove(Collider* collider)
 {
-    for (int32 i = 0; i < moveCount; ++i)
+    if (collider->moveIndex != -1)
+    {
+        moveBuffer[collider->moveIndex] = nullptr;
+        collider->moveIndex = -1;
+    }
+}
+
+void BroadPhase::Transfer(Collider* collider)
+{
+    TreeType treeType = GetTreeType(collider->body);
+    if (treeType == collider->tree)
+    {
+        return;
+    }
+
+    // The fat aabb and the moved flag are kept, so the transfer alone doesn't trigger a new pair search
+    AABBTree& from = trees[collider->tree];
+    NodeProxy node = collider->node;
+
+    collider->node = trees[treeType].InsertNode(collider, from.GetAABB(node), from.WasMoved(node), from.GetCategoryBits(node));
+    collider->tree = uint8(treeType);
+
+    from.RemoveNode(node);
+}
+
+// Minimum number of moved proxies handed to a worker at once
+static constexpr int32 min_pair_task_range = 32;
+
+// Queries saved on the wide copy of a tree pay for building it over about this many nodes
+static constexpr int32 wide_tree_build_cost = 8;
+
+// The trees are descended together once one in this many active proxies moved,
+// fewer moved proxies are found faster by a query each
+static constexpr int32 dense_move_ratio = 4;
+
+// Pairs of subtrees are split until there are this many regardless of the worker count,
+// so the pairs are found in the same order with any number of workers
+static constexpr int32 subtree_pair_count = 64;
+
+// Descends both subtrees of each pair together, so the upper levels are visited once instead of once per moved proxy
+void BroadPhase::TreePairsTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    BroadPhase* broadPhase = (BroadPhase*)taskContext;
+
+    PairQuery query;
+    query.broadPhase = broadPhase;
+    query.pairBuffer = &broadPhase->pairBuffers[workerIndex];
+
+    for (int32 i = begin; i < end; ++i)
+    {
+        const SubtreePair& pair = broadPhase->subtreePairs[i];
+        query.taskIndex = i;
+
+        // This will callback our PairQuery::PairCallback(NodeProxy, Collider*, NodeProxy, Collider*)
+        pair.treeA->SearchPairs(pair.nodeA, *pair.treeB, pair.nodeB, &query, true);
+    }
+}
+
+void BroadPhase::FindPairsTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    BroadPhase* broadPhase = (BroadPhase*)taskContext;
+
+    PairQuery query;
+    query.broadPhase = broadPhase;
+    query.pairBuffer = &broadPhase->pairBuffers[workerIndex];
+    const WideAABBTree* sceneWideTree = broadPhase->sceneWideTree;
+
+    for (int32 i = begin; i < end; ++i)
     {
-        if (moveBuffer[i] == node)
+        Collider* collider = broadPhase->moveBuffer[i];
+        if (collider == nullptr)
         {
-            moveBuffer[i] = AABBTree::nullNode;
+            continue;
+        }
+
+        query.taskIndex = i;
+        query.treeA = TreeType(collider->tree);
+        query.nodeA = collider->node;
+        query.colliderA = collider;
+        query.bodyA = collider->body;
+        query.typeA = collider->GetType();
+        query.sceneQuery = false;
+
+        const AABB* fatAABB;
+        bool isStatic;
+
+        if (broadPhase->type == WorldSettings::uniform_grid)
+        {
+            fatAABB = &broadPhase->grid.GetAABB(query.nodeA);
+            isStatic = query.bodyA->GetType() == RigidBody::Type::static_body;
+
+            // This will callback our PairQuery::PairCallback(int32, Collider*, Collider*)
+            broadPhase->grid.FindPairs(query.nodeA, i, &query);
+        }
+        else
+        {
+            fatAABB = &broadPhase->trees[query.treeA].GetAABB(query.nodeA);
+
+            // Static bodies never collide with each other, so static proxies skip the static tree and the scene
+            isStatic = query.treeA == static_tree;
+
+            // This will callback our PairQuery::QueryCallback(NodeProxy, Collider*)
+            for (int32 t = isStatic ? sleeping_tree : static_tree; t < tree_count; ++t)
+            {
+                broadPhase->QueryTree(t, *fatAABB, &query);
+            }
+        }
+
+        if (sceneWideTree && isStatic == false)
+        {
+            query.sceneQuery = true;
+            sceneWideTree->Query(*fatAABB, &query);
         }
     }
 }
 
-void BroadPhase::FindNewContacts()
+// Sweeps the sorted proxies, then queries the scene for the moved proxies
+// Tasks are indexed by the entries followed by the move buffer, so the pairs can be ordered by the task index
+void BroadPhase::SweepPairsTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
 {
-    for (int32 i = 0; i < moveCount; ++i)
+    BroadPhase* broadPhase = (BroadPhase*)taskContext;
+    const SweepAndPrune& sap = broadPhase->sap;
+
+    PairQuery query;
+    query.broadPhase = broadPhase;
+    query.pairBuffer = &broadPhase->pairBuffers[workerIndex];
+    query.sceneQuery = false;
+
+    int32 entryCount = sap.GetEntryCount();
+
+    // This will callback our PairQuery::PairCallback(int32, Collider*, Collider*)
+    sap.FindPairs(begin, Min(end, entryCount), &query);
+
+    const WideAABBTree* sceneWideTree = broadPhase->sceneWideTree;
+    if (sceneWideTree == nullptr)
     {
-        nodeA = moveBuffer[i];
-        if (nodeA == AABBTree::nullNode)
+        return;
+    }
+
+    query.sceneQuery = true;
+    for (int32 i = Max(begin, entryCount); i < end; ++i)
+    {
+        Collider* collider = broadPhase->moveBuffer[i - entryCount];
+        if (collider == nullptr || collider->body->GetType() == RigidBody::Type::static_body)
         {
             continue;
         }
 
-        colliderA = tree.GetData(nodeA);
-        bodyA = colliderA->body;
-        typeA = colliderA->GetType();
+        query.taskIndex = i;
+        query.nodeA = collider->node;
+        query.colliderA = collider;
+        query.bodyA = collider->body;
+        query.typeA = collider->GetType();
 
-        const AABB& treeAABB = tree.GetAABB(colliderA->node);
+        sceneWideTree->Query(sap.GetAABB(collider->node), &query);
+    }
+}
 
-        // This will callback our BroadPhase::QueryCallback(NodeProxy, Collider*)
-        tree.Query(treeAABB, this);
+void BroadPhase::AddSubtreePair(const AABBTree* treeA, NodeProxy nodeA, const AABBTree* treeB, NodeProxy nodeB)
+{
+    if (nodeA == AABBTree::nullNode || nodeB == AABBTree::nullNode)
+    {
+        return;
+    }
+
+    const AABBTree::Node& a = treeA->nodes[nodeA];
+    const AABBTree::Node& b = treeB->nodes[nodeB];
+
+    // The pairs of two proxies that didn't move are already known
+    if (a.moved == false && b.moved == false)
+    {
+        return;
     }
 
+    if (treeA == treeB && nodeA == nodeB)
+    {
+        if (a.IsLeaf())
+        {
+            return;
+        }
+    }
+    else if (a.aabb.TestOverlap(b.aabb) == false)
+    {
+        return;
+    }
+
+    subtreePairs.push_back(SubtreePair{ treeA, treeB, nodeA, nodeB });
+}
+
+void BroadPhase::SplitSubtreePairs()
+{
+    // Split all pairs one level at a time, the same way AABBTree::SearchPairs() descends them
+    while (int32(subtreePairs.size()) < subtree_pair_count)
+    {
+        subtreePairs.swap(splitPairs);
+        subtreePairs.clear();
+
+        bool split = false;
+
+        for (const SubtreePair& pair : splitPairs)
+        {
+            const AABBTree::Node& a = pair.treeA->nodes[pair.nodeA];
+            const AABBTree::Node& b = pair.treeB->nodes[pair.nodeB];
+
+            if (pair.treeA == pair.treeB && pair.nodeA == pair.nodeB)
+            {
+                AddSubtreePair(pair.treeA, a.child1, pair.treeB, a.child1);
+                AddSubtreePair(pair.treeA, a.child2, pair.treeB, a.child2);
+                AddSubtreePair(pair.treeA, a.child1, pair.treeB, a.child2);
+            }
+            else if (a.IsLeaf() && b.IsLeaf())
+            {
+                subtreePairs.push_back(pair);
+                continue;
+            }
+            else if (AABBTree::DescendFirst(a, b, true))
+            {
+                AddSubtreePair(pair.treeA, a.child1, pair.treeB, pair.nodeB);
+                AddSubtreePair(pair.treeA, a.child2, pair.treeB, pair.nodeB);
+            }
+            else
+            {
+                AddSubtreePair(pair.treeA, pair.nodeA, pair.treeB, b.child1);
+                AddSubtreePair(pair.treeA, pair.nodeA, pair.treeB, b.child2);
+            }
+
+            split = true;
+        }
+
+        if (split == false)
+        {
+            break;
+        }
+    }
+}
+
+void BroadPhase::RefreshWideTrees()
+{
+    for (int32 i = 0; i < tree_count; ++i)
+    {
+        if (wideTrees[i].IsCurrent(trees[i]))
+        {
+            continue;
+        }
+
+        // Build the wide copy once the queries run on the stale tree would have paid for it,
+        // so the rarely modified trees get it at once and a busy active tree only when it's read a lot
+        staleQueryCounts[i] += moveCount;
+        if (staleQueryCounts[i] * wide_tree_build_cost >= trees[i].GetNodeCount())
+        {
+            wideTrees[i].Build(trees[i]);
+            staleQueryCounts[i] = 0;
+        }
+    }
+}
+
+void BroadPhase::FindNewContacts()
+{
+    // Tighten the active tree grown by the moved proxies
+    if (type == WorldSettings::refit_tree && moveCount > 0)
+    {
+        stats.rebuiltLeaves += trees[active_tree].Refit();
+    }
+
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        // The sweep visits all proxies, so skip it when nothing moved, e.g. between the TOI events
+        if (moveCount > 0)
+        {
+            sap.Sort();
+
+            int32 taskCount = sap.GetEntryCount() + (sceneTree ? moveCount : 0);
+            world->RunTask(SweepPairsTask, taskCount, min_pair_task_range, this);
+        }
+    }
+    else if ((type == WorldSettings::dynamic_tree || type == WorldSettings::refit_tree) && moveCount > 0 &&
+             moveCount * dense_move_ratio >= (trees[active_tree].GetNodeCount() + 1) / 2)
+    {
+        const AABBTree* staticTree = &trees[static_tree];
+        const AABBTree* sleepingTree = &trees[sleeping_tree];
+        const AABBTree* activeTree = &trees[active_tree];
+
+        // Static proxies never collide with each other or the scene
+        subtreePairs.clear();
+        AddSubtreePair(activeTree, activeTree->root, activeTree, activeTree->root);
+        AddSubtreePair(activeTree, activeTree->root, sleepingTree, sleepingTree->root);
+        AddSubtreePair(activeTree, activeTree->root, staticTree, staticTree->root);
+        AddSubtreePair(sleepingTree, sleepingTree->root, sleepingTree, sleepingTree->root);
+        AddSubtreePair(sleepingTree, sleepingTree->root, staticTree, staticTree->root);
+
+        if (sceneTree)
+        {
+            AddSubtreePair(activeTree, activeTree->root, sceneTree, sceneTree->root);
+            AddSubtreePair(sleepingTree, sleepingTree->root, sceneTree, sceneTree->root);
+        }
+
+        SplitSubtreePairs();
+
+        // Descend the pairs of subtrees holding a moved proxy in parallel
+        world->RunTask(TreePairsTask, int32(subtreePairs.size()), 1, this);
+    }
+    else
+    {
+        if (type == WorldSettings::uniform_grid)
+        {
+            grid.Rebuild();
+        }
+        else
+        {
+            RefreshWideTrees();
+        }
+
+        // Query the trees or the grid for each moved proxy in parallel
+        world->RunTask(FindPairsTask, moveCount, min_pair_task_range, this);
+    }
+
+    // Each query is appended to a single buffer in one piece, so a stable sort by the task index
+    // restores the order in which a serial search would find the pairs
+    int32 workerCount = world->workerCount;
+    std::vector<ProxyPair>& pairs = pairBuffers[0];
+    for (int32 i = 1; i < workerCount; ++i)
+    {
+        pairs.insert(pairs.end(), pairBuffers[i].begin(), pairBuffers[i].end());
+        pairBuffers[i].clear();
+    }
+
+    if (workerCount > 1)
+    {
+        std::stable_sort(
+            pairs.begin(), pairs.end(), [](const ProxyPair& a, const ProxyPair& b) { return a.taskIndex < b.taskIndex; }
+        );
+    }
+
+    // Duplicate pairs are rejected here, because the contact is already created
+    for (const ProxyPair& pair : pairs)
+    {
+        contactManager->OnNewContact(pair.colliderA, pair.colliderB);
+    }
+    pairs.clear();
+
     // Clear move buffer for next step
     for (int32 i = 0; i < moveCount; ++i)
     {
-        NodeProxy node = moveBuffer[i];
-        if (node != AABBTree::nullNode)
+        Collider* collider = moveBuffer[i];
+        if (collider == nullptr)
+        {
+            continue;
+        }
+
+        if (type == WorldSettings::sweep_and_prune)
+        {
+            sap.ClearMoved(collider->node);
+        }
+        else if (type == WorldSettings::uniform_grid)
+        {
+            grid.ClearMoved(collider->node);
+        }
+        else
         {
-            tree.ClearMoved(node);
+            trees[collider->tree].ClearMoved(collider->node);
         }
+        collider->moveIndex = -1;
     }
 
     moveCount = 0;
@@ -81,71 +419,274 @@ void BroadPhase::FindNewContacts()
 
 void BroadPhase::Add(Collider* collider, const AABB& aabb)
 {
-    NodeProxy node = tree.CreateNode(collider, aabb);
-    collider->node = node;
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        collider->node = sap.CreateProxy(collider, aabb, collider->filter.bit);
+        BufferMove(collider);
+        return;
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        collider->node = grid.CreateProxy(collider, aabb);
+        BufferMove(collider);
+        return;
+    }
 
-    BufferMove(node);
+    TreeType treeType = GetTreeType(collider->body);
+
+    collider->node = trees[treeType].CreateNode(collider, aabb, collider->filter.bit);
+    collider->tree = uint8(treeType);
+
+    BufferMove(collider);
 }
 
 void BroadPhase::Remove(Collider* collider)
 {
-    NodeProxy node = collider->node;
-    tree.RemoveNode(node);
+    // Already removed, e.g. by disabling the body or by a bulk removal
+    if (collider->node == AABBTree::nullNode)
+    {
+        return;
+    }
+
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        sap.RemoveProxy(collider->node);
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        grid.RemoveProxy(collider->node);
+    }
+    else
+    {
+        trees[collider->tree].RemoveNode(collider->node);
+    }
+    collider->node = AABBTree::nullNode;
+
+    UnBufferMove(collider);
+}
+
+void BroadPhase::Remove(std::span<Collider*> colliders)
+{
+    std::vector<NodeProxy> nodes[tree_count];
+
+    for (Collider* collider : colliders)
+    {
+        if (collider->node == AABBTree::nullNode)
+        {
+            continue;
+        }
+
+        // Removal from the sweep and prune and the grid is constant time anyway
+        if (type == WorldSettings::sweep_and_prune)
+        {
+            sap.RemoveProxy(collider->node);
+        }
+        else if (type == WorldSettings::uniform_grid)
+        {
+            grid.RemoveProxy(collider->node);
+        }
+        else
+        {
+            nodes[collider->tree].push_back(collider->node);
+        }
+        collider->node = AABBTree::nullNode;
+
+        UnBufferMove(collider);
+    }
+
+    for (int32 i = 0; i < tree_count; ++i)
+    {
+        if (nodes[i].size() > 0)
+        {
+            trees[i].RemoveNodes(nodes[i]);
+        }
+    }
+}
+
+bool BroadPhase::ComputeMargin(Collider* collider, const AABB& aabb, Vec2* displacement, Vec2* margin)
+{
+    Vec2 d = *displacement;
+
+    float deviation = Length(d - collider->motion);
+    collider->motion += (d - collider->motion) * aabb_motion_smoothing;
+    collider->jitter += (deviation - collider->jitter) * aabb_motion_smoothing;
+
+    // The aabb is swept over the displacement, take it out to get the size of the proxy
+    Vec2 extents = aabb.max - aabb.min - 2.0f * Abs(d);
+    float size = Min(extents.x, extents.y);
+
+    // Predict slow steady motion further ahead, as far as the size of the proxy allows
+    float travel = Length(collider->motion);
+    float steps = aabb_max_prediction_steps;
+    if (travel * aabb_max_prediction_steps > size * aabb_max_prediction)
+    {
+        steps = Max(size * aabb_max_prediction / travel, aabb_multiplier);
+    }
+
+    // Moving nodes predict aabb_multiplier steps of the displacement
+    *displacement = d * (steps / aabb_multiplier);
+    // Slow and resting proxies keep the constant margin, only fast erratic motion widens it
+    *margin = aabb_margin;
+    if (travel > aabb_margin.x)
+    {
+        *margin = Vec2{ Clamp(collider->jitter * aabb_jitter_margin, aabb_margin.x, Max(size * aabb_max_margin, aabb_margin.x)) };
+    }
+
+    // Shrink the fat aabb once the proxy slowed down
+    AABB fitted = aabb;
+    fitted.min -= *margin + Max(-d * steps, Vec2::zero);
+    fitted.max += *margin + Max(d * steps, Vec2::zero);
 
-    UnBufferMove(node);
+    return GetFatAABB(collider).GetPerimeter() > 2.0f * fitted.GetPerimeter();
 }
 
 void BroadPhase::Update(Collider* collider, const AABB& aabb, const Vec2& displacement)
 {
     NodeProxy node = collider->node;
-    bool rested = collider->body->resting > world->settings.sleeping_time;
+    // Rested bodies shrink their fat aabbs before falling asleep
+    bool forceMove = collider->body->resting > world->settings.sleeping_time;
+
+    Vec2 prediction = displacement;
+    Vec2 margin = aabb_margin;
+    if (world->settings.adaptive_aabb_margin && ComputeMargin(collider, aabb, &prediction, &margin))
+    {
+        forceMove = true;
+    }
+
+    bool nodeMoved;
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        nodeMoved = sap.MoveProxy(node, aabb, prediction, forceMove, margin);
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        nodeMoved = grid.MoveProxy(node, aabb, prediction, forceMove, margin);
+    }
+    else
+    {
+        // The body may have fallen asleep or woken up since the last update
+        Transfer(collider);
+        node = collider->node;
+
+        if (type == WorldSettings::refit_tree && collider->tree == active_tree)
+        {
+            nodeMoved = trees[active_tree].RefitNode(node, aabb, prediction, forceMove, margin);
+        }
+        else
+        {
+            nodeMoved = trees[collider->tree].MoveNode(node, aabb, prediction, forceMove, margin);
+        }
+    }
 
-    bool nodeMoved = tree.MoveNode(node, aabb, displacement, rested);
     if (nodeMoved)
     {
-        BufferMove(node);
+        ++stats.reinsertions;
+        BufferMove(collider);
     }
 }
 
 void BroadPhase::Refresh(Collider* collider)
 {
-    NodeProxy node = collider->node;
     AABB aabb = collider->GetAABB();
 
-    tree.MoveNode(node, aabb, Vec2::zero, true);
-    BufferMove(node);
+    if (type == WorldSettings::sweep_and_prune)
+    {
+        sap.MoveProxy(collider->node, aabb, Vec2::zero, true);
+    }
+    else if (type == WorldSettings::uniform_grid)
+    {
+        grid.MoveProxy(collider->node, aabb, Vec2::zero, true);
+    }
+    else
+    {
+        Transfer(collider);
+        trees[collider->tree].MoveNode(collider->node, aabb, Vec2::zero, true);
+    }
+
+    BufferMove(collider);
 }
 
-bool BroadPhase::QueryCallback(NodeProxy nodeB, Collider* colliderB)
+void BroadPhase::UpdateCategory(Collider* collider)
 {
-    if (nodeA == nodeB)
+    // The uniform grid reads the filter of the proxy while querying
+    if (type == WorldSettings::dynamic_tree || type == WorldSettings::refit_tree)
     {
-        return true;
+        trees[collider->tree].SetCategoryBits(collider->node, collider->filter.bit);
     }
+    else if (type == WorldSettings::sweep_and_prune)
+    {
+        sap.SetCategoryBits(collider->node, collider->filter.bit);
+    }
+}
 
-    RigidBody* bodyB = colliderB->body;
-    if (bodyA == bodyB)
+bool BroadPhase::PairQuery::QueryCallback(NodeProxy nodeB, Collider* colliderB)
+{
+    // Scene proxies live in another tree and never move, so they can't be found twice
+    if (sceneQuery == false)
     {
-        return true;
+        TreeType treeB = TreeType(colliderB->tree);
+
+        if (treeA == treeB && nodeA == nodeB)
+        {
+            return true;
+        }
+
+        if (bodyA == colliderB->body)
+        {
+            return true;
+        }
+
+        // Avoid duplicate contact, the pair of two moved proxies is reported by the proxy ordered last
+        if (broadPhase->trees[treeB].WasMoved(nodeB) && (treeA < treeB || (treeA == treeB && nodeA < nodeB)))
+        {
+            return true;
+        }
     }
 
-    // Avoid duplicate contact
-    if (tree.WasMoved(nodeB) && nodeA < nodeB)
+    AddPair(colliderB);
+    return true;
+}
+
+void BroadPhase::PairQuery::PairCallback(int32 entry, Collider* inColliderA, Collider* colliderB)
+{
+    if (inColliderA->body == colliderB->body)
     {
-        return true;
+        return;
     }
 
+    taskIndex = entry;
+    colliderA = inColliderA;
+    typeA = inColliderA->GetType();
+
+    AddPair(colliderB);
+}
+
+bool BroadPhase::PairQuery::PairCallback(NodeProxy nodeA, Collider* inColliderA, NodeProxy nodeB, Collider* colliderB)
+{
+    MuliNotUsed(nodeA);
+    MuliNotUsed(nodeB);
+
+    PairCallback(taskIndex, inColliderA, colliderB);
+    return true;
+}
+
+void BroadPhase::PairQuery::AddPair(Collider* colliderB)
+{
+    Collider* first = colliderA;
+    Collider* second = colliderB;
+
     Shape::Type typeB = colliderB->GetType();
     if (typeA <= typeB)
     {
-        contactManager->OnNewContact(colliderB, colliderA);
+        first = colliderB;
+        second = colliderA;
     }
-    else
+
+    // Filter out the existing contacts early to keep the pair buffers small
+    if (broadPhase->contactManager->ShouldCollide(first, second))
     {
-        contactManager->OnNewContact(colliderA, colliderB);
+        pairBuffer->push_back(ProxyPair{ taskIndex, first, second });
     }
-
-    return true;
 }
 
-} // namespace muli
\ No newline at end of file
+} // namespace muli
@@ -1,8 +1,8 @@
 #include "muli/collision.h"
 #include "muli/capsule.h"
 #include "muli/circle.h"
+#include "muli/gjk.h"
 #include "muli/polygon.h"
-#include "muli/polytope.h"
 #include "muli/rigidbody.h"
 #include "muli/shape.h"
 
@@ -11,110 +11,14 @@ namespace muli
 
 static constexpr Vec2 origin = Vec2::zero;
 
-static bool detection_function_initialized = false;
-CollideFunction* collide_function_map[Shape::Type::shape_count][Shape::Type::shape_count];
-void InitializeDetectionFunctionMap();
-
-/*
- * Returns support point in 'Minkowski Difference' set
- * Minkowski Sum: A ⊕ B = {Pa + Pb| Pa ∈ A, Pb ∈ B}
- * Minkowski Difference : A ⊖ B = {Pa - Pb| Pa ∈ A, Pb ∈ B}
- * CSO stands for Configuration Space Object
- *
- * 'dir' should be normalized
- */
-inline SupportPoint CSOSupport(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, const Vec2& dir)
+bool GJK(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, GJKResult* result, SimplexCache* cache)
 {
-    SupportPoint supportPoint;
-    supportPoint.pointA.id = a->GetSupport(MulT(tfA.rotation, dir));
-    supportPoint.pointB.id = b->GetSupport(MulT(tfB.rotation, -dir));
-    supportPoint.pointA.p = Mul(tfA, a->GetVertex(supportPoint.pointA.id));
-    supportPoint.pointB.p = Mul(tfB, b->GetVertex(supportPoint.pointB.id));
-    supportPoint.point = supportPoint.pointA.p - supportPoint.pointB.p;
-
-    return supportPoint;
-}
-
-bool GJK(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, GJKResult* result)
-{
-    Simplex simplex;
-
-    // Random initial search direction
-    Vec2 direction = tfB.position - tfA.position;
-    SupportPoint support = CSOSupport(a, tfA, b, tfB, direction);
-    simplex.AddVertex(support);
-
-    Vec2 save[max_simplex_vertex_count];
-    int32 saveCount;
-
-    for (int32 k = 0; k < gjk_max_iteration; ++k)
-    {
-        simplex.Save(save, &saveCount);
-        simplex.Advance(origin);
-
-        if (simplex.count == 3)
-        {
-            break;
-        }
-
-        direction = simplex.GetSearchDirection();
-
-        // Simplex contains origin
-        if (Dot(direction, direction) == 0.0f)
-        {
-            break;
-        }
-
-        support = CSOSupport(a, tfA, b, tfB, direction);
-
-        // Check duplicate vertices
-        for (int32 i = 0; i < saveCount; ++i)
-        {
-            if (save[i] == support.point)
-            {
-                goto end;
-            }
-        }
-
-        simplex.AddVertex(support);
-    }
-
-end:
-    Vec2 closest = simplex.GetClosestPoint();
-    float distance = Length(closest);
-
-    result->simplex = simplex;
-    result->direction = Normalize(direction);
-    result->distance = distance;
-
-    return distance < gjk_tolerance;
+    return DispatchShapes(a, b, [&](auto* shapeA, auto* shapeB) { return GJK(shapeA, tfA, shapeB, tfB, result, cache); });
 }
 
 void EPA(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, const Simplex& simplex, EPAResult* result)
 {
-    Polytope polytope{ simplex };
-    PolytopeEdge edge{ 0, max_value, Vec2::zero };
-
-    for (int32 k = 0; k < epa_max_iteration; ++k)
-    {
-        edge = polytope.GetClosestEdge();
-        Vec2 supportPoint = CSOSupport(a, tfA, b, tfB, edge.normal).point;
-        float newDistance = Dot(edge.normal, supportPoint);
-
-        if (Abs(edge.distance - newDistance) > epa_tolerance)
-        {
-            // Insert the support vertex so that it expands our polytope
-            polytope.vertices.Insert(edge.index + 1, supportPoint);
-        }
-        else
-        {
-            // We finally reached the closest outer edge!
-            break;
-        }
-    }
-
-    result->contactNormal = edge.normal;
-    result->penetrationDepth = edge.distance;
+    DispatchShapes(a, b, [&](auto* shapeA, auto* shapeB) { EPA(shapeA, tfA, shapeB, tfB, simplex, result); });
 }
 
 static void ClipEdge(Edge* e, const Vec2& p, const Vec2& dir, bool removeClippedPoint)
@@ -151,25 +55,21 @@ static void ClipEdge(Edge* e, const Vec2& p, const Vec2& dir, bool removeClipped
     }
 }
 
-static void FindContactPoints(
-    const Vec2& n, const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold
+// Clip the incident edge against the reference edge, n is pointing from shape a to shape b
+// Returns false if the incident edge doesn't reach the reference face between its side planes
+static bool ClipContactPoints(
+    const Vec2& n, Edge edgeA, Edge edgeB, float ra, float rb, bool featureFlipped, ContactManifold* manifold
 )
 {
-    Edge edgeA = a->GetFeaturedEdge(tfA, n);
-    Edge edgeB = b->GetFeaturedEdge(tfB, -n);
-
-    edgeA.Translate(n * a->GetRadius());
-    edgeB.Translate(-n * b->GetRadius());
+    edgeA.Translate(n * ra);
+    edgeB.Translate(-n * rb);
 
     Edge* ref = &edgeA; // Reference edge
     Edge* inc = &edgeB; // Incident edge
     manifold->contactNormal = n;
     manifold->featureFlipped = false;
 
-    float aPerpendicularness = Abs(Dot(edgeA.tangent, n));
-    float bPerpendicularness = Abs(Dot(edgeB.tangent, n));
-
-    if (bPerpendicularness < aPerpendicularness)
+    if (featureFlipped)
     {
         ref = &edgeB;
         inc = &edgeA;
@@ -177,8 +77,17 @@ static void FindContactPoints(
         manifold->featureFlipped = true;
     }
 
+    float length = Dot(ref->p2.p - ref->p1.p, ref->tangent);
+    float u1 = Dot(inc->p1.p - ref->p1.p, ref->tangent);
+    float u2 = Dot(inc->p2.p - ref->p1.p, ref->tangent);
+    bool beside = (u1 < 0.0f && u2 < 0.0f) || (u1 > length && u2 > length);
+
     ClipEdge(inc, ref->p1.p, ref->tangent, false);
     ClipEdge(inc, ref->p2.p, -ref->tangent, false);
+
+    bool touching = beside == false && (Dot(inc->p1.p - ref->p1.p, manifold->contactNormal) <= 0.0f ||
+                                        Dot(inc->p2.p - ref->p1.p, manifold->contactNormal) <= 0.0f);
+
     ClipEdge(inc, ref->p1.p, -manifold->contactNormal, true);
 
     // To ensure consistent warm starting, the contact point id is always set based on Shape A
@@ -199,6 +108,21 @@ static void FindContactPoints(
     }
 
     manifold->referencePoint = ref->p1;
+
+    return touching;
+}
+
+static void FindContactPoints(
+    const Vec2& n, const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold
+)
+{
+    Edge edgeA = a->GetFeaturedEdge(tfA, n);
+    Edge edgeB = b->GetFeaturedEdge(tfB, -n);
+
+    float aPerpendicularness = Abs(Dot(edgeA.tangent, n));
+    float bPerpendicularness = Abs(Dot(edgeB.tangent, n));
+
+    ClipContactPoints(n, edgeA, edgeB, a->GetRadius(), b->GetRadius(), bPerpendicularness < aPerpendicularness, manifold);
 }
 
 bool CircleVsCircle(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
@@ -303,6 +227,97 @@ bool CapsuleVsCircle(const Shape* a, const Transform& tfA, const Shape* b, const
     return true;
 }
 
+bool CapsuleVsCapsule(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
+{
+    const Capsule* ca = (const Capsule*)a;
+    const Capsule* cb = (const Capsule*)b;
+    if (ca->GetLength() == 0.0f || cb->GetLength() == 0.0f)
+    {
+        return ConvexVsConvex(a, tfA, b, tfB, manifold);
+    }
+
+    Vec2 a1 = Mul(tfA, ca->GetVertexA());
+    Vec2 a2 = Mul(tfA, ca->GetVertexB());
+    Vec2 b1 = Mul(tfB, cb->GetVertexA());
+    Vec2 b2 = Mul(tfB, cb->GetVertexB());
+
+    Vec2 d1 = a2 - a1;
+    Vec2 d2 = b2 - b1;
+    Vec2 r = a1 - b1;
+
+    float l1 = Dot(d1, d1);
+    float l2 = Dot(d2, d2);
+    float e = Dot(d1, d2);
+    float f = Dot(d1, r);
+    float g = Dot(d2, r);
+
+    // Closest points of the segments a1 + s * d1 and b1 + t * d2
+    float denominator = l1 * l2 - e * e;
+    float s = denominator > 0.0f ? Clamp((e * g - f * l2) / denominator, 0.0f, 1.0f) : 0.0f;
+    float t = (e * s + g) / l2;
+
+    if (t < 0.0f)
+    {
+        t = 0.0f;
+        s = Clamp(-f / l1, 0.0f, 1.0f);
+    }
+    else if (t > 1.0f)
+    {
+        t = 1.0f;
+        s = Clamp((e - f) / l1, 0.0f, 1.0f);
+    }
+
+    Vec2 pa = a1 + s * d1;
+    Vec2 pb = b1 + t * d2;
+
+    float ra = a->GetRadius();
+    float rb = b->GetRadius();
+    float radii = ra + rb;
+
+    Vec2 normal = pb - pa;
+    float distance2 = Length2(normal);
+    if (distance2 >= radii * radii)
+    {
+        return false;
+    }
+
+    // The segments cross each other, find the penetration with EPA
+    if (distance2 < epsilon * epsilon)
+    {
+        return ConvexVsConvex(a, tfA, b, tfB, manifold);
+    }
+
+    float distance = normal.Normalize();
+    manifold->penetrationDepth = radii - distance;
+
+    if ((s == 0.0f || s == 1.0f) && (t == 0.0f || t == 1.0f))
+    {
+        // vertex vs. vertex collision
+        manifold->contactNormal = normal;
+        manifold->contactTangent.Set(-normal.y, normal.x);
+        manifold->contactPoints[0].id = t == 0.0f ? 0 : 1;
+        manifold->contactPoints[0].p = pb - normal * rb;
+        manifold->referencePoint.id = s == 0.0f ? 0 : 1;
+        manifold->referencePoint.p = pa + normal * ra;
+        manifold->contactCount = 1;
+        manifold->featureFlipped = false;
+
+        return true;
+    }
+
+    // vertex vs. edge or parallel edges, the more perpendicular edge becomes the reference edge
+    Edge edgeA{ a1, a2, 0, 1 };
+    Edge edgeB{ b1, b2, 0, 1 };
+
+    float aPerpendicularness = Abs(Dot(edgeA.tangent, normal));
+    float bPerpendicularness = Abs(Dot(edgeB.tangent, normal));
+
+    ClipContactPoints(normal, edgeA, edgeB, ra, rb, bPerpendicularness < aPerpendicularness, manifold);
+    manifold->contactTangent.Set(-manifold->contactNormal.y, manifold->contactNormal.x);
+
+    return true;
+}
+
 bool PolygonVsCircle(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
 {
     const Polygon* p = (const Polygon*)a;
@@ -404,8 +419,8 @@ bool PolygonVsCircle(const Shape* a, const Transform& tfA, const Shape* b, const
     return true;
 }
 
-// This works for all possible shape pairs
-bool ConvexVsConvex(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
+template <typename A, typename B>
+static bool ConvexVsConvex(const A* a, const Transform& tfA, const B* b, const Transform& tfB, ContactManifold* manifold)
 {
     GJKResult gjkResult;
     bool collide = GJK(a, tfA, b, tfB, &gjkResult);
@@ -511,17 +526,263 @@ bool ConvexVsConvex(const Shape* a, const Transform& tfA, const Shape* b, const
     return true;
 }
 
-bool Collide(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
+// This works for all possible shape pairs
+bool ConvexVsConvex(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
+{
+    return DispatchShapes(a, b, [&](auto* shapeA, auto* shapeB) { return ConvexVsConvex(shapeA, tfA, shapeB, tfB, manifold); });
+}
+
+// Core of a polygon or a capsule for the separating axis test, a capsule is a two sided polygon of two vertices
+struct ConvexCore
+{
+    const Vec2* vertices;
+    const Vec2* normals;
+    int32 count;
+    float radius;
+
+    // Rectangles are also described by their center and half extents along the first two normals
+    bool box;
+    Vec2 center;
+    Vec2 extents;
+};
+
+static ConvexCore GetConvexCore(const Polygon* p)
 {
-    if (detection_function_initialized == false)
+    ConvexCore core;
+    core.vertices = p->GetVertices();
+    core.normals = p->GetNormals();
+    core.count = p->GetVertexCount();
+    core.radius = p->GetRadius();
+
+    const Vec2* n = core.normals;
+    core.box = core.count == 4 && Abs(Dot(n[0], n[1])) < 1e-5f && Abs(Dot(n[0], n[2]) + 1.0f) < 1e-5f &&
+               Abs(Dot(n[1], n[3]) + 1.0f) < 1e-5f;
+
+    if (core.box)
+    {
+        core.center = (core.vertices[0] + core.vertices[2]) * 0.5f;
+        core.extents.x = Dot(n[0], core.vertices[0] - core.center);
+        core.extents.y = Dot(n[1], core.vertices[1] - core.center);
+    }
+
+    return core;
+}
+
+// Transform from the frame of b to the frame of a
+// Returns the maximum separation of the faces of core a from core b, tf transforms from the frame of a to the frame of b
+static float FindMaxSeparation(const ConvexCore& a, const ConvexCore& b, const Transform& tf, int32* edgeIndex)
+{
+    int32 bestIndex = 0;
+    float maxSeparation = -max_value;
+
+    for (int32 i = 0; i < a.count; ++i)
+    {
+        Vec2 n = Mul(tf.rotation, a.normals[i]);
+        Vec2 v = Mul(tf, a.vertices[i]);
+
+        float separation;
+        if (b.box)
+        {
+            // The deepest vertex of a box along -n is found from its extents
+            separation = Dot(n, b.center - v) - Abs(Dot(n, b.normals[0])) * b.extents.x - Abs(Dot(n, b.normals[1])) * b.extents.y;
+        }
+        else
+        {
+            separation = max_value;
+            for (int32 j = 0; j < b.count; ++j)
+            {
+                separation = Min(separation, Dot(n, b.vertices[j] - v));
+            }
+        }
+
+        if (separation > maxSeparation)
+        {
+            maxSeparation = separation;
+            bestIndex = i;
+        }
+    }
+
+    *edgeIndex = bestIndex;
+    return maxSeparation;
+}
+
+// Returns the face of the core most anti-parallel to the local normal
+static int32 FindIncidentEdge(const ConvexCore& core, const Vec2& localNormal)
+{
+    int32 index = 0;
+    float minDot = max_value;
+
+    for (int32 i = 0; i < core.count; ++i)
+    {
+        float dot = Dot(localNormal, core.normals[i]);
+        if (dot < minDot)
+        {
+            minDot = dot;
+            index = i;
+        }
+    }
+
+    return index;
+}
+
+// Edge of the core in world space, ordered like Shape::GetFeaturedEdge so that the contact ids stay the same
+static Edge GetCoreEdge(const ConvexCore& core, const Transform& tf, int32 index)
+{
+    int32 i1 = index;
+    int32 i2 = index + 1 < core.count ? index + 1 : 0;
+
+    if (core.count == 2)
+    {
+        i1 = 0;
+        i2 = 1;
+    }
+
+    return Edge{ Mul(tf, core.vertices[i1]), Mul(tf, core.vertices[i2]), i1, i2 };
+}
+
+// Reference face clipping with the faces found by the separating axis test
+static bool CollideCores(
+    const ConvexCore& a, const Transform& tfA, const ConvexCore& b, const Transform& tfB, ContactManifold* manifold
+)
+{
+    float radii = a.radius + b.radius;
+
+    int32 faceA;
+    float separationA = FindMaxSeparation(a, b, MulT(tfB, tfA), &faceA);
+    if (separationA >= radii)
+    {
+        return false;
+    }
+
+    int32 faceB;
+    float separationB = FindMaxSeparation(b, a, MulT(tfA, tfB), &faceB);
+    if (separationB >= radii)
+    {
+        return false;
+    }
+
+    // Prefer the faces of a, so that the reference face doesn't flip between nearly parallel faces
+    bool featureFlipped = separationB > separationA + 0.1f * linear_slop;
+
+    Vec2 normal; // Pointing from a to b
+    float separation;
+
+    if (featureFlipped)
     {
-        InitializeDetectionFunctionMap();
+        normal = -Mul(tfB.rotation, b.normals[faceB]);
+        separation = separationB;
+        faceA = FindIncidentEdge(a, MulT(tfA.rotation, -normal));
     }
+    else
+    {
+        normal = Mul(tfA.rotation, a.normals[faceA]);
+        separation = separationA;
+        faceB = FindIncidentEdge(b, MulT(tfB.rotation, normal));
+    }
+
+    Edge edgeA = GetCoreEdge(a, tfA, faceA);
+    Edge edgeB = GetCoreEdge(b, tfB, faceB);
+
+    if (ClipContactPoints(normal, edgeA, edgeB, a.radius, b.radius, featureFlipped, manifold) || separation <= 0.0f)
+    {
+        manifold->contactTangent.Set(-manifold->contactNormal.y, manifold->contactNormal.x);
+        manifold->penetrationDepth = radii - separation;
+
+        return true;
+    }
+
+    // Otherwise the separated cores can only touch at the rounded corners of the reference face
+    const Edge& ref = featureFlipped ? edgeB : edgeA;
+    const Edge& inc = featureFlipped ? edgeA : edgeB;
+
+    Vec2 e = inc.p2.p - inc.p1.p;
+    float length2 = Dot(e, e);
+
+    Point refPoint, incPoint;
+    float minDistance2 = max_value;
+
+    for (const Point& corner : { ref.p1, ref.p2 })
+    {
+        float t = length2 > 0.0f ? Clamp(Dot(corner.p - inc.p1.p, e) / length2, 0.0f, 1.0f) : 0.0f;
+        Vec2 p = inc.p1.p + t * e;
+
+        float distance2 = Dist2(corner.p, p);
+        if (distance2 < minDistance2)
+        {
+            minDistance2 = distance2;
+            refPoint = corner;
+            incPoint.p = p;
+            incPoint.id = t < 0.5f ? inc.p1.id : inc.p2.id;
+        }
+    }
+
+    if (minDistance2 >= radii * radii)
+    {
+        return false;
+    }
+
+    Point supportA = featureFlipped ? incPoint : refPoint;
+    Point supportB = featureFlipped ? refPoint : incPoint;
+
+    Vec2 d = supportB.p - supportA.p;
+    float distance = d.Normalize();
+
+    supportA.p += d * a.radius;
+    supportB.p -= d * b.radius;
+
+    manifold->contactNormal = d;
+    manifold->contactTangent.Set(-d.y, d.x);
+    manifold->contactPoints[0] = supportB;
+    manifold->contactCount = 1;
+    manifold->referencePoint = supportA;
+    manifold->penetrationDepth = radii - distance;
+    manifold->featureFlipped = false;
+
+    return true;
+}
+
+bool PolygonVsCapsule(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
+{
+    const Capsule* c = (const Capsule*)b;
+    if (c->GetLength() == 0.0f)
+    {
+        return ConvexVsConvex(a, tfA, b, tfB, manifold);
+    }
+
+    Vec2 n = Normalize(Cross(c->GetVertexB() - c->GetVertexA(), 1.0f));
+    Vec2 vertices[2] = { c->GetVertexA(), c->GetVertexB() };
+    Vec2 normals[2] = { n, -n };
+
+    ConvexCore capsule;
+    capsule.vertices = vertices;
+    capsule.normals = normals;
+    capsule.count = 2;
+    capsule.radius = c->GetRadius();
+    capsule.box = false;
+
+    return CollideCores(GetConvexCore((const Polygon*)a), tfA, capsule, tfB, manifold);
+}
+
+bool PolygonVsPolygon(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
+{
+    return CollideCores(GetConvexCore((const Polygon*)a), tfA, GetConvexCore((const Polygon*)b), tfB, manifold);
+}
+
+// Indexed by the shape types where the first type is greater than or equal to the second
+// Constant initialized, so that it's safe to use from any thread without initialization
+extern CollideFunction* const collide_function_map[Shape::Type::shape_count][Shape::Type::shape_count];
+CollideFunction* const collide_function_map[Shape::Type::shape_count][Shape::Type::shape_count] = {
+    { &CircleVsCircle, nullptr, nullptr },
+    { &CapsuleVsCircle, &CapsuleVsCapsule, nullptr },
+    { &PolygonVsCircle, &PolygonVsCapsule, &PolygonVsPolygon },
+};
 
-    static ContactManifold default_manifold;
+bool Collide(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ContactManifold* manifold)
+{
+    ContactManifold localManifold;
     if (manifold == nullptr)
     {
-        manifold = &default_manifold;
+        manifold = &localManifold;
     }
 
     Shape::Type shapeA = a->GetType();
@@ -544,23 +805,4 @@ bool Collide(const Shape* a, const Transform& tfA, const Shape* b, const Transfo
     }
 }
 
-void InitializeDetectionFunctionMap()
-{
-    if (detection_function_initialized)
-    {
-        return;
-    }
-
-    collide_function_map[Shape::Type::circle][Shape::Type::circle] = &CircleVsCircle;
-
-    collide_function_map[Shape::Type::capsule][Shape::Type::circle] = &CapsuleVsCircle;
-    collide_function_map[Shape::Type::capsule][Shape::Type::capsule] = &ConvexVsConvex;
-
-    collide_function_map[Shape::Type::polygon][Shape::Type::circle] = &PolygonVsCircle;
-    collide_function_map[Shape::Type::polygon][Shape::Type::capsule] = &ConvexVsConvex;
-    collide_function_map[Shape::Type::polygon][Shape::Type::polygon] = &ConvexVsConvex;
-
-    detection_function_initialized = true;
-}
-
 } // namespace muli
@@ -3,34 +3,23 @@
 namespace muli
 {
 
-float GetClosestFeatures(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ClosestFeatures* features)
+float GetClosestFeatures(
+    const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, ClosestFeatures* features, SimplexCache* cache
+)
 {
-    GJKResult gjkResult;
-
-    bool collide = GJK(a, tfA, b, tfB, &gjkResult);
-    if (collide == true)
-    {
-        return 0.0f;
-    }
-
-    Simplex& simplex = gjkResult.simplex;
-    MuliAssert(simplex.count < max_simplex_vertex_count);
-
-    features->count = simplex.count;
-    for (int32 i = 0; i < features->count; ++i)
-    {
-        features->featuresA[i] = simplex.vertices[i].pointA;
-        features->featuresB[i] = simplex.vertices[i].pointB;
-    }
-
-    return gjkResult.distance;
+    return DispatchShapes(a, b, [&](auto* shapeA, auto* shapeB) {
+        return GetClosestFeatures(shapeA, tfA, shapeB, tfB, features, cache);
+    });
 }
 
-float ComputeDistance(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, Vec2* pointA, Vec2* pointB)
+template <typename A, typename B>
+static float ComputeDistance(
+    const A* a, const Transform& tfA, const B* b, const Transform& tfB, Vec2* pointA, Vec2* pointB, SimplexCache* cache
+)
 {
     GJKResult gjkResult;
 
-    bool collide = GJK(a, tfA, b, tfB, &gjkResult);
+    bool collide = GJK(a, tfA, b, tfB, &gjkResult, cache);
     if (collide == true)
     {
         return 0.0f;
@@ -58,4 +47,13 @@ float ComputeDistance(const Shape* a, const Transform& tfA, const Shape* b, cons
     return gjkResult.distance - radii;
 }
 
+float ComputeDistance(
+    const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, Vec2* pointA, Vec2* pointB, SimplexCache* cache
+)
+{
+    return DispatchShapes(a, b, [&](auto* shapeA, auto* shapeB) {
+        return ComputeDistance(shapeA, tfA, shapeB, tfB, pointA, pointB, cache);
+    });
+}
+
 } // namespace muli
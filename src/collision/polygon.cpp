@@ -224,24 +224,6 @@ Edge Polygon::GetFeaturedEdge(const Transform& transform, const Vec2& dir) const
     }
 }
 
-int32 Polygon::GetSupport(const Vec2& localDir) const
-{
-    int32 index = 0;
-    float maxValue = Dot(localDir, vertices[0]);
-
-    for (int32 i = 1; i < vertexCount; ++i)
-    {
-        float value = Dot(localDir, vertices[i]);
-        if (value > maxValue)
-        {
-            index = i;
-            maxValue = value;
-        }
-    }
-
-    return index;
-}
-
 void Polygon::ComputeMass(float density, MassData* outMassData) const
 {
     outMassData->mass = density * area;
@@ -1,5 +1,6 @@
 #include "muli/raycast.h"
 #include "muli/collision.h"
+#include "muli/gjk.h"
 #include "muli/shape.h"
 
 namespace muli
@@ -305,12 +306,11 @@ bool RayCastCapsule(const Vec2& va, const Vec2& vb, float radius, const RayCastI
     return true;
 }
 
-extern SupportPoint CSOSupport(const Shape* a, const Transform& tfA, const Shape* b, const Transform& tfB, const Vec2& dir);
-
-bool ShapeCast(
-    const Shape* a,
+template <typename A, typename B>
+static bool ShapeCast(
+    const A* a,
     const Transform& tfA,
-    const Shape* b,
+    const B* b,
     const Transform& tfB,
     const Vec2& translationA,
     const Vec2& translationB,
@@ -330,10 +330,10 @@ bool ShapeCast(
     Simplex simplex;
 
     // Get CSO support point in inverse ray direction
-    int32 idA = a->GetSupport(MulT(tfA.rotation, -r));
-    Vec2 pointA = Mul(tfA, a->GetVertex(idA));
-    int32 idB = b->GetSupport(MulT(tfB.rotation, r));
-    Vec2 pointB = Mul(tfB, b->GetVertex(idB));
+    int32 idA = a->A::GetSupport(MulT(tfA.rotation, -r));
+    Vec2 pointA = Mul(tfA, a->A::GetVertex(idA));
+    int32 idB = b->B::GetSupport(MulT(tfB.rotation, r));
+    Vec2 pointB = Mul(tfB, b->B::GetVertex(idB));
     Vec2 v = pointA - pointB;
 
     const float target = Max(default_radius, radii - toi_position_solver_threshold);
@@ -347,10 +347,10 @@ bool ShapeCast(
         MuliAssert(simplex.count < 3);
 
         // Get CSO support point in search direction(-v)
-        idA = a->GetSupport(MulT(tfA.rotation, -v));
-        pointA = Mul(tfA, a->GetVertex(idA));
-        idB = b->GetSupport(MulT(tfB.rotation, v));
-        pointB = Mul(tfB, b->GetVertex(idB));
+        idA = a->A::GetSupport(MulT(tfA.rotation, -v));
+        pointA = Mul(tfA, a->A::GetVertex(idA));
+        idB = b->B::GetSupport(MulT(tfB.rotation, v));
+        pointB = Mul(tfB, b->B::GetVertex(idB));
         Vec2 p = pointA - pointB; // Outer vertex of CSO
 
         // -v is the plane normal at p
@@ -421,4 +421,19 @@ bool ShapeCast(
     return true;
 }
 
+bool ShapeCast(
+    const Shape* a,
+    const Transform& tfA,
+    const Shape* b,
+    const Transform& tfB,
+    const Vec2& translationA,
+    const Vec2& translationB,
+    ShapeCastOutput* output
+)
+{
+    return DispatchShapes(a, b, [&](auto* shapeA, auto* shapeB) {
+        return ShapeCast(shapeA, tfA, shapeB, tfB, translationA, translationB, output);
+    });
+}
+
 } // namespace muli
@@ -0,0 +1,196 @@
+#include "muli/sweep_and_prune.h"
+
+namespace muli
+{
+
+SweepAndPrune::SweepAndPrune()
+    : sortedCount{ 0 }
+    , removedCount{ 0 }
+    , axis{ 0 }
+{
+}
+
+NodeProxy SweepAndPrune::CreateProxy(Data* data, const AABB& aabb, uint32 categoryBits)
+{
+    NodeProxy proxy = queryTree.CreateNode(data, aabb, categoryBits);
+    if (proxy >= int32(entryIndices.size()))
+    {
+        entryIndices.resize(proxy + 1);
+    }
+
+    entryIndices[proxy] = int32(entries.size());
+
+    Entry& e = entries.emplace_back();
+    e.aabb = queryTree.GetAABB(proxy);
+    e.proxy = proxy;
+    e.moved = true;
+
+    return proxy;
+}
+
+bool SweepAndPrune::MoveProxy(NodeProxy proxy, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin)
+{
+    MuliAssert(0 <= proxy && proxy < int32(entryIndices.size()));
+
+    int32 index = entryIndices[proxy];
+    Entry& e = entries[index];
+
+    if (e.aabb.Contains(aabb) && forceMove == false)
+    {
+        return false;
+    }
+
+    // The tree is tightened once per step by Sort()
+    queryTree.RefitNode(proxy, aabb, displacement, true, margin);
+
+    e.aabb = queryTree.GetAABB(proxy);
+    e.moved = true;
+
+    if (index < sortedCount)
+    {
+        Reorder(index);
+    }
+
+    return true;
+}
+
+void SweepAndPrune::RemoveProxy(NodeProxy proxy)
+{
+    MuliAssert(0 <= proxy && proxy < int32(entryIndices.size()));
+
+    // Leave a hole with the same bounds, so the order holds until the next Sort()
+    entries[entryIndices[proxy]].proxy = nullProxy;
+    ++removedCount;
+
+    queryTree.RemoveNode(proxy);
+}
+
+void SweepAndPrune::Reorder(int32 index)
+{
+    // Single insertion sort step within the sorted entries
+    Entry e = entries[index];
+    float lower = e.aabb.min[axis];
+
+    int32 i = index;
+    while (i > 0 && entries[i - 1].aabb.min[axis] > lower)
+    {
+        entries[i] = entries[i - 1];
+        --i;
+    }
+
+    if (i == index)
+    {
+        while (i < sortedCount - 1 && entries[i + 1].aabb.min[axis] < lower)
+        {
+            entries[i] = entries[i + 1];
+            ++i;
+        }
+    }
+
+    entries[i] = e;
+
+    UpdateEntryIndices(Min(i, index), Max(i, index) + 1);
+}
+
+void SweepAndPrune::UpdateEntryIndices(int32 begin, int32 end)
+{
+    for (int32 i = begin; i < end; ++i)
+    {
+        NodeProxy proxy = entries[i].proxy;
+        if (proxy != nullProxy)
+        {
+            entryIndices[proxy] = i;
+        }
+    }
+}
+
+void SweepAndPrune::Sort()
+{
+    queryTree.Refit();
+
+    int32 count = int32(entries.size());
+
+    // Sweep along the axis on which the proxies are spread the most, it separates them best
+    // Switch only when the other axis is clearly better, since it costs a full sort
+    float sum[2] = { 0.0f, 0.0f };
+    float sum2[2] = { 0.0f, 0.0f };
+    int32 liveCount = 0;
+
+    for (int32 i = 0; i < count; ++i)
+    {
+        const Entry& e = entries[i];
+        if (e.proxy == nullProxy)
+        {
+            continue;
+        }
+
+        Vec2 c = e.aabb.GetCenter();
+        sum[0] += c.x;
+        sum[1] += c.y;
+        sum2[0] += c.x * c.x;
+        sum2[1] += c.y * c.y;
+        ++liveCount;
+    }
+
+    int32 newAxis = axis;
+    if (liveCount > 0)
+    {
+        float variance[2];
+        for (int32 i = 0; i < 2; ++i)
+        {
+            float mean = sum[i] / liveCount;
+            variance[i] = sum2[i] / liveCount - mean * mean;
+        }
+
+        if (variance[1 - axis] > 2.0f * variance[axis])
+        {
+            newAxis = 1 - axis;
+        }
+    }
+
+    if (newAxis == axis && sortedCount == count && removedCount == 0)
+    {
+        return;
+    }
+
+    // Drop the removed entries, keeping the order
+    int32 liveSortedCount = 0;
+    int32 n = 0;
+    for (int32 i = 0; i < count; ++i)
+    {
+        if (entries[i].proxy == nullProxy)
+        {
+            continue;
+        }
+
+        entries[n++] = entries[i];
+
+        if (i < sortedCount)
+        {
+            liveSortedCount = n;
+        }
+    }
+    entries.resize(n);
+
+    int32 sortAxis = newAxis;
+    auto less = [sortAxis](const Entry& a, const Entry& b) -> bool { return a.aabb.min[sortAxis] < b.aabb.min[sortAxis]; };
+
+    if (newAxis != axis)
+    {
+        axis = newAxis;
+        std::sort(entries.begin(), entries.end(), less);
+    }
+    else
+    {
+        // Sort the new entries and merge them into the sorted ones
+        std::sort(entries.begin() + liveSortedCount, entries.end(), less);
+        std::inplace_merge(entries.begin(), entries.begin() + liveSortedCount, entries.end(), less);
+    }
+
+    sortedCount = n;
+    removedCount = 0;
+
+    UpdateEntryIndices(0, n);
+}
+
+} // namespace muli
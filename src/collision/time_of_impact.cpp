@@ -4,6 +4,7 @@
 namespace muli
 {
 
+template <typename A, typename B>
 struct SeparationFunction
 {
     enum Type
@@ -15,9 +16,9 @@ struct SeparationFunction
 
     void Initialize(
         const ClosestFeatures& closestFeatures,
-        const Shape* inShapeA,
+        const A* inShapeA,
         const Sweep& inSweepA,
-        const Shape* inShapeB,
+        const B* inShapeB,
         const Sweep& inSweepB,
         float t1
     )
@@ -42,6 +43,7 @@ struct SeparationFunction
         {
             // Point A vs. Point B
             type = points;
+            localPoint.SetZero();
 
             // Separating axis in world space
             axis = featuresB[0].p - featuresA[0].p;
@@ -52,8 +54,8 @@ struct SeparationFunction
             // Point A vs. Edge B
             type = edgeB;
 
-            Vec2 localPointB0 = shapeB->GetVertex(featuresB[0].id);
-            Vec2 localPointB1 = shapeB->GetVertex(featuresB[1].id);
+            Vec2 localPointB0 = shapeB->B::GetVertex(featuresB[0].id);
+            Vec2 localPointB1 = shapeB->B::GetVertex(featuresB[1].id);
 
             localPoint = (localPointB0 + localPointB1) * 0.5f;
 
@@ -77,8 +79,8 @@ struct SeparationFunction
             // Edge A vs. Point B
             type = edgeA;
 
-            Vec2 localPointA0 = shapeA->GetVertex(featuresA[0].id);
-            Vec2 localPointA1 = shapeA->GetVertex(featuresA[1].id);
+            Vec2 localPointA0 = shapeA->A::GetVertex(featuresA[0].id);
+            Vec2 localPointA1 = shapeA->A::GetVertex(featuresA[1].id);
 
             localPoint = (localPointA0 + localPointA1) * 0.5f;
 
@@ -113,11 +115,11 @@ struct SeparationFunction
             Vec2 localAxisA = MulT(tfA.rotation, axis);
             Vec2 localAxisB = MulT(tfB.rotation, -axis);
 
-            *idA = shapeA->GetSupport(localAxisA);
-            *idB = shapeB->GetSupport(localAxisB);
+            *idA = shapeA->A::GetSupport(localAxisA);
+            *idB = shapeB->B::GetSupport(localAxisB);
 
-            Vec2 localPointA = shapeA->GetVertex(*idA);
-            Vec2 localPointB = shapeB->GetVertex(*idB);
+            Vec2 localPointA = shapeA->A::GetVertex(*idA);
+            Vec2 localPointB = shapeB->B::GetVertex(*idB);
 
             Vec2 pointA = Mul(tfA, localPointA);
             Vec2 pointB = Mul(tfB, localPointB);
@@ -134,9 +136,9 @@ struct SeparationFunction
             Vec2 localAxisB = MulT(tfB.rotation, -normal);
 
             *idA = -1;
-            *idB = shapeB->GetSupport(localAxisB);
+            *idB = shapeB->B::GetSupport(localAxisB);
 
-            Vec2 localPointB = shapeB->GetVertex(*idB);
+            Vec2 localPointB = shapeB->B::GetVertex(*idB);
             Vec2 pointB = Mul(tfB, localPointB);
 
             float separation = Dot(normal, pointB - pointA);
@@ -150,10 +152,10 @@ struct SeparationFunction
 
             Vec2 localAxisA = MulT(tfA.rotation, -normal);
 
-            *idA = shapeA->GetSupport(localAxisA);
+            *idA = shapeA->A::GetSupport(localAxisA);
             *idB = -1;
 
-            Vec2 localPointA = shapeA->GetVertex(*idA);
+            Vec2 localPointA = shapeA->A::GetVertex(*idA);
             Vec2 pointA = Mul(tfA, localPointA);
 
             float separation = Dot(normal, pointA - pointB);
@@ -175,8 +177,8 @@ struct SeparationFunction
         {
         case points:
         {
-            Vec2 localPointA = shapeA->GetVertex(idA);
-            Vec2 localPointB = shapeB->GetVertex(idB);
+            Vec2 localPointA = shapeA->A::GetVertex(idA);
+            Vec2 localPointB = shapeB->B::GetVertex(idB);
 
             Vec2 pointA = Mul(tfA, localPointA);
             Vec2 pointB = Mul(tfB, localPointB);
@@ -190,7 +192,7 @@ struct SeparationFunction
 
             Vec2 pointA = Mul(tfA, localPoint);
 
-            Vec2 localPointB = shapeB->GetVertex(idB);
+            Vec2 localPointB = shapeB->B::GetVertex(idB);
             Vec2 pointB = Mul(tfB, localPointB);
 
             float separation = Dot(normal, pointB - pointA);
@@ -202,7 +204,7 @@ struct SeparationFunction
 
             Vec2 pointB = Mul(tfB, localPoint);
 
-            Vec2 localPointA = shapeA->GetVertex(idA);
+            Vec2 localPointA = shapeA->A::GetVertex(idA);
             Vec2 pointA = Mul(tfA, localPointA);
 
             float separation = Dot(normal, pointA - pointB);
@@ -214,8 +216,8 @@ struct SeparationFunction
         }
     }
 
-    const Shape* shapeA;
-    const Shape* shapeB;
+    const A* shapeA;
+    const B* shapeB;
     Sweep sweepA;
     Sweep sweepB;
     Type type;
@@ -225,10 +227,22 @@ struct SeparationFunction
 
 static constexpr int32 max_iterations = 20;
 
-void ComputeTimeOfImpact(const Shape* shapeA, Sweep sweepA, const Shape* shapeB, Sweep sweepB, float tMax, TOIOutput* output)
+template <typename A, typename B>
+static void ComputeTimeOfImpact(
+    const A* shapeA, Sweep sweepA, const B* shapeB, Sweep sweepB, float tMax, TOIOutput* output, SimplexCache* cache
+)
 {
     output->state = TOIOutput::unknown;
     output->t = tMax;
+    output->gjkCalls = 0;
+    output->gjkIterations = 0;
+
+    // The sweeps advance by small steps, so the closest features of each step seed the next one
+    SimplexCache localCache;
+    if (cache == nullptr)
+    {
+        cache = &localCache;
+    }
 
     sweepA.Normalize();
     sweepB.Normalize();
@@ -250,7 +264,7 @@ void ComputeTimeOfImpact(const Shape* shapeA, Sweep sweepA, const Shape* shapeB,
 
     float t1 = 0.0f;
     int32 iteration = 0;
-    const int32 maxVertexPushIterations = Max(shapeA->GetVertexCount(), shapeB->GetVertexCount());
+    const int32 maxVertexPushIterations = Max(shapeA->A::GetVertexCount(), shapeB->B::GetVertexCount());
 
     ClosestFeatures cf;
 
@@ -262,7 +276,9 @@ void ComputeTimeOfImpact(const Shape* shapeA, Sweep sweepA, const Shape* shapeB,
         sweepB.GetTransform(t1, &tfB);
 
         // Get the initial separation and closest features
-        float distance = GetClosestFeatures(shapeA, tfA, shapeB, tfB, &cf);
+        float distance = GetClosestFeatures(shapeA, tfA, shapeB, tfB, &cf, cache);
+        ++output->gjkCalls;
+        output->gjkIterations += cf.iterations;
 
         // Two shapes are overlapped at initial configuration
         if (distance <= 0.0f)
@@ -284,7 +300,7 @@ void ComputeTimeOfImpact(const Shape* shapeA, Sweep sweepA, const Shape* shapeB,
         }
 
         // Initialize the separating axis
-        SeparationFunction fcn;
+        SeparationFunction<A, B> fcn;
         fcn.Initialize(cf, shapeA, sweepA, shapeB, sweepB, t1);
 
         // Compute the time of impact on the separating axis
@@ -418,4 +434,11 @@ void ComputeTimeOfImpact(const Shape* shapeA, Sweep sweepA, const Shape* shapeB,
     }
 }
 
+void ComputeTimeOfImpact(
+    const Shape* shapeA, Sweep sweepA, const Shape* shapeB, Sweep sweepB, float tMax, TOIOutput* output, SimplexCache* cache
+)
+{
+    DispatchShapes(shapeA, shapeB, [&](auto* a, auto* b) { ComputeTimeOfImpact(a, sweepA, b, sweepB, tMax, output, cache); });
+}
+
 } // namespace muli
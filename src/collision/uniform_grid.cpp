@@ -0,0 +1,209 @@
+#include "muli/uniform_grid.h"
+
+namespace muli
+{
+
+UniformGrid::UniformGrid(float cellSize)
+    : cellSize{ cellSize }
+    , invCellSize{ 1.0f / cellSize }
+    , freeList{ nullProxy }
+{
+    MuliAssert(cellSize > 0.0f);
+}
+
+NodeProxy UniformGrid::CreateProxy(Data* data, const AABB& aabb)
+{
+    NodeProxy proxy;
+    if (freeList != nullProxy)
+    {
+        proxy = freeList;
+        freeList = proxies[proxy].node;
+    }
+    else
+    {
+        proxy = int32(proxies.size());
+        proxies.emplace_back().pending = false;
+    }
+
+    Proxy& p = proxies[proxy];
+
+    // Fatten the aabb
+    p.aabb.max = aabb.max + aabb_margin;
+    p.aabb.min = aabb.min - aabb_margin;
+    p.data = data;
+    p.node = AABBTree::nullNode;
+    p.large = false;
+    p.moved = true;
+    p.inTable = false;
+
+    if (IsLarge(p.aabb))
+    {
+        InsertLarge(proxy);
+    }
+    else
+    {
+        SetCell(proxy);
+    }
+
+    return proxy;
+}
+
+bool UniformGrid::MoveProxy(NodeProxy proxy, AABB aabb, const Vec2& displacement, bool forceMove, const Vec2& margin)
+{
+    MuliAssert(0 <= proxy && proxy < int32(proxies.size()));
+
+    Proxy& p = proxies[proxy];
+
+    if (p.aabb.Contains(aabb) && forceMove == false)
+    {
+        return false;
+    }
+
+    aabb.Fatten(displacement * aabb_multiplier, margin);
+
+    if (p.large)
+    {
+        tree.RemoveNode(p.node);
+        p.node = AABBTree::nullNode;
+        p.large = false;
+    }
+
+    p.aabb = aabb;
+    p.moved = true;
+
+    // Fast moving proxies may become large for a while
+    if (IsLarge(aabb))
+    {
+        InsertLarge(proxy);
+    }
+    else
+    {
+        SetCell(proxy);
+    }
+
+    return true;
+}
+
+void UniformGrid::RemoveProxy(NodeProxy proxy)
+{
+    MuliAssert(0 <= proxy && proxy < int32(proxies.size()));
+
+    Proxy& p = proxies[proxy];
+
+    if (p.large)
+    {
+        tree.RemoveNode(p.node);
+    }
+
+    p.data = nullptr;
+    p.large = false;
+    p.inTable = false;
+    p.node = freeList;
+    freeList = proxy;
+}
+
+void UniformGrid::SetCell(NodeProxy proxy)
+{
+    Proxy& p = proxies[proxy];
+
+    int32 x = GetCell(p.aabb.min.x);
+    int32 y = GetCell(p.aabb.min.y);
+
+    if (p.inTable && p.cellX == x && p.cellY == y)
+    {
+        return;
+    }
+
+    p.cellX = x;
+    p.cellY = y;
+    p.inTable = false;
+
+    if (p.pending == false)
+    {
+        p.pending = true;
+        pendingProxies.push_back(proxy);
+    }
+}
+
+void UniformGrid::InsertLarge(NodeProxy proxy)
+{
+    Proxy& p = proxies[proxy];
+
+    p.large = true;
+    p.inTable = false;
+    p.node = tree.InsertNode(p.data, p.aabb, true);
+
+    if (p.node >= int32(nodeProxies.size()))
+    {
+        nodeProxies.resize(p.node + 1);
+    }
+    nodeProxies[p.node] = proxy;
+}
+
+void UniformGrid::Rebuild()
+{
+    if (pendingProxies.size() == 0)
+    {
+        return;
+    }
+
+    int32 count = 0;
+    for (const Proxy& p : proxies)
+    {
+        if (p.data && p.large == false)
+        {
+            ++count;
+        }
+    }
+
+    // Keep the table at most half full, so few cells share a bucket
+    int32 tableSize = 16;
+    while (tableSize < 2 * count)
+    {
+        tableSize *= 2;
+    }
+
+    // Counting sort of the proxies by their bucket
+    cellStart.assign(tableSize + 1, 0);
+    for (const Proxy& p : proxies)
+    {
+        if (p.data && p.large == false)
+        {
+            ++cellStart[GetBucket(p.cellX, p.cellY)];
+        }
+    }
+
+    int32 sum = 0;
+    for (int32 i = 0; i <= tableSize; ++i)
+    {
+        int32 c = cellStart[i];
+        cellStart[i] = sum;
+        sum += c;
+    }
+
+    cellProxies.resize(count);
+    for (int32 i = 0; i < int32(proxies.size()); ++i)
+    {
+        Proxy& p = proxies[i];
+        if (p.data && p.large == false)
+        {
+            cellProxies[cellStart[GetBucket(p.cellX, p.cellY)]++] = i;
+            p.inTable = true;
+        }
+    }
+
+    // The scatter advanced each start to the next one
+    for (int32 i = tableSize; i > 0; --i)
+    {
+        cellStart[i] = cellStart[i - 1];
+    }
+    cellStart[0] = 0;
+
+    for (NodeProxy proxy : pendingProxies)
+    {
+        proxies[proxy].pending = false;
+    }
+    pendingProxies.clear();
+}
+
+} // namespace muli
@@ -0,0 +1,134 @@
+#include "muli/wide_aabb_tree.h"
+
+namespace muli
+{
+
+WideAABBTree::WideAABBTree()
+    : source{ nullptr }
+    , revision{ 0 }
+{
+}
+
+void WideAABBTree::Build(const AABBTree& tree)
+{
+    nodes.clear();
+    leaves.clear();
+
+    source = &tree;
+    revision = tree.GetRevision();
+
+    if (tree.root == AABBTree::nullNode)
+    {
+        return;
+    }
+
+    nodes.reserve(tree.nodeCount / (simd_width - 1) + 1);
+    leaves.reserve(tree.nodeCount / 2 + 1);
+
+    Collapse(tree, tree.root);
+}
+
+void WideAABBTree::Clear()
+{
+    nodes.clear();
+    leaves.clear();
+
+    source = nullptr;
+}
+
+int32 WideAABBTree::Collapse(const AABBTree& tree, NodeProxy node)
+{
+    const AABBTree::Node* treeNodes = tree.nodes;
+
+    // Gather the children by opening the largest internal node until the lanes are full
+    NodeProxy lanes[simd_width];
+    int32 count = 0;
+
+    if (treeNodes[node].IsLeaf())
+    {
+        lanes[count++] = node;
+    }
+    else
+    {
+        lanes[count++] = treeNodes[node].child1;
+        lanes[count++] = treeNodes[node].child2;
+    }
+
+    while (count < simd_width)
+    {
+        int32 best = -1;
+        float bestArea = -1.0f;
+
+        for (int32 i = 0; i < count; ++i)
+        {
+            const AABBTree::Node& n = treeNodes[lanes[i]];
+            if (n.IsLeaf() == false && SurfaceArea(n.aabb) > bestArea)
+            {
+                best = i;
+                bestArea = SurfaceArea(n.aabb);
+            }
+        }
+
+        if (best < 0)
+        {
+            break;
+        }
+
+        NodeProxy open = lanes[best];
+        lanes[best] = treeNodes[open].child1;
+        lanes[count++] = treeNodes[open].child2;
+    }
+
+    int32 index = int32(nodes.size());
+    nodes.emplace_back();
+
+    int32 leafMask = 0;
+    int32 children[simd_width];
+
+    for (int32 i = 0; i < count; ++i)
+    {
+        const AABBTree::Node& n = treeNodes[lanes[i]];
+
+        if (n.IsLeaf())
+        {
+            children[i] = int32(leaves.size());
+            leaves.push_back(Leaf{ lanes[i], n.data });
+            leafMask |= 1 << i;
+        }
+        else
+        {
+            // Nodes may be reallocated here, so the new node is filled afterwards
+            children[i] = Collapse(tree, lanes[i]);
+        }
+    }
+
+    Node& wideNode = nodes[index];
+    wideNode.leafMask = leafMask;
+
+    for (int32 i = 0; i < simd_width; ++i)
+    {
+        if (i < count)
+        {
+            const AABB& aabb = treeNodes[lanes[i]].aabb;
+            wideNode.minX[i] = aabb.min.x;
+            wideNode.minY[i] = aabb.min.y;
+            wideNode.maxX[i] = aabb.max.x;
+            wideNode.maxY[i] = aabb.max.y;
+            wideNode.children[i] = children[i];
+            wideNode.categoryBits[i] = treeNodes[lanes[i]].categoryBits;
+        }
+        else
+        {
+            wideNode.minX[i] = max_value;
+            wideNode.minY[i] = max_value;
+            wideNode.maxX[i] = -max_value;
+            wideNode.maxY[i] = -max_value;
+            wideNode.children[i] = 0;
+            wideNode.categoryBits[i] = 0;
+        }
+    }
+
+    return index;
+}
+
+} // namespace muli
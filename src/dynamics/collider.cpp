@@ -4,6 +4,7 @@
 #include "muli/capsule.h"
 #include "muli/circle.h"
 #include "muli/polygon.h"
+#include "muli/world.h"
 
 namespace muli
 {
@@ -15,6 +16,10 @@ Collider::Collider()
     , ContactListener{ &defaultListener }
     , next{ nullptr }
     , node{ AABBTree::nullNode }
+    , tree{ 0 }
+    , moveIndex{ -1 }
+    , motion{ Vec2::zero }
+    , jitter{ 0.0f }
     , enabled{ true }
 {
 }
@@ -61,4 +66,15 @@ void Collider::Destroy(Allocator* allocator)
     shape = nullptr;
 }
 
+void Collider::SetFilter(const CollisionFilter& newCollisionFilter)
+{
+    filter = newCollisionFilter;
+
+    // The broad phase prunes the queries by the category bits
+    if (body->world && node != AABBTree::nullNode)
+    {
+        body->world->contactManager.broadPhase.UpdateCategory(this);
+    }
+}
+
 } // namespace muli
\ No newline at end of file
@@ -7,10 +7,55 @@ namespace muli
 Constraint::Constraint(RigidBody* bodyA, RigidBody* bodyB)
     : bodyA{ bodyA }
     , bodyB{ bodyB }
+    , indexA{ 0 }
+    , indexB{ 0 }
     , beta{ 0.0f }
     , gamma{ 0.0f }
+    , color{ graph_color_count }
 {
     assert(bodyA->GetWorld() == bodyB->GetWorld());
 }
 
+void Constraint::AddColor()
+{
+    MuliAssert(color == graph_color_count);
+
+    // Static bodies can be shared by the constraints in the same color, the solver gives each constraint end its own copy
+    bool staticA = bodyA->type == RigidBody::Type::static_body;
+    bool staticB = bodyB->type == RigidBody::Type::static_body;
+
+    uint32 usedColors = 0;
+    if (staticA == false) usedColors |= bodyA->colorMask;
+    if (staticB == false) usedColors |= bodyB->colorMask;
+
+    for (int32 i = 0; i < graph_color_count; ++i)
+    {
+        uint32 bit = 1u << i;
+        if (usedColors & bit)
+        {
+            continue;
+        }
+
+        if (staticA == false) bodyA->colorMask |= bit;
+        if (staticB == false) bodyB->colorMask |= bit;
+
+        color = i;
+        return;
+    }
+}
+
+void Constraint::RemoveColor()
+{
+    if (color == graph_color_count)
+    {
+        return;
+    }
+
+    uint32 bit = 1u << color;
+    if (bodyA->type != RigidBody::Type::static_body) bodyA->colorMask &= ~bit;
+    if (bodyB->type != RigidBody::Type::static_body) bodyB->colorMask &= ~bit;
+
+    color = graph_color_count;
+}
+
 } // namespace muli
@@ -1,18 +1,20 @@
 #include "muli/contact.h"
-#include "muli/block_solver.h"
 #include "muli/callbacks.h"
-#include "muli/contact_solver.h"
 #include "muli/settings.h"
 #include "muli/world.h"
 
 namespace muli
 {
 
-bool block_solve = true;
-extern CollideFunction* collide_function_map[Shape::Type::shape_count][Shape::Type::shape_count];
+extern CollideFunction* const collide_function_map[Shape::Type::shape_count][Shape::Type::shape_count];
 
 Contact::Contact(Collider* colliderA, Collider* colliderB)
-    : Constraint(colliderA->body, colliderB->body)
+    : Contact(colliderA, colliderB, colliderA->body, colliderB->body)
+{
+}
+
+Contact::Contact(Collider* colliderA, Collider* colliderB, RigidBody* bodyA, RigidBody* bodyB)
+    : Constraint(bodyA, bodyB)
     , colliderA{ colliderA }
     , colliderB{ colliderB }
     , flag{ 0 }
@@ -33,42 +35,59 @@ Contact::Contact(Collider* colliderA, Collider* colliderB)
 }
 
 void Contact::Update()
+{
+    bool wasTouching = IsTouching();
+
+    UpdateManifold();
+    ReportUpdate(wasTouching);
+}
+
+void Contact::UpdateManifold()
 {
     flag |= flag_enabled;
 
     ContactManifold oldManifold = manifold;
     for (int32 i = 0; i < max_contact_point_count; ++i)
     {
-        normalSolvers[i].impulseSave = normalSolvers[i].impulse;
-        tangentSolvers[i].impulseSave = tangentSolvers[i].impulse;
-        normalSolvers[i].impulse = 0.0f;
-        tangentSolvers[i].impulse = 0.0f;
+        ContactConstraintPoint& cp = constraint.points[i];
+        cp.normalImpulseSave = cp.normalImpulse;
+        cp.tangentImpulseSave = cp.tangentImpulse;
+        cp.normalImpulse = 0.0f;
+        cp.tangentImpulse = 0.0f;
     }
 
-    // clang-format off
-    bool wasTouching = (flag & flag_touching) == flag_touching;
-    bool touching = collideFunction(colliderA->shape, bodyA->transform,
-                                    colliderB->shape, bodyB->transform,
-                                    &manifold);
-    // clang-format on
+    bool reuse = bodyA->world->GetWorldSettings().manifold_reuse;
 
-    if (touching == true)
+    bool touching;
+    if (reuse && ReuseManifold())
     {
-        flag |= flag_touching;
+        flag |= flag_reused;
+        touching = IsTouching();
     }
     else
     {
-        flag &= ~flag_touching;
-    }
+        flag &= ~(flag_reused | flag_cached);
 
-    if (touching == false)
-    {
-        if (wasTouching == true)
+        // clang-format off
+        touching = collideFunction(colliderA->shape, bodyA->transform,
+                                   colliderB->shape, bodyB->transform,
+                                   &manifold);
+        // clang-format on
+
+        // A separated pair may start touching within the tolerance, so only touching manifolds are reused
+        if (reuse && touching)
         {
-            if (colliderA->ContactListener) colliderA->ContactListener->OnContactEnd(colliderA, colliderB, this);
-            if (colliderB->ContactListener) colliderB->ContactListener->OnContactEnd(colliderB, colliderA, this);
+            CacheManifold();
         }
+    }
 
+    if (touching == true)
+    {
+        flag |= flag_touching;
+    }
+    else
+    {
+        flag &= ~flag_touching;
         return;
     }
 
@@ -90,126 +109,572 @@ void Contact::Update()
         {
             if (manifold.contactPoints[n].id == oldManifold.contactPoints[o].id)
             {
-                normalSolvers[n].impulse = normalSolvers[o].impulseSave;
-                tangentSolvers[n].impulse = tangentSolvers[o].impulseSave;
+                constraint.points[n].normalImpulse = constraint.points[o].normalImpulseSave;
+                constraint.points[n].tangentImpulse = constraint.points[o].tangentImpulseSave;
                 break;
             }
         }
     }
 
-    if (touching == true)
+    if (colliderA->IsEnabled() == false || colliderB->IsEnabled() == false)
     {
-        if (wasTouching == false)
-        {
-            if (colliderA->ContactListener) colliderA->ContactListener->OnContactBegin(colliderA, colliderB, this);
-            if (colliderB->ContactListener) colliderB->ContactListener->OnContactBegin(colliderB, colliderA, this);
-        }
-        else
+        flag &= ~flag_enabled;
+    }
+}
+
+bool Contact::ReuseManifold()
+{
+    if ((flag & flag_cached) == 0)
+    {
+        return false;
+    }
+
+    const Transform& tfA = bodyA->transform;
+    const Transform& tfB = bodyB->transform;
+    Transform tf = cache.smallerA ? MulT(tfB, tfA) : MulT(tfA, tfB);
+    const Transform& tf0 = cache.relativeTransform;
+
+    // Rotation since the cached pose, which moves the points of the smaller collider by up to its extent times the angle
+    float c = tf0.rotation.c * tf.rotation.c + tf0.rotation.s * tf.rotation.s;
+    float s = tf0.rotation.c * tf.rotation.s - tf0.rotation.s * tf.rotation.c;
+    if (c <= 0.0f)
+    {
+        return false;
+    }
+
+    float motion = Length(tf.position - tf0.position) + Abs(s) * cache.extent;
+    if (motion > manifold_reuse_tolerance)
+    {
+        return false;
+    }
+
+    const Transform& tf1 = b1->transform;
+    const Transform& tf2 = b2->transform;
+
+    Vec2 normal = Mul(tf1.rotation, cache.localNormal);
+    manifold.contactNormal = normal;
+    manifold.contactTangent.Set(-normal.y, normal.x);
+    manifold.referencePoint.p = Mul(tf1, cache.localReferencePoint);
+
+    for (int32 i = 0; i < manifold.contactCount; ++i)
+    {
+        manifold.contactPoints[i].p = Mul(tf2, cache.localContactPoints[i]);
+    }
+
+    return true;
+}
+
+// Distance from the body origin to the farthest point of the shape
+static float ComputeExtent(const Shape* shape)
+{
+    AABB aabb;
+    shape->ComputeAABB(identity, &aabb);
+
+    return Length(Max(Abs(aabb.min), Abs(aabb.max)));
+}
+
+void Contact::CacheManifold()
+{
+    const Transform& tfA = bodyA->transform;
+    const Transform& tfB = bodyB->transform;
+
+    float extentA = ComputeExtent(colliderA->shape);
+    float extentB = ComputeExtent(colliderB->shape);
+
+    cache.smallerA = extentA < extentB;
+    cache.extent = cache.smallerA ? extentA : extentB;
+    cache.relativeTransform = cache.smallerA ? MulT(tfB, tfA) : MulT(tfA, tfB);
+
+    const Transform& tf1 = manifold.featureFlipped ? tfB : tfA;
+    const Transform& tf2 = manifold.featureFlipped ? tfA : tfB;
+
+    cache.localNormal = MulT(tf1.rotation, manifold.contactNormal);
+    cache.localReferencePoint = MulT(tf1, manifold.referencePoint.p);
+
+    for (int32 i = 0; i < manifold.contactCount; ++i)
+    {
+        cache.localContactPoints[i] = MulT(tf2, manifold.contactPoints[i].p);
+    }
+
+    flag |= flag_cached;
+}
+
+void Contact::ReportUpdate(bool wasTouching)
+{
+    bool touching = IsTouching();
+
+    if (touching == false)
+    {
+        if (wasTouching == true)
         {
-            if (colliderA->ContactListener) colliderA->ContactListener->OnContactTouching(colliderA, colliderB, this);
-            if (colliderB->ContactListener) colliderB->ContactListener->OnContactTouching(colliderB, colliderA, this);
+            RemoveColor();
+
+            if (colliderA->ContactListener) colliderA->ContactListener->OnContactEnd(colliderA, colliderB, this);
+            if (colliderB->ContactListener) colliderB->ContactListener->OnContactEnd(colliderB, colliderA, this);
         }
 
-        if (colliderA->ContactListener) colliderA->ContactListener->OnPreSolve(colliderA, colliderB, this);
-        if (colliderB->ContactListener) colliderB->ContactListener->OnPreSolve(colliderB, colliderA, this);
+        return;
     }
 
+    if (wasTouching == false)
+    {
+        AddColor();
+
+        if (colliderA->ContactListener) colliderA->ContactListener->OnContactBegin(colliderA, colliderB, this);
+        if (colliderB->ContactListener) colliderB->ContactListener->OnContactBegin(colliderB, colliderA, this);
+    }
+    else
+    {
+        if (colliderA->ContactListener) colliderA->ContactListener->OnContactTouching(colliderA, colliderB, this);
+        if (colliderB->ContactListener) colliderB->ContactListener->OnContactTouching(colliderB, colliderA, this);
+    }
+
+    if (colliderA->ContactListener) colliderA->ContactListener->OnPreSolve(colliderA, colliderB, this);
+    if (colliderB->ContactListener) colliderB->ContactListener->OnPreSolve(colliderB, colliderA, this);
+
+    // Listeners may have enabled the contact again
     if (colliderA->IsEnabled() == false || colliderB->IsEnabled() == false)
     {
         flag &= ~flag_enabled;
     }
 }
 
-void Contact::Prepare(const Timestep& step)
+bool Contact::HasListener() const
 {
+    return colliderA->ContactListener != nullptr || colliderB->ContactListener != nullptr;
+}
+
+void Contact::Prepare(const Timestep& step, SolverBodies& bodies)
+{
+    index1 = b1 == bodyA ? indexA : indexB;
+    index2 = b2 == bodyA ? indexA : indexB;
+
+    SolverVelocity& v1 = bodies.velocities[index1];
+    SolverVelocity& v2 = bodies.velocities[index2];
+    const SolverPosition& p1 = bodies.positions[index1];
+    const SolverPosition& p2 = bodies.positions[index2];
+
+    ContactConstraint& cc = constraint;
+    cc.invMass1 = bodies.masses[index1].invMass;
+    cc.invInertia1 = bodies.masses[index1].invInertia;
+    cc.invMass2 = bodies.masses[index2].invMass;
+    cc.invInertia2 = bodies.masses[index2].invInertia;
+
+    const Vec2& normal = manifold.contactNormal;
+    const Vec2& tangent = manifold.contactTangent;
+
+    Transform tf1{ p1.c, p1.a };
+    Transform tf2{ p2.c, p2.a };
+
+    cc.localPlainPoint = MulT(tf1, manifold.referencePoint.p);
+    cc.localNormal = MulT(tf1.rotation, normal);
+
     for (int32 i = 0; i < manifold.contactCount; ++i)
     {
-        normalSolvers[i].Prepare(this, ContactSolver::Type::normal, manifold.contactNormal, i, step);
-        tangentSolvers[i].Prepare(this, ContactSolver::Type::tangent, manifold.contactTangent, i, step);
-        positionSolvers[i].Prepare(this, i);
+        ContactConstraintPoint& cp = cc.points[i];
+
+        // Compute Jacobian J and effective mass M
+        // J = [-dir, -ra × dir, dir, rb × dir] (dir: Contact vector, normal or tangent)
+        // M = (J · M^-1 · J^t)^-1
+
+        Vec2 point = manifold.contactPoints[i].p;
+        Vec2 ra = point - p1.c;
+        Vec2 rb = point - p2.c;
+
+        cp.normalWA = -Cross(ra, normal);
+        cp.normalWB = Cross(rb, normal);
+        cp.tangentWA = -Cross(ra, tangent);
+        cp.tangentWB = Cross(rb, tangent);
+
+        // clang-format off
+        float kNormal = cc.invMass1
+                      + cp.normalWA * cc.invInertia1 * cp.normalWA
+                      + cc.invMass2
+                      + cp.normalWB * cc.invInertia2 * cp.normalWB;
+
+        float kTangent = cc.invMass1
+                       + cp.tangentWA * cc.invInertia1 * cp.tangentWA
+                       + cc.invMass2
+                       + cp.tangentWB * cc.invInertia2 * cp.tangentWB;
+        // clang-format on
+
+        cp.normalMass = kNormal > 0.0f ? 1.0f / kNormal : 0.0f;
+        cp.tangentMass = kTangent > 0.0f ? 1.0f / kTangent : 0.0f;
+
+        // Relative velocity at contact point
+        Vec2 relativeVelocity = (v2.v + Cross(v2.w, rb)) - (v1.v + Cross(v1.w, ra));
+
+        // Normal velocity == veclocity constraint: jv
+        float normalVelocity = Dot(normal, relativeVelocity);
+
+        cp.bias = 0.0f;
+        if (-normalVelocity > restitutionThreshold)
+        {
+            cp.bias = restitution * normalVelocity;
+        }
+
+        cp.localClipPoint = MulT(tf2, point);
+
+        if (step.warm_starting)
+        {
+            // Warm start
+            v1.v += -normal * (cc.invMass1 * cp.normalImpulse);
+            v1.w += cc.invInertia1 * cp.normalWA * cp.normalImpulse;
+            v2.v += normal * (cc.invMass2 * cp.normalImpulse);
+            v2.w += cc.invInertia2 * cp.normalWB * cp.normalImpulse;
+
+            v1.v += -tangent * (cc.invMass1 * cp.tangentImpulse);
+            v1.w += cc.invInertia1 * cp.tangentWA * cp.tangentImpulse;
+            v2.v += tangent * (cc.invMass2 * cp.tangentImpulse);
+            v2.w += cc.invInertia2 * cp.tangentWB * cp.tangentImpulse;
+        }
     }
 
-    if (manifold.contactCount == 2 && block_solve == true)
+    cc.blockSolve = false;
+    if (manifold.contactCount == 2 && step.block_solve == true)
     {
-        blockSolver.Prepare(this);
+        const ContactConstraintPoint& cp1 = cc.points[0];
+        const ContactConstraintPoint& cp2 = cc.points[1];
+
+        // clang-format off
+        // J = [-n, -ra1 × n, n, rb1 × n
+        //      -n, -ra2 × n, n, rb2 × n]
+        cc.k[0][0] = cc.invMass1 + cc.invMass2 + cp1.normalWA * cc.invInertia1 * cp1.normalWA + cp1.normalWB * cc.invInertia2 * cp1.normalWB;
+        cc.k[1][1] = cc.invMass1 + cc.invMass2 + cp2.normalWA * cc.invInertia1 * cp2.normalWA + cp2.normalWB * cc.invInertia2 * cp2.normalWB;
+        cc.k[0][1] = cc.invMass1 + cc.invMass2 + cp1.normalWA * cc.invInertia1 * cp2.normalWA + cp1.normalWB * cc.invInertia2 * cp2.normalWB;
+        cc.k[1][0] = cc.k[0][1];
+        // clang-format on
+
+        if (cc.k.GetDeterminant() != 0.0f)
+        {
+            cc.blockSolve = true;
+            cc.m = cc.k.GetInverse();
+        }
     }
 }
 
-void Contact::SolveVelocityConstraints(const Timestep& step)
+// Solve two normal constraints simultaneously
+// https://www.gdcvault.com/play/1020603/Physics-for-Game-Programmers-Understanding
+static void SolveBlock(ContactConstraint& cc, const Vec2& normal, SolverVelocity& v1, SolverVelocity& v2)
 {
-    MuliNotUsed(step);
+    /*
+        The comments below are copied from Box2D::b2_contact_solver.cpp
+        Check out Box2D: https://box2d.org
 
-    // Solve tangential constraint first
-    for (int32 i = 0; i < manifold.contactCount; ++i)
+        Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
+        Build the mini LCP for this contact patch
+
+        vn = A * x + b, vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+
+        A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
+        b = vn0 - velocityBias
+
+        The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
+        implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
+        vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
+        solution that satisfies the problem is chosen.
+
+        In order to acontactount of the acontactumulated impulse 'a' (because of the iterative nature of the solver which only
+        requires that the acontactumulated impulse is clamped and not the incremental impulse) we change the impulse variable
+        (x_i).
+
+        Substitute:
+
+        x = a + d
+
+        a := old total impulse
+        x := new total impulse
+        d := incremental impulse
+
+        For the current iteration we extend the formula for the incremental impulse
+        to compute the new total impulse:
+
+        vn = A * d + b
+            = A * (x - a) + b
+            = A * x + b - A * a
+            = A * x + b'
+        b' = b - A * a;
+    */
+
+    ContactConstraintPoint& cp1 = cc.points[0];
+    ContactConstraintPoint& cp2 = cc.points[1];
+
+    Vec2 a{ cp1.normalImpulse, cp2.normalImpulse }; // old total impulse
+    MuliAssert(a.x >= 0.0f && a.y >= 0.0f);
+
+    // clang-format off
+    // (Velocity constraint) Normal velocity: Jv = 0
+    float vn1 = Dot(-normal, v1.v)
+              + cp1.normalWA * v1.w
+              + Dot(normal, v2.v)
+              + cp1.normalWB * v2.w;
+
+    float vn2 = Dot(-normal, v1.v)
+              + cp2.normalWA * v1.w
+              + Dot(normal, v2.v)
+              + cp2.normalWB * v2.w;
+    // clang-format on
+
+    Vec2 b{ vn1 + cp1.bias, vn2 + cp2.bias };
+
+    // b' = b - K * a
+    b = b - (cc.k * a);
+    Vec2 x{ 0.0f }; // Lambda;
+
+    //
+    // Case 1: vn = 0
+    // Both constraints are violated
+    //
+    // 0 = A * x + b'
+    //
+    // Solve for x:
+    //
+    // x = - inv(A) * b'
+    //
+    x = -(cc.m * b);
+    if (x.x >= 0.0f && x.y >= 0.0f)
     {
-        tangentSolvers[i].Solve(&normalSolvers[i]);
+        goto solved;
     }
 
-    if (manifold.contactCount == 1 || block_solve == false || blockSolver.enabled == false)
+    //
+    // Case 2: vn1 = 0 and x2 = 0
+    // The first constraint is violated and the second constraint is satisfied
+    //
+    //   0 = a11 * x1 + a12 * 0 + b1'
+    // vn2 = a21 * x1 + a22 * 0 + b2'
+    //
+    x.x = cp1.normalMass * -b.x;
+    x.y = 0.0f;
+    vn1 = 0.0f;
+    vn2 = cc.k[0][1] * x.x + b.y;
+    if (x.x >= 0.0f && vn2 >= 0.0f)
     {
-        for (int32 i = 0; i < manifold.contactCount; ++i)
-        {
-            normalSolvers[i].Solve();
-        }
+        goto solved;
     }
-    else
+
+    //
+    // Case 3: vn2 = 0 and x1 = 0
+    // The first constraint is satisfied and the second constraint is violated
+    //
+    // vn1 = a11 * 0 + a12 * x2 + b1'
+    //   0 = a21 * 0 + a22 * x2 + b2'
+    //
+    x.x = 0.0f;
+    x.y = cp2.normalMass * -b.y;
+    vn1 = cc.k[1][0] * x.y + b.x;
+    vn2 = 0.0f;
+    if (x.y >= 0.0f && vn1 >= 0.0f)
     {
-        // Solve two contact constraints simultaneously (2-Contact LCP solver)
-        blockSolver.Solve();
+        goto solved;
+    }
+
+    //
+    // Case 4: x1 = 0 and x2 = 0
+    // Both constraints are satisfied
+    //
+    // vn1 = b1
+    // vn2 = b2;
+    //
+    x.x = 0.0f;
+    x.y = 0.0f;
+    vn1 = b.x;
+    vn2 = b.y;
+    if (vn1 >= 0.0f && vn2 >= 0.0f)
+    {
+        goto solved;
     }
+
+// How did you reach here?! something went wrong!
+// You can sometimes reach here because of floating point errors :(
+#if 0
+        MuliAssert(false);
+#endif
+
+solved:
+    // Get the incremental impulse
+    Vec2 d = x - a;
+
+    // Apply incremental impulse
+    // V2 = V2' + M^-1 ⋅ Pc
+    // Pc = J^t ⋅ λ
+    v1.v += -normal * (cc.invMass1 * (d.x + d.y));
+    v1.w += cc.invInertia1 * (cp1.normalWA * d.x + cp2.normalWA * d.y);
+    v2.v += normal * (cc.invMass2 * (d.x + d.y));
+    v2.w += cc.invInertia2 * (cp1.normalWB * d.x + cp2.normalWB * d.y);
+
+    // Accumulate
+    cp1.normalImpulse = x.x;
+    cp2.normalImpulse = x.y;
 }
 
-bool Contact::SolvePositionConstraints(const Timestep& step)
+void Contact::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
-    bool solved = true;
+    SolverVelocity& v1 = bodies.velocities[index1];
+    SolverVelocity& v2 = bodies.velocities[index2];
+
+    ContactConstraint& cc = constraint;
+
+    const Vec2& normal = manifold.contactNormal;
+    const Vec2& tangent = manifold.contactTangent;
+
+    // Compute corrective impulse: Pc
+    // Pc = J^t * λ (λ: lagrangian multiplier)
+    // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    cLinearImpulseA.SetZero();
-    cLinearImpulseB.SetZero();
-    cAngularImpulseA = 0.0f;
-    cAngularImpulseB = 0.0f;
+    // Solve tangential constraint first
+    for (int32 i = 0; i < manifold.contactCount; ++i)
+    {
+        ContactConstraintPoint& cp = cc.points[i];
+
+        // clang-format off
+        // Jacobian * velocity vector (Tangent velocity)
+        float jv = Dot(-tangent, v1.v)
+                 + cp.tangentWA * v1.w
+                 + Dot(tangent, v2.v)
+                 + cp.tangentWB * v2.w;
+        // clang-format on
+
+        float lambda = cp.tangentMass * -(jv - surfaceSpeed);
+
+        // Clamp impulse correctly and accumulate it
+        float maxFriction = friction * cp.normalImpulse;
+        float oldImpulse = cp.tangentImpulse;
+        cp.tangentImpulse = Clamp(oldImpulse + lambda, -maxFriction, maxFriction);
+        lambda = cp.tangentImpulse - oldImpulse;
+
+        // Apply impulse
+        // V2 = V2' + M^-1 ⋅ Pc
+        // Pc = J^t ⋅ λ
+        v1.v += -tangent * (cc.invMass1 * lambda);
+        v1.w += cc.invInertia1 * cp.tangentWA * lambda;
+        v2.v += tangent * (cc.invMass2 * lambda);
+        v2.w += cc.invInertia2 * cp.tangentWB * lambda;
+    }
+
+    if (cc.blockSolve)
+    {
+        // Solve two contact constraints simultaneously (2-Contact LCP solver)
+        SolveBlock(cc, normal, v1, v2);
+        return;
+    }
 
-    // Solve position constraint
     for (int32 i = 0; i < manifold.contactCount; ++i)
     {
-        solved &= positionSolvers[i].Solve();
+        ContactConstraintPoint& cp = cc.points[i];
+
+        // clang-format off
+        // Velocity constraint: C = jv
+        // Jacobian * velocity vector (Normal velocity)
+        float jv = Dot(-normal, v1.v)
+                 + cp.normalWA * v1.w
+                 + Dot(normal, v2.v)
+                 + cp.normalWB * v2.w;
+        // clang-format on
+
+        float lambda = cp.normalMass * -(jv + cp.bias);
+
+        float oldImpulse = cp.normalImpulse;
+        cp.normalImpulse = Max(0.0f, oldImpulse + lambda);
+        lambda = cp.normalImpulse - oldImpulse;
+
+        v1.v += -normal * (cc.invMass1 * lambda);
+        v1.w += cc.invInertia1 * cp.normalWA * lambda;
+        v2.v += normal * (cc.invMass2 * lambda);
+        v2.w += cc.invInertia2 * cp.normalWB * lambda;
     }
+}
+
+bool Contact::SolvePositionConstraints(const Timestep& step, SolverBodies& bodies)
+{
+    MuliNotUsed(step);
+
+    // We can't expect separation >= -linear_slop
+    // because we don't push the separation above -linear_slop
+    bool solved = SolvePositions(bodies, position_correction, max_position_correction, position_solver_threshold, false);
 
-    b1->sweep.c += b1->invMass * cLinearImpulseA;
-    b1->sweep.a += b1->invInertia * cAngularImpulseA;
-    b2->sweep.c += b2->invMass * cLinearImpulseB;
-    b2->sweep.a += b2->invInertia * cAngularImpulseB;
+    if (solved == false)
+    {
+        b1->Awake();
+        b2->Awake();
+    }
 
     return solved;
 }
 
-bool Contact::SolveTOIPositionConstraints()
+bool Contact::SolveTOIPositionConstraints(SolverBodies& bodies)
 {
-    bool solved = true;
+    // TOI position solver must push further than the discrete position solver
+    return SolvePositions(bodies, toi_position_correction, max_toi_position_correction, toi_position_solver_threshold, true);
+}
+
+bool Contact::SolvePositions(SolverBodies& bodies, float correction, float maxCorrection, float threshold, bool toi)
+{
+    SolverPosition& p1 = bodies.positions[index1];
+    SolverPosition& p2 = bodies.positions[index2];
+
+    const ContactConstraint& cc = constraint;
+
+    Transform tfA{ p1.c, p1.a };
+    Transform tfB{ p2.c, p2.a };
 
-    cLinearImpulseA.SetZero();
-    cLinearImpulseB.SetZero();
-    cAngularImpulseA = 0.0f;
-    cAngularImpulseB = 0.0f;
+    Vec2 planePoint = Mul(tfA, cc.localPlainPoint);
+    Vec2 normal = Mul(tfA.rotation, cc.localNormal);
+
+    // Impulse buffer for position correction
+    Vec2 linearImpulseA{ 0.0f }, linearImpulseB{ 0.0f };
+    float angularImpulseA = 0.0f, angularImpulseB = 0.0f;
+
+    bool solved = true;
 
-    // Solve position constraint
     for (int32 i = 0; i < manifold.contactCount; ++i)
     {
-        solved &= positionSolvers[i].SolveTOI();
+        Vec2 clipPoint = Mul(tfB, cc.points[i].localClipPoint); // penetration point
+
+        float separation = Dot(clipPoint - planePoint, normal);
+
+        Vec2 ra = clipPoint - tfA.position;
+        Vec2 rb = clipPoint - tfB.position;
+
+        float ran = Cross(ra, normal);
+        float rbn = Cross(rb, normal);
+
+        // clang-format off
+        // effective mass = 1 / k;
+        float k = cc.invMass1
+                + ran * cc.invInertia1 * ran
+                + cc.invMass2
+                + rbn * cc.invInertia2 * rbn;
+        // clang-format on
+
+        // Constraint (bias)
+        float c = Clamp(correction * (separation + linear_slop), -maxCorrection, 0.0f);
+
+        // Compute normal impulse
+        float lambda = k > 0.0f ? -c / k : 0.0f;
+        Vec2 impulse = normal * lambda;
+
+        linearImpulseA -= impulse;
+        angularImpulseA -= Cross(ra, impulse);
+        linearImpulseB += impulse;
+        angularImpulseB += Cross(rb, impulse);
+
+        solved &= -separation <= threshold;
     }
 
     // Push the body only if it's involved in TOI contact
     // TOI index == 0 or 1
-    if (b1->islandIndex < 2)
+    if (toi == false || index1 < 2)
     {
-        b1->sweep.c += b1->invMass * cLinearImpulseA;
-        b1->sweep.a += b1->invInertia * cAngularImpulseA;
+        p1.c += cc.invMass1 * linearImpulseA;
+        p1.a += cc.invInertia1 * angularImpulseA;
     }
-    if (b2->islandIndex < 2)
+    if (toi == false || index2 < 2)
     {
-        b2->sweep.c += b2->invMass * cLinearImpulseB;
-        b2->sweep.a += b2->invInertia * cAngularImpulseB;
+        p2.c += cc.invMass2 * linearImpulseB;
+        p2.a += cc.invInertia2 * angularImpulseB;
     }
 
     return solved;
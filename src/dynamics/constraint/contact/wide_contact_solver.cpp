@@ -0,0 +1,509 @@
+#include "muli/wide_contact_solver.h"
+#include "muli/contact.h"
+#include "muli/world.h"
+
+namespace muli
+{
+
+// Velocities of the bodies of a batch, one body per lane
+struct WideVelocity
+{
+    FloatW vx, vy, w;
+};
+
+struct WidePosition
+{
+    FloatW cx, cy;
+    FloatW s, c; // Rotation
+};
+
+// The lane math below follows the scalar contact solver operation by operation,
+// so that the wide solver produces the same results as the colored scalar solver
+
+static void SolveTangent(WideContactBatch& b, int32 p, WideVelocity& v1, WideVelocity& v2)
+{
+    FloatW vbx = LoadW(b.tangentX);
+    FloatW vby = LoadW(b.tangentY);
+    FloatW vax = -vbx;
+    FloatW vay = -vby;
+    FloatW wa = LoadW(b.tangentWA[p]);
+    FloatW wb = LoadW(b.tangentWB[p]);
+
+    FloatW jv = vax * v1.vx + vay * v1.vy + wa * v1.w + (vbx * v2.vx + vby * v2.vy) + wb * v2.w;
+    FloatW lambda = LoadW(b.tangentMass[p]) * -(jv + LoadW(b.tangentBias));
+
+    FloatW oldImpulse = LoadW(b.tangentImpulse[p]);
+    FloatW maxFriction = LoadW(b.friction) * LoadW(b.normalImpulse[p]);
+    FloatW impulse = MaxW(-maxFriction, MinW(oldImpulse + lambda, maxFriction));
+    StoreW(b.tangentImpulse[p], impulse);
+
+    lambda = impulse - oldImpulse;
+
+    FloatW im1 = LoadW(b.invMass1);
+    FloatW im2 = LoadW(b.invMass2);
+
+    v1.vx = v1.vx + vax * (im1 * lambda);
+    v1.vy = v1.vy + vay * (im1 * lambda);
+    v1.w = v1.w + LoadW(b.invInertia1) * wa * lambda;
+    v2.vx = v2.vx + vbx * (im2 * lambda);
+    v2.vy = v2.vy + vby * (im2 * lambda);
+    v2.w = v2.w + LoadW(b.invInertia2) * wb * lambda;
+}
+
+static void SolveNormal(WideContactBatch& b, int32 p, WideVelocity& v1, WideVelocity& v2)
+{
+    FloatW vbx = LoadW(b.normalX);
+    FloatW vby = LoadW(b.normalY);
+    FloatW vax = -vbx;
+    FloatW vay = -vby;
+    FloatW wa = LoadW(b.normalWA[p]);
+    FloatW wb = LoadW(b.normalWB[p]);
+
+    FloatW jv = vax * v1.vx + vay * v1.vy + wa * v1.w + (vbx * v2.vx + vby * v2.vy) + wb * v2.w;
+    FloatW lambda = LoadW(b.normalMass[p]) * -(jv + LoadW(b.normalBias[p]));
+
+    FloatW oldImpulse = LoadW(b.normalImpulse[p]);
+    FloatW impulse = MaxW(SplatW(0.0f), oldImpulse + lambda);
+    StoreW(b.normalImpulse[p], impulse);
+
+    lambda = impulse - oldImpulse;
+
+    FloatW im1 = LoadW(b.invMass1);
+    FloatW im2 = LoadW(b.invMass2);
+
+    v1.vx = v1.vx + vax * (im1 * lambda);
+    v1.vy = v1.vy + vay * (im1 * lambda);
+    v1.w = v1.w + LoadW(b.invInertia1) * wa * lambda;
+    v2.vx = v2.vx + vbx * (im2 * lambda);
+    v2.vy = v2.vy + vby * (im2 * lambda);
+    v2.w = v2.w + LoadW(b.invInertia2) * wb * lambda;
+}
+
+// See SolveBlock() in contact.cpp
+static void SolveBlock(WideContactBatch& b, WideVelocity& v1, WideVelocity& v2)
+{
+    FloatW zero = SplatW(0.0f);
+
+    FloatW vbx = LoadW(b.normalX);
+    FloatW vby = LoadW(b.normalY);
+    FloatW vax = -vbx;
+    FloatW vay = -vby;
+    FloatW wa1 = LoadW(b.normalWA[0]);
+    FloatW wb1 = LoadW(b.normalWB[0]);
+    FloatW wa2 = LoadW(b.normalWA[1]);
+    FloatW wb2 = LoadW(b.normalWB[1]);
+
+    FloatW ax = LoadW(b.normalImpulse[0]);
+    FloatW ay = LoadW(b.normalImpulse[1]);
+
+    FloatW vn1 = vax * v1.vx + vay * v1.vy + wa1 * v1.w + (vbx * v2.vx + vby * v2.vy) + wb1 * v2.w;
+    FloatW vn2 = vax * v1.vx + vay * v1.vy + wa2 * v1.w + (vbx * v2.vx + vby * v2.vy) + wb2 * v2.w;
+
+    FloatW kxx = LoadW(b.kxx);
+    FloatW kxy = LoadW(b.kxy);
+    FloatW kyx = LoadW(b.kyx);
+    FloatW kyy = LoadW(b.kyy);
+
+    // b' = b - K * a
+    FloatW bx = vn1 + LoadW(b.normalBias[0]);
+    FloatW by = vn2 + LoadW(b.normalBias[1]);
+    bx = bx - (kxx * ax + kyx * ay);
+    by = by - (kxy * ax + kyy * ay);
+
+    // Case 1: x = -inv(A) * b'
+    FloatW x1 = -(LoadW(b.mxx) * bx + LoadW(b.myx) * by);
+    FloatW y1 = -(LoadW(b.mxy) * bx + LoadW(b.myy) * by);
+    MaskW case1 = AndW(x1 >= zero, y1 >= zero);
+
+    // Case 2: vn1 = 0 and x2 = 0
+    FloatW x2 = LoadW(b.normalMass[0]) * -bx;
+    MaskW case2 = AndW(x2 >= zero, kxy * x2 + by >= zero);
+
+    // Case 3: vn2 = 0 and x1 = 0
+    FloatW y3 = LoadW(b.normalMass[1]) * -by;
+    MaskW case3 = AndW(y3 >= zero, kyx * y3 + bx >= zero);
+
+    // Case 4 and the unsolved lanes end up with x = 0
+    FloatW x = SelectW(case1, x1, SelectW(case2, x2, zero));
+    FloatW y = SelectW(case1, y1, SelectW(case2, zero, SelectW(case3, y3, zero)));
+
+    // Apply the incremental impulse
+    FloatW dx = x - ax;
+    FloatW dy = y - ay;
+
+    FloatW im1 = LoadW(b.invMass1);
+    FloatW im2 = LoadW(b.invMass2);
+
+    v1.vx = v1.vx + vax * (im1 * (dx + dy));
+    v1.vy = v1.vy + vay * (im1 * (dx + dy));
+    v1.w = v1.w + LoadW(b.invInertia1) * (wa1 * dx + wa2 * dy);
+    v2.vx = v2.vx + vbx * (im2 * (dx + dy));
+    v2.vy = v2.vy + vby * (im2 * (dx + dy));
+    v2.w = v2.w + LoadW(b.invInertia2) * (wb1 * dx + wb2 * dy);
+
+    StoreW(b.normalImpulse[0], x);
+    StoreW(b.normalImpulse[1], y);
+}
+
+WideContactSolver::WideContactSolver(LinearAllocator* allocator, int32 contactCount, int32 groupCount)
+    : allocator{ allocator }
+    , batchCount{ 0 }
+{
+    // Every group leaves at most one partially filled batch for each contact point count
+    batchCapacity = contactCount / simd_width + groupCount * max_contact_point_count;
+    batches = (WideContactBatch*)allocator->Allocate(batchCapacity * sizeof(WideContactBatch));
+}
+
+WideContactSolver::~WideContactSolver()
+{
+    allocator->Free(batches, batchCapacity * sizeof(WideContactBatch));
+}
+
+void WideContactSolver::AddContacts(Contact** contacts, int32 count)
+{
+    for (int32 pointCount = 1; pointCount <= max_contact_point_count; ++pointCount)
+    {
+        AddBatches(contacts, count, pointCount);
+    }
+}
+
+void WideContactSolver::AddBatches(Contact** contacts, int32 count, int32 pointCount)
+{
+    WideContactBatch* batch = nullptr;
+
+    for (int32 i = 0; i < count; ++i)
+    {
+        Contact* c = contacts[i];
+        if (c->manifold.contactCount != pointCount)
+        {
+            continue;
+        }
+
+        if (batch == nullptr || batch->contactCount == simd_width)
+        {
+            MuliAssert(batchCount < batchCapacity);
+            batch = batches + batchCount++;
+
+            // Unused lanes stay zero, so they never produce an impulse
+            memset(batch, 0, sizeof(WideContactBatch));
+            batch->pointCount = pointCount;
+        }
+
+        batch->contacts[batch->contactCount++] = c;
+    }
+}
+
+void WideContactSolver::Prepare(int32 batchIndex, const Timestep& step, SolverBodies& bodies)
+{
+    WideContactBatch& b = batches[batchIndex];
+
+    for (int32 i = 0; i < b.contactCount; ++i)
+    {
+        Contact* c = b.contacts[i];
+        c->Prepare(step, bodies);
+
+        b.index1[i] = c->index1;
+        b.index2[i] = c->index2;
+
+        const ContactConstraint& cc = c->constraint;
+
+        b.invMass1[i] = cc.invMass1;
+        b.invInertia1[i] = cc.invInertia1;
+        b.invMass2[i] = cc.invMass2;
+        b.invInertia2[i] = cc.invInertia2;
+
+        b.friction[i] = c->friction;
+        b.tangentBias[i] = -c->surfaceSpeed;
+
+        b.normalX[i] = c->manifold.contactNormal.x;
+        b.normalY[i] = c->manifold.contactNormal.y;
+        b.tangentX[i] = c->manifold.contactTangent.x;
+        b.tangentY[i] = c->manifold.contactTangent.y;
+
+        for (int32 p = 0; p < b.pointCount; ++p)
+        {
+            const ContactConstraintPoint& cp = cc.points[p];
+
+            b.normalWA[p][i] = cp.normalWA;
+            b.normalWB[p][i] = cp.normalWB;
+            b.normalBias[p][i] = cp.bias;
+            b.normalMass[p][i] = cp.normalMass;
+            b.normalImpulse[p][i] = cp.normalImpulse;
+
+            b.tangentWA[p][i] = cp.tangentWA;
+            b.tangentWB[p][i] = cp.tangentWB;
+            b.tangentMass[p][i] = cp.tangentMass;
+            b.tangentImpulse[p][i] = cp.tangentImpulse;
+
+            b.localClipPointX[p][i] = cp.localClipPoint.x;
+            b.localClipPointY[p][i] = cp.localClipPoint.y;
+        }
+
+        b.localPlainPointX[i] = cc.localPlainPoint.x;
+        b.localPlainPointY[i] = cc.localPlainPoint.y;
+        b.localNormalX[i] = cc.localNormal.x;
+        b.localNormalY[i] = cc.localNormal.y;
+
+        if (b.pointCount == 2)
+        {
+            b.blockSolve[i] = cc.blockSolve;
+            b.kxx[i] = cc.k.ex.x;
+            b.kxy[i] = cc.k.ex.y;
+            b.kyx[i] = cc.k.ey.x;
+            b.kyy[i] = cc.k.ey.y;
+            b.mxx[i] = cc.m.ex.x;
+            b.mxy[i] = cc.m.ex.y;
+            b.myx[i] = cc.m.ey.x;
+            b.myy[i] = cc.m.ey.y;
+        }
+    }
+
+    // Unused lanes follow the first lane, so they don't force the mixed path
+    for (int32 i = b.contactCount; i < simd_width; ++i)
+    {
+        b.blockSolve[i] = b.blockSolve[0];
+    }
+}
+
+void WideContactSolver::SolveVelocityConstraints(int32 batchIndex, SolverBodies& bodies)
+{
+    WideContactBatch& b = batches[batchIndex];
+
+    float v1x[simd_width] = { 0.0f }, v1y[simd_width] = { 0.0f }, w1[simd_width] = { 0.0f };
+    float v2x[simd_width] = { 0.0f }, v2y[simd_width] = { 0.0f }, w2[simd_width] = { 0.0f };
+
+    for (int32 i = 0; i < b.contactCount; ++i)
+    {
+        const SolverVelocity& sv1 = bodies.velocities[b.index1[i]];
+        const SolverVelocity& sv2 = bodies.velocities[b.index2[i]];
+
+        v1x[i] = sv1.v.x;
+        v1y[i] = sv1.v.y;
+        w1[i] = sv1.w;
+        v2x[i] = sv2.v.x;
+        v2y[i] = sv2.v.y;
+        w2[i] = sv2.w;
+    }
+
+    WideVelocity v1{ LoadW(v1x), LoadW(v1y), LoadW(w1) };
+    WideVelocity v2{ LoadW(v2x), LoadW(v2y), LoadW(w2) };
+
+    // Solve tangential constraint first
+    for (int32 p = 0; p < b.pointCount; ++p)
+    {
+        SolveTangent(b, p, v1, v2);
+    }
+
+    if (b.pointCount == 1)
+    {
+        SolveNormal(b, 0, v1, v2);
+    }
+    else
+    {
+        float blockLanes[simd_width];
+        for (int32 i = 0; i < simd_width; ++i)
+        {
+            blockLanes[i] = b.blockSolve[i] ? 1.0f : 0.0f;
+        }
+
+        MaskW block = LoadW(blockLanes) > SplatW(0.0f);
+        int32 blockBits = MaskBits(block);
+
+        if (blockBits == simd_all_lanes)
+        {
+            SolveBlock(b, v1, v2);
+        }
+        else if (blockBits == 0)
+        {
+            SolveNormal(b, 0, v1, v2);
+            SolveNormal(b, 1, v1, v2);
+        }
+        else
+        {
+            // Lanes without a block solver solve the two points one after another
+            float impulse1[simd_width], impulse2[simd_width];
+            memcpy(impulse1, b.normalImpulse[0], sizeof(impulse1));
+            memcpy(impulse2, b.normalImpulse[1], sizeof(impulse2));
+
+            WideVelocity s1 = v1;
+            WideVelocity s2 = v2;
+            SolveNormal(b, 0, s1, s2);
+            SolveNormal(b, 1, s1, s2);
+
+            FloatW sequentialImpulse1 = LoadW(b.normalImpulse[0]);
+            FloatW sequentialImpulse2 = LoadW(b.normalImpulse[1]);
+            memcpy(b.normalImpulse[0], impulse1, sizeof(impulse1));
+            memcpy(b.normalImpulse[1], impulse2, sizeof(impulse2));
+
+            SolveBlock(b, v1, v2);
+
+            v1.vx = SelectW(block, v1.vx, s1.vx);
+            v1.vy = SelectW(block, v1.vy, s1.vy);
+            v1.w = SelectW(block, v1.w, s1.w);
+            v2.vx = SelectW(block, v2.vx, s2.vx);
+            v2.vy = SelectW(block, v2.vy, s2.vy);
+            v2.w = SelectW(block, v2.w, s2.w);
+            StoreW(b.normalImpulse[0], SelectW(block, LoadW(b.normalImpulse[0]), sequentialImpulse1));
+            StoreW(b.normalImpulse[1], SelectW(block, LoadW(b.normalImpulse[1]), sequentialImpulse2));
+        }
+    }
+
+    StoreW(v1x, v1.vx);
+    StoreW(v1y, v1.vy);
+    StoreW(w1, v1.w);
+    StoreW(v2x, v2.vx);
+    StoreW(v2y, v2.vy);
+    StoreW(w2, v2.w);
+
+    for (int32 i = 0; i < b.contactCount; ++i)
+    {
+        SolverVelocity& sv1 = bodies.velocities[b.index1[i]];
+        SolverVelocity& sv2 = bodies.velocities[b.index2[i]];
+
+        sv1.v.Set(v1x[i], v1y[i]);
+        sv1.w = w1[i];
+        sv2.v.Set(v2x[i], v2y[i]);
+        sv2.w = w2[i];
+    }
+}
+
+// See Contact::SolvePositions()
+bool WideContactSolver::SolvePositionConstraints(int32 batchIndex, SolverBodies& bodies)
+{
+    WideContactBatch& b = batches[batchIndex];
+
+    float c1x[simd_width] = { 0.0f }, c1y[simd_width] = { 0.0f }, a1[simd_width] = { 0.0f };
+    float c2x[simd_width] = { 0.0f }, c2y[simd_width] = { 0.0f }, a2[simd_width] = { 0.0f };
+    float s1[simd_width] = { 0.0f }, cos1[simd_width] = { 0.0f };
+    float s2[simd_width] = { 0.0f }, cos2[simd_width] = { 0.0f };
+
+    for (int32 i = 0; i < b.contactCount; ++i)
+    {
+        const SolverPosition& p1 = bodies.positions[b.index1[i]];
+        const SolverPosition& p2 = bodies.positions[b.index2[i]];
+
+        c1x[i] = p1.c.x;
+        c1y[i] = p1.c.y;
+        a1[i] = p1.a;
+        c2x[i] = p2.c.x;
+        c2y[i] = p2.c.y;
+        a2[i] = p2.a;
+
+        // Rotations are computed by lane with the scalar sine and cosine
+        Rotation r1{ p1.a };
+        Rotation r2{ p2.a };
+        s1[i] = r1.s;
+        cos1[i] = r1.c;
+        s2[i] = r2.s;
+        cos2[i] = r2.c;
+    }
+
+    WidePosition p1{ LoadW(c1x), LoadW(c1y), LoadW(s1), LoadW(cos1) };
+    WidePosition p2{ LoadW(c2x), LoadW(c2y), LoadW(s2), LoadW(cos2) };
+
+    FloatW zero = SplatW(0.0f);
+    FloatW im1 = LoadW(b.invMass1);
+    FloatW ii1 = LoadW(b.invInertia1);
+    FloatW im2 = LoadW(b.invMass2);
+    FloatW ii2 = LoadW(b.invInertia2);
+
+    FloatW linearImpulseAX = zero, linearImpulseAY = zero, angularImpulseA = zero;
+    FloatW linearImpulseBX = zero, linearImpulseBY = zero, angularImpulseB = zero;
+
+    FloatW lpx = LoadW(b.localPlainPointX);
+    FloatW lpy = LoadW(b.localPlainPointY);
+    FloatW lnx = LoadW(b.localNormalX);
+    FloatW lny = LoadW(b.localNormalY);
+
+    FloatW planePointX = (p1.c * lpx - p1.s * lpy) + p1.cx;
+    FloatW planePointY = (p1.s * lpx + p1.c * lpy) + p1.cy;
+    FloatW normalX = p1.c * lnx - p1.s * lny;
+    FloatW normalY = p1.s * lnx + p1.c * lny;
+
+    MaskW solved = zero <= zero;
+
+    for (int32 p = 0; p < b.pointCount; ++p)
+    {
+        FloatW lcx = LoadW(b.localClipPointX[p]);
+        FloatW lcy = LoadW(b.localClipPointY[p]);
+
+        FloatW clipPointX = (p2.c * lcx - p2.s * lcy) + p2.cx;
+        FloatW clipPointY = (p2.s * lcx + p2.c * lcy) + p2.cy;
+
+        FloatW separation = (clipPointX - planePointX) * normalX + (clipPointY - planePointY) * normalY;
+
+        FloatW rax = clipPointX - p1.cx;
+        FloatW ray = clipPointY - p1.cy;
+        FloatW rbx = clipPointX - p2.cx;
+        FloatW rby = clipPointY - p2.cy;
+
+        FloatW ran = rax * normalY - ray * normalX;
+        FloatW rbn = rbx * normalY - rby * normalX;
+
+        FloatW k = im1 + ran * ii1 * ran + im2 + rbn * ii2 * rbn;
+
+        FloatW c = MaxW(
+            SplatW(-max_position_correction), MinW(SplatW(position_correction) * (separation + SplatW(linear_slop)), zero)
+        );
+
+        FloatW lambda = SelectW(k > zero, -c / k, zero);
+        FloatW impulseX = normalX * lambda;
+        FloatW impulseY = normalY * lambda;
+
+        linearImpulseAX = linearImpulseAX - impulseX;
+        linearImpulseAY = linearImpulseAY - impulseY;
+        angularImpulseA = angularImpulseA - (rax * impulseY - ray * impulseX);
+        linearImpulseBX = linearImpulseBX + impulseX;
+        linearImpulseBY = linearImpulseBY + impulseY;
+        angularImpulseB = angularImpulseB + (rbx * impulseY - rby * impulseX);
+
+        solved = AndW(solved, -separation <= SplatW(position_solver_threshold));
+    }
+
+    StoreW(c1x, p1.cx + linearImpulseAX * im1);
+    StoreW(c1y, p1.cy + linearImpulseAY * im1);
+    StoreW(a1, LoadW(a1) + ii1 * angularImpulseA);
+    StoreW(c2x, p2.cx + linearImpulseBX * im2);
+    StoreW(c2y, p2.cy + linearImpulseBY * im2);
+    StoreW(a2, LoadW(a2) + ii2 * angularImpulseB);
+
+    int32 solvedBits = MaskBits(solved);
+
+    for (int32 i = 0; i < b.contactCount; ++i)
+    {
+        SolverPosition& sp1 = bodies.positions[b.index1[i]];
+        SolverPosition& sp2 = bodies.positions[b.index2[i]];
+
+        sp1.c.Set(c1x[i], c1y[i]);
+        sp1.a = a1[i];
+        sp2.c.Set(c2x[i], c2y[i]);
+        sp2.a = a2[i];
+
+        if ((solvedBits & (1 << i)) == 0)
+        {
+            b.contacts[i]->b1->Awake();
+            b.contacts[i]->b2->Awake();
+        }
+    }
+
+    int32 usedLanes = (1 << b.contactCount) - 1;
+    return (solvedBits & usedLanes) == usedLanes;
+}
+
+void WideContactSolver::StoreImpulses(int32 batchIndex)
+{
+    WideContactBatch& b = batches[batchIndex];
+
+    for (int32 i = 0; i < b.contactCount; ++i)
+    {
+        Contact* c = b.contacts[i];
+
+        for (int32 p = 0; p < b.pointCount; ++p)
+        {
+            c->constraint.points[p].normalImpulse = b.normalImpulse[p][i];
+            c->constraint.points[p].tangentImpulse = b.tangentImpulse[p][i];
+        }
+    }
+}
+
+} // namespace muli
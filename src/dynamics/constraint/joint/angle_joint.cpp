@@ -11,53 +11,66 @@ AngleJoint::AngleJoint(RigidBody* bodyA, RigidBody* bodyB, float jointFrequency,
     angleOffset = bodyB->sweep.a - bodyA->sweep.a;
 }
 
-void AngleJoint::Prepare(const Timestep& step)
+void AngleJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
     // J = [0 -1 0 1]
     // M = (J · M^-1 · J^t)^-1
 
-    float k = bodyA->invInertia + bodyB->invInertia + gamma;
+    float k = mA.invInertia + mB.invInertia + gamma;
 
     if (k != 0.0f)
     {
         m = 1.0f / k;
     }
 
-    float error = bodyB->sweep.a - bodyA->sweep.a - angleOffset;
+    float error = pB.a - pA.a - angleOffset;
     bias = error * beta * step.inv_dt;
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void AngleJoint::SolveVelocityConstraints(const Timestep& step)
+void AngleJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t · λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    float jv = bodyB->angularVelocity - bodyA->angularVelocity;
+    float jv = vB.w - vA.w;
 
     float lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void AngleJoint::ApplyImpulse(float lambda)
+void AngleJoint::ApplyImpulse(SolverBodies& bodies, float lambda)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
-    bodyA->angularVelocity -= lambda * bodyA->invInertia;
-    bodyB->angularVelocity += lambda * bodyB->invInertia;
+    vA.w -= lambda * mA.invInertia;
+    vB.w += lambda * mB.invInertia;
 }
 
 } // namespace muli
\ No newline at end of file
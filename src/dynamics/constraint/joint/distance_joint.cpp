@@ -22,8 +22,13 @@ DistanceJoint::DistanceJoint(
     length = jointLength < 0.0f ? Length(anchorB - anchorA) : jointLength;
 }
 
-void DistanceJoint::Prepare(const Timestep& step)
+void DistanceJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -33,16 +38,16 @@ void DistanceJoint::Prepare(const Timestep& step)
     ra = Mul(bodyA->GetRotation(), localAnchorA - bodyA->sweep.localCenter);
     rb = Mul(bodyB->GetRotation(), localAnchorB - bodyB->sweep.localCenter);
 
-    Vec2 pa = bodyA->sweep.c + ra;
-    Vec2 pb = bodyB->sweep.c + rb;
+    Vec2 pa = pA.c + ra;
+    Vec2 pb = pB.c + rb;
 
     d = pb - pa;
     float currentLength = d.Normalize();
 
     // clang-format off
-    float k = bodyA->invMass + bodyB->invMass
-            + bodyA->invInertia * Cross(d, ra) * Cross(d, ra)
-            + bodyB->invInertia * Cross(d, rb) * Cross(d, rb)
+    float k = mA.invMass + mB.invMass
+            + mA.invInertia * Cross(d, ra) * Cross(d, ra)
+            + mB.invInertia * Cross(d, rb) * Cross(d, rb)
             + gamma;
     // clang-format on
 
@@ -56,41 +61,46 @@ void DistanceJoint::Prepare(const Timestep& step)
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void DistanceJoint::SolveVelocityConstraints(const Timestep& step)
+void DistanceJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t · λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    float jv =
-        Dot((bodyB->linearVelocity + Cross(bodyB->angularVelocity, rb)) -
-                (bodyA->linearVelocity + Cross(bodyA->angularVelocity, ra)),
-            d);
+    float jv = Dot((vB.v + Cross(vB.w, rb)) - (vA.v + Cross(vA.w, ra)), d);
 
     // You don't have to clamp the impulse. It's equality constraint!
     float lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void DistanceJoint::ApplyImpulse(float lambda)
+void DistanceJoint::ApplyImpulse(SolverBodies& bodies, float lambda)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
     Vec2 p = d * lambda;
 
-    bodyA->linearVelocity -= p * bodyA->invMass;
-    bodyA->angularVelocity -= Dot(d, Cross(lambda, ra)) * bodyA->invInertia;
-    bodyB->linearVelocity += p * bodyB->invMass;
-    bodyB->angularVelocity += Dot(d, Cross(lambda, rb)) * bodyB->invInertia;
+    vA.v -= p * mA.invMass;
+    vA.w -= Dot(d, Cross(lambda, ra)) * mA.invInertia;
+    vB.v += p * mB.invMass;
+    vB.w += Dot(d, Cross(lambda, rb)) * mB.invInertia;
 }
 
 } // namespace muli
\ No newline at end of file
@@ -19,8 +19,11 @@ GrabJoint::GrabJoint(
     target = targetPosition;
 }
 
-void GrabJoint::Prepare(const Timestep& step)
+void GrabJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverMass& mA = bodies.masses[indexA];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -28,14 +31,14 @@ void GrabJoint::Prepare(const Timestep& step)
     // M = (J · M^-1 · J^t)^-1
 
     r = Mul(bodyA->GetRotation(), localAnchor - bodyA->sweep.localCenter);
-    Vec2 p = bodyA->sweep.c + r;
+    Vec2 p = pA.c + r;
 
     Mat2 k;
 
-    k[0][0] = bodyA->invMass + bodyA->invInertia * r.y * r.y;
-    k[1][0] = -bodyA->invInertia * r.y * r.x;
-    k[0][1] = -bodyA->invInertia * r.x * r.y;
-    k[1][1] = bodyA->invMass + bodyA->invInertia * r.x * r.x;
+    k[0][0] = mA.invMass + mA.invInertia * r.y * r.y;
+    k[1][0] = -mA.invInertia * r.y * r.x;
+    k[0][1] = -mA.invInertia * r.x * r.y;
+    k[1][1] = mA.invMass + mA.invInertia * r.x * r.x;
 
     k[0][0] += gamma;
     k[1][1] += gamma;
@@ -47,30 +50,35 @@ void GrabJoint::Prepare(const Timestep& step)
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void GrabJoint::SolveVelocityConstraints(const Timestep& step)
+void GrabJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+
     // Compute corrective impulse: Pc
     // Pc = J^t · λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    Vec2 jv = bodyA->linearVelocity + Cross(bodyA->angularVelocity, r);
+    Vec2 jv = vA.v + Cross(vA.w, r);
 
     Vec2 lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void GrabJoint::ApplyImpulse(const Vec2& lambda)
+void GrabJoint::ApplyImpulse(SolverBodies& bodies, const Vec2& lambda)
 {
-    bodyA->linearVelocity += lambda * bodyA->invMass;
-    bodyA->angularVelocity += bodyA->invInertia * Cross(r, lambda);
+    SolverVelocity& vA = bodies.velocities[indexA];
+    const SolverMass& mA = bodies.masses[indexA];
+
+    vA.v += lambda * mA.invMass;
+    vA.w += mA.invInertia * Cross(r, lambda);
 }
 
 } // namespace muli
\ No newline at end of file
@@ -30,8 +30,13 @@ LineJoint::LineJoint(
     }
 }
 
-void LineJoint::Prepare(const Timestep& step)
+void LineJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -40,8 +45,8 @@ void LineJoint::Prepare(const Timestep& step)
 
     Vec2 ra = Mul(bodyA->GetRotation(), localAnchorA - bodyA->sweep.localCenter);
     Vec2 rb = Mul(bodyB->GetRotation(), localAnchorB - bodyB->sweep.localCenter);
-    Vec2 pa = bodyA->sweep.c + ra;
-    Vec2 pb = bodyB->sweep.c + rb;
+    Vec2 pa = pA.c + ra;
+    Vec2 pb = pB.c + rb;
     Vec2 d = pb - pa;
 
     t = Mul(bodyA->GetRotation(), localYAxis);
@@ -49,9 +54,9 @@ void LineJoint::Prepare(const Timestep& step)
     sb = Cross(rb, t);
 
     // clang-format off
-    float k = bodyA->invMass + bodyB->invMass
-            + bodyA->invInertia * sa * sa
-            + bodyB->invInertia * sb * sb
+    float k = mA.invMass + mB.invMass
+            + mA.invInertia * sa * sa
+            + mB.invInertia * sb * sb
             + gamma;
     // clang-format on
 
@@ -65,37 +70,45 @@ void LineJoint::Prepare(const Timestep& step)
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void LineJoint::SolveVelocityConstraints(const Timestep& step)
+void LineJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t · λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    float jv = Dot(t, bodyB->linearVelocity - bodyA->linearVelocity) + sb * bodyB->angularVelocity - sa * bodyA->angularVelocity;
+    float jv = Dot(t, vB.v - vA.v) + sb * vB.w - sa * vA.w;
 
     float lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void LineJoint::ApplyImpulse(float lambda)
+void LineJoint::ApplyImpulse(SolverBodies& bodies, float lambda)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
     Vec2 p = t * lambda;
 
-    bodyA->linearVelocity -= p * bodyA->invMass;
-    bodyA->angularVelocity -= lambda * sa * bodyA->invInertia;
-    bodyB->linearVelocity += p * bodyB->invMass;
-    bodyB->angularVelocity += lambda * sb * bodyB->invInertia;
+    vA.v -= p * mA.invMass;
+    vA.w -= lambda * sa * mA.invInertia;
+    vB.v += p * mB.invMass;
+    vB.w += lambda * sb * mB.invInertia;
 }
 
 } // namespace muli
\ No newline at end of file
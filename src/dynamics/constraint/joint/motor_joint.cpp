@@ -29,8 +29,13 @@ MotorJoint::MotorJoint(
     maxTorque = maxJointTorque < 0 ? max_value : Clamp<float>(maxJointTorque, 0.0f, max_value);
 }
 
-void MotorJoint::Prepare(const Timestep& step)
+void MotorJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -43,43 +48,45 @@ void MotorJoint::Prepare(const Timestep& step)
 
     Mat2 k0;
 
-    k0[0][0] = bodyA->invMass + bodyB->invMass + bodyA->invInertia * ra.y * ra.y + bodyB->invInertia * rb.y * rb.y;
-    k0[1][0] = -bodyA->invInertia * ra.y * ra.x - bodyB->invInertia * rb.y * rb.x;
+    k0[0][0] = mA.invMass + mB.invMass + mA.invInertia * ra.y * ra.y + mB.invInertia * rb.y * rb.y;
+    k0[1][0] = -mA.invInertia * ra.y * ra.x - mB.invInertia * rb.y * rb.x;
     k0[0][1] = k0[1][0];
-    k0[1][1] = bodyA->invMass + bodyB->invMass + bodyA->invInertia * ra.x * ra.x + bodyB->invInertia * rb.x * rb.x;
+    k0[1][1] = mA.invMass + mB.invMass + mA.invInertia * ra.x * ra.x + mB.invInertia * rb.x * rb.x;
 
     k0[0][0] += gamma;
     k0[1][1] += gamma;
 
-    float k1 = bodyA->invInertia + bodyB->invInertia + gamma;
+    float k1 = mA.invInertia + mB.invInertia + gamma;
 
     m0 = k0.GetInverse();
     m1 = 1.0f / k1;
 
-    Vec2 pa = bodyA->sweep.c + ra;
-    Vec2 pb = bodyB->sweep.c + rb;
+    Vec2 pa = pA.c + ra;
+    Vec2 pb = pB.c + rb;
 
     bias0 = pb - pa + linearOffset;
-    bias1 = bodyB->sweep.a - bodyA->sweep.a - angleOffset - angularOffset;
+    bias1 = pB.a - pA.a - angleOffset - angularOffset;
 
     bias0 *= beta * step.inv_dt;
     bias1 *= beta * step.inv_dt;
 
     if (step.warm_starting)
     {
-        ApplyImpulse(linearImpulseSum, angularImpulseSum);
+        ApplyImpulse(bodies, linearImpulseSum, angularImpulseSum);
     }
 }
 
-void MotorJoint::SolveVelocityConstraints(const Timestep& step)
+void MotorJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t * λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    Vec2 jv0 =
-        (bodyB->linearVelocity + Cross(bodyB->angularVelocity, rb)) - (bodyA->linearVelocity + Cross(bodyA->angularVelocity, ra));
-    float jv1 = bodyB->angularVelocity - bodyA->angularVelocity;
+    Vec2 jv0 = (vB.v + Cross(vB.w, rb)) - (vA.v + Cross(vA.w, ra));
+    float jv1 = vB.w - vA.w;
 
     Vec2 lambda0 = m0 * -(jv0 + bias0 + linearImpulseSum * gamma);
     float lambda1 = m1 * -(jv1 + bias1 + angularImpulseSum * gamma);
@@ -110,29 +117,34 @@ void MotorJoint::SolveVelocityConstraints(const Timestep& step)
         lambda1 = angularImpulseSum - oldAngularImpulse;
     }
 
-    ApplyImpulse(lambda0, lambda1);
+    ApplyImpulse(bodies, lambda0, lambda1);
 }
 
-void MotorJoint::ApplyImpulse(const Vec2& lambda0, float lambda1)
+void MotorJoint::ApplyImpulse(SolverBodies& bodies, const Vec2& lambda0, float lambda1)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
 #if 1
-    bodyA->linearVelocity -= bodyA->invMass * lambda0;
-    bodyA->angularVelocity -= bodyA->invInertia * (Cross(ra, lambda0) + lambda1);
-    bodyB->linearVelocity += bodyB->invMass * lambda0;
-    bodyB->angularVelocity += bodyB->invInertia * (Cross(rb, lambda0) + lambda1);
+    vA.v -= mA.invMass * lambda0;
+    vA.w -= mA.invInertia * (Cross(ra, lambda0) + lambda1);
+    vB.v += mB.invMass * lambda0;
+    vB.w += mB.invInertia * (Cross(rb, lambda0) + lambda1);
 #else
     // Solve for point-to-point constraint
-    bodyA->linearVelocity -= lambda0 * bodyA->invMass;
-    bodyA->angularVelocity -= bodyA->invInertia * Cross(ra, lambda0);
-    bodyB->linearVelocity += lambda0 * bodyB->invMass;
-    bodyB->angularVelocity += bodyB->invInertia * Cross(rb, lambda0);
+    vA.v -= lambda0 * mA.invMass;
+    vA.w -= mA.invInertia * Cross(ra, lambda0);
+    vB.v += lambda0 * mB.invMass;
+    vB.w += mB.invInertia * Cross(rb, lambda0);
 
     // Solve for angle constraint
-    bodyA->angularVelocity -= lambda1 * bodyA->invInertia;
-    bodyB->angularVelocity -= lambda1 * bodyB->invInertia;
+    vA.w -= lambda1 * mA.invInertia;
+    vB.w -= lambda1 * mB.invInertia;
 #endif
 }
 
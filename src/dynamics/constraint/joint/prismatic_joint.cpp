@@ -34,8 +34,13 @@ PrismaticJoint::PrismaticJoint(
     angleOffset = bodyB->GetAngle() - bodyA->GetAngle();
 }
 
-void PrismaticJoint::Prepare(const Timestep& step)
+void PrismaticJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -45,8 +50,8 @@ void PrismaticJoint::Prepare(const Timestep& step)
 
     Vec2 ra = Mul(bodyA->GetRotation(), localAnchorA - bodyA->sweep.localCenter);
     Vec2 rb = Mul(bodyB->GetRotation(), localAnchorB - bodyB->sweep.localCenter);
-    Vec2 pa = bodyA->sweep.c + ra;
-    Vec2 pb = bodyB->sweep.c + rb;
+    Vec2 pa = pA.c + ra;
+    Vec2 pb = pB.c + rb;
     Vec2 d = pb - pa;
 
     // tangent/perpendicular vector
@@ -56,10 +61,10 @@ void PrismaticJoint::Prepare(const Timestep& step)
 
     Mat2 k;
 
-    k[0][0] = bodyA->invMass + bodyB->invMass + sa * sa * bodyA->invInertia + sb * sb * bodyB->invInertia;
-    k[1][0] = sa * bodyA->invInertia + sb * bodyB->invInertia;
+    k[0][0] = mA.invMass + mB.invMass + sa * sa * mA.invInertia + sb * sb * mB.invInertia;
+    k[1][0] = sa * mA.invInertia + sb * mB.invInertia;
     k[0][1] = k[1][0];
-    k[1][1] = bodyA->invInertia + bodyB->invInertia;
+    k[1][1] = mA.invInertia + mB.invInertia;
 
     k[0][0] += gamma;
     k[1][1] += gamma;
@@ -74,39 +79,47 @@ void PrismaticJoint::Prepare(const Timestep& step)
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void PrismaticJoint::SolveVelocityConstraints(const Timestep& step)
+void PrismaticJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t · λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
     Vec2 jv;
-    jv.x = Dot(t, bodyB->linearVelocity - bodyA->linearVelocity) + sb * bodyB->angularVelocity - sa * bodyA->angularVelocity;
-    jv.y = bodyB->angularVelocity - bodyA->angularVelocity;
+    jv.x = Dot(t, vB.v - vA.v) + sb * vB.w - sa * vA.w;
+    jv.y = vB.w - vA.w;
 
     Vec2 lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void PrismaticJoint::ApplyImpulse(const Vec2& lambda)
+void PrismaticJoint::ApplyImpulse(SolverBodies& bodies, const Vec2& lambda)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
     Vec2 p = t * lambda.x;
 
-    bodyA->linearVelocity -= p * bodyA->invMass;
-    bodyA->angularVelocity -= (lambda.x * sa + lambda.y) * bodyA->invInertia;
-    bodyB->linearVelocity += p * bodyB->invMass;
-    bodyB->angularVelocity += (lambda.x * sb + lambda.y) * bodyB->invInertia;
+    vA.v -= p * mA.invMass;
+    vA.w -= (lambda.x * sa + lambda.y) * mA.invInertia;
+    vB.v += p * mB.invMass;
+    vB.w += (lambda.x * sb + lambda.y) * mB.invInertia;
 }
 
 } // namespace muli
\ No newline at end of file
@@ -28,8 +28,13 @@ PulleyJoint::PulleyJoint(
     length = Dist(anchorA, groundAnchorA) + Dist(anchorB, groundAnchorB);
 }
 
-void PulleyJoint::Prepare(const Timestep& step)
+void PulleyJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -41,8 +46,8 @@ void PulleyJoint::Prepare(const Timestep& step)
     ra = Mul(bodyA->GetRotation(), localAnchorA - bodyA->sweep.localCenter);
     rb = Mul(bodyB->GetRotation(), localAnchorB - bodyB->sweep.localCenter);
 
-    ua = (bodyA->sweep.c + ra) - groundAnchorA;
-    ub = (bodyB->sweep.c + rb) - groundAnchorB;
+    ua = (pA.c + ra) - groundAnchorA;
+    ub = (pB.c + rb) - groundAnchorB;
 
     float lengthA = ua.Length();
     float lengthB = ub.Length();
@@ -69,8 +74,8 @@ void PulleyJoint::Prepare(const Timestep& step)
     float rub = Cross(rb, ub);
 
     // clang-format off
-    float k = bodyA->invMass + bodyA->invInertia * rua * rua
-            + (bodyB->invMass + bodyB->invInertia * rub * rub) * ratio * ratio
+    float k = mA.invMass + mA.invInertia * rua * rua
+            + (mB.invMass + mB.invInertia * rub * rub) * ratio * ratio
             + gamma;
     // clang-format on
 
@@ -84,40 +89,46 @@ void PulleyJoint::Prepare(const Timestep& step)
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void PulleyJoint::SolveVelocityConstraints(const Timestep& step)
+void PulleyJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t · λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    float jv =
-        -(ratio * (Dot(ub, bodyB->linearVelocity + Cross(bodyB->angularVelocity, rb))) +
-          Dot(ua, bodyA->linearVelocity + Cross(bodyA->angularVelocity, ra)));
+    float jv = -(ratio * (Dot(ub, vB.v + Cross(vB.w, rb))) + Dot(ua, vA.v + Cross(vA.w, ra)));
 
     float lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void PulleyJoint::ApplyImpulse(float lambda)
+void PulleyJoint::ApplyImpulse(SolverBodies& bodies, float lambda)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
     Vec2 pa = -lambda * ua;
     Vec2 pb = -ratio * lambda * ub;
 
-    bodyA->linearVelocity += pa * bodyA->invMass;
-    bodyA->angularVelocity += Cross(ra, pa) * bodyA->invInertia;
-    bodyB->linearVelocity += pb * bodyB->invMass;
-    bodyB->angularVelocity += Cross(rb, pb) * bodyB->invInertia;
+    vA.v += pa * mA.invMass;
+    vA.w += Cross(ra, pa) * mA.invInertia;
+    vB.v += pb * mB.invMass;
+    vB.w += Cross(rb, pb) * mB.invInertia;
 }
 
 } // namespace muli
\ No newline at end of file
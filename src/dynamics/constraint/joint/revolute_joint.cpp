@@ -14,8 +14,13 @@ RevoluteJoint::RevoluteJoint(
     localAnchorB = MulT(bodyB->GetTransform(), anchor);
 }
 
-void RevoluteJoint::Prepare(const Timestep& step)
+void RevoluteJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -27,57 +32,64 @@ void RevoluteJoint::Prepare(const Timestep& step)
 
     Mat2 k;
 
-    k[0][0] = bodyA->invMass + bodyB->invMass + bodyA->invInertia * ra.y * ra.y + bodyB->invInertia * rb.y * rb.y;
+    k[0][0] = mA.invMass + mB.invMass + mA.invInertia * ra.y * ra.y + mB.invInertia * rb.y * rb.y;
 
-    k[1][0] = -bodyA->invInertia * ra.y * ra.x - bodyB->invInertia * rb.y * rb.x;
-    k[0][1] = -bodyA->invInertia * ra.x * ra.y - bodyB->invInertia * rb.x * rb.y;
+    k[1][0] = -mA.invInertia * ra.y * ra.x - mB.invInertia * rb.y * rb.x;
+    k[0][1] = -mA.invInertia * ra.x * ra.y - mB.invInertia * rb.x * rb.y;
 
-    k[1][1] = bodyA->invMass + bodyB->invMass + bodyA->invInertia * ra.x * ra.x + bodyB->invInertia * rb.x * rb.x;
+    k[1][1] = mA.invMass + mB.invMass + mA.invInertia * ra.x * ra.x + mB.invInertia * rb.x * rb.x;
 
     k[0][0] += gamma;
     k[1][1] += gamma;
 
     m = k.GetInverse();
 
-    Vec2 pa = bodyA->sweep.c + ra;
-    Vec2 pb = bodyB->sweep.c + rb;
+    Vec2 pa = pA.c + ra;
+    Vec2 pb = pB.c + rb;
 
     Vec2 error = pb - pa;
     bias = error * beta * step.inv_dt;
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void RevoluteJoint::SolveVelocityConstraints(const Timestep& step)
+void RevoluteJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t * λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    Vec2 jv =
-        (bodyB->linearVelocity + Cross(bodyB->angularVelocity, rb)) - (bodyA->linearVelocity + Cross(bodyA->angularVelocity, ra));
+    Vec2 jv = (vB.v + Cross(vB.w, rb)) - (vA.v + Cross(vA.w, ra));
 
     // You don't have to clamp the impulse. It's equality constraint!
     Vec2 lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void RevoluteJoint::ApplyImpulse(const Vec2& lambda)
+void RevoluteJoint::ApplyImpulse(SolverBodies& bodies, const Vec2& lambda)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
-    bodyA->linearVelocity -= lambda * bodyA->invMass;
-    bodyA->angularVelocity -= bodyA->invInertia * Cross(ra, lambda);
-    bodyB->linearVelocity += lambda * bodyB->invMass;
-    bodyB->angularVelocity += bodyB->invInertia * Cross(rb, lambda);
+    vA.v -= lambda * mA.invMass;
+    vA.w -= mA.invInertia * Cross(ra, lambda);
+    vB.v += lambda * mB.invMass;
+    vB.w += mB.invInertia * Cross(rb, lambda);
 }
 
 } // namespace muli
\ No newline at end of file
@@ -18,8 +18,13 @@ WeldJoint::WeldJoint(
     angleOffset = bodyB->GetAngle() - bodyA->GetAngle();
 }
 
-void WeldJoint::Prepare(const Timestep& step)
+void WeldJoint::Prepare(const Timestep& step, SolverBodies& bodies)
 {
+    const SolverPosition& pA = bodies.positions[indexA];
+    const SolverPosition& pB = bodies.positions[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     ComputeBetaAndGamma(step);
 
     // Compute Jacobian J and effective mass M
@@ -34,18 +39,18 @@ void WeldJoint::Prepare(const Timestep& step)
 
     Mat3 k;
 
-    k[0][0] = bodyA->invMass + bodyB->invMass + bodyA->invInertia * ra.y * ra.y + bodyB->invInertia * rb.y * rb.y;
-    k[1][0] = -bodyA->invInertia * ra.y * ra.x - bodyB->invInertia * rb.y * rb.x;
+    k[0][0] = mA.invMass + mB.invMass + mA.invInertia * ra.y * ra.y + mB.invInertia * rb.y * rb.y;
+    k[1][0] = -mA.invInertia * ra.y * ra.x - mB.invInertia * rb.y * rb.x;
     k[0][1] = k[1][0];
-    k[1][1] = bodyA->invMass + bodyB->invMass + bodyA->invInertia * ra.x * ra.x + bodyB->invInertia * rb.x * rb.x;
+    k[1][1] = mA.invMass + mB.invMass + mA.invInertia * ra.x * ra.x + mB.invInertia * rb.x * rb.x;
 
-    k[2][0] = -bodyA->invInertia * ra.y - bodyB->invInertia * rb.y;
-    k[2][1] = bodyA->invInertia * ra.x + bodyB->invInertia * rb.x;
+    k[2][0] = -mA.invInertia * ra.y - mB.invInertia * rb.y;
+    k[2][1] = mA.invInertia * ra.x + mB.invInertia * rb.x;
 
     k[0][2] = k[2][0];
     k[1][2] = k[2][1];
 
-    k[2][2] = bodyA->invInertia + bodyB->invInertia;
+    k[2][2] = mA.invInertia + mB.invInertia;
 
     k[0][0] += gamma;
     k[1][1] += gamma;
@@ -53,41 +58,48 @@ void WeldJoint::Prepare(const Timestep& step)
 
     m = k.GetInverse();
 
-    Vec2 pa = bodyA->sweep.c + ra;
-    Vec2 pb = bodyB->sweep.c + rb;
+    Vec2 pa = pA.c + ra;
+    Vec2 pb = pB.c + rb;
 
     Vec2 error01 = pb - pa;
-    float error2 = bodyB->sweep.a - bodyA->sweep.a - angleOffset;
+    float error2 = pB.a - pA.a - angleOffset;
 
     bias.Set(error01.x, error01.y, error2);
     bias *= beta * step.inv_dt;
 
     if (step.warm_starting)
     {
-        ApplyImpulse(impulseSum);
+        ApplyImpulse(bodies, impulseSum);
     }
 }
 
-void WeldJoint::SolveVelocityConstraints(const Timestep& step)
+void WeldJoint::SolveVelocityConstraints(const Timestep& step, SolverBodies& bodies)
 {
     MuliNotUsed(step);
 
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+
     // Compute corrective impulse: Pc
     // Pc = J^t * λ (λ: lagrangian multiplier)
     // λ = (J · M^-1 · J^t)^-1 ⋅ -(J·v+b)
 
-    Vec3 jv = Vec2{ bodyB->linearVelocity + Cross(bodyB->angularVelocity, rb) -
-                    (bodyA->linearVelocity + Cross(bodyA->angularVelocity, ra)) };
-    jv.z = bodyB->angularVelocity - bodyA->angularVelocity;
+    Vec3 jv = Vec2{ vB.v + Cross(vB.w, rb) - (vA.v + Cross(vA.w, ra)) };
+    jv.z = vB.w - vA.w;
 
     Vec3 lambda = m * -(jv + bias + impulseSum * gamma);
 
-    ApplyImpulse(lambda);
+    ApplyImpulse(bodies, lambda);
     impulseSum += lambda;
 }
 
-void WeldJoint::ApplyImpulse(const Vec3& lambda)
+void WeldJoint::ApplyImpulse(SolverBodies& bodies, const Vec3& lambda)
 {
+    SolverVelocity& vA = bodies.velocities[indexA];
+    SolverVelocity& vB = bodies.velocities[indexB];
+    const SolverMass& mA = bodies.masses[indexA];
+    const SolverMass& mB = bodies.masses[indexB];
+
     // V2 = V2' + M^-1 ⋅ Pc
     // Pc = J^t ⋅ λ
 
@@ -95,20 +107,20 @@ void WeldJoint::ApplyImpulse(const Vec3& lambda)
     float lambda2 = lambda.z;
 
 #if 1 // Shortened
-    bodyA->linearVelocity -= lambda01 * bodyA->invMass;
-    bodyA->angularVelocity -= (Cross(ra, lambda01) + lambda2) * bodyA->invInertia;
-    bodyB->linearVelocity += lambda01 * bodyB->invMass;
-    bodyB->angularVelocity += (Cross(rb, lambda01) + lambda2) * bodyB->invInertia;
+    vA.v -= lambda01 * mA.invMass;
+    vA.w -= (Cross(ra, lambda01) + lambda2) * mA.invInertia;
+    vB.v += lambda01 * mB.invMass;
+    vB.w += (Cross(rb, lambda01) + lambda2) * mB.invInertia;
 #else
     // Solve for point-to-point constraint
-    bodyA->linearVelocity -= lambda01 * bodyA->invMass;
-    bodyA->angularVelocity -= Cross(ra, lambda01) * bodyA->invInertia;
-    bodyB->linearVelocity += lambda01 * bodyB->invMass;
-    bodyB->angularVelocity += Cross(rb, lambda01) * bodyB->invInertia;
+    vA.v -= lambda01 * mA.invMass;
+    vA.w -= Cross(ra, lambda01) * mA.invInertia;
+    vB.v += lambda01 * mB.invMass;
+    vB.w += Cross(rb, lambda01) * mB.invInertia;
 
     // Solve for angle constraint
-    bodyA->angularVelocity -= lambda2 * bodyA->invInertia;
-    bodyB->angularVelocity += lambda2 * bodyB->invInertia;
+    vA.w -= lambda2 * mA.invInertia;
+    vB.w += lambda2 * mB.invInertia;
 #endif
 }
 
@@ -4,15 +4,12 @@
 namespace muli
 {
 
-extern void InitializeDetectionFunctionMap();
-
 ContactManager::ContactManager(World* world)
     : world{ world }
     , broadPhase{ world, this }
     , contactList{ nullptr }
     , contactCount{ 0 }
 {
-    InitializeDetectionFunctionMap();
 }
 
 ContactManager::~ContactManager()
@@ -20,10 +17,54 @@ ContactManager::~ContactManager()
     MuliAssert(contactList == nullptr);
 }
 
+// Minimum number of contacts handed to a worker at once
+static constexpr int32 min_contact_task_range = 64;
+
+struct ContactUpdateContext
+{
+    ContactManager* contactManager;
+    Contact** contacts;
+    int32 touchingCounts[max_workers];
+    int32 reusedCounts[max_workers];
+};
+
+void ContactManager::UpdateContactTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    ContactUpdateContext* context = (ContactUpdateContext*)taskContext;
+    std::vector<ContactUpdate>& buffer = context->contactManager->updateBuffers[workerIndex];
+
+    int32 touchingCount = 0;
+    int32 reusedCount = 0;
+
+    for (int32 i = begin; i < end; ++i)
+    {
+        Contact* c = context->contacts[i];
+
+        bool wasTouching = c->IsTouching();
+        c->UpdateManifold();
+        bool touching = c->IsTouching();
+        touchingCount += int32(touching);
+        reusedCount += int32((c->flag & Contact::flag_reused) != 0);
+
+        // Record the state changes and the contacts listened by the user
+        if (touching != wasTouching || (touching && c->HasListener()))
+        {
+            buffer.push_back(ContactUpdate{ i, wasTouching });
+        }
+    }
+
+    context->touchingCounts[workerIndex] += touchingCount;
+    context->reusedCounts[workerIndex] += reusedCount;
+}
+
 void ContactManager::EvaluateContacts()
 {
-    // Narrow phase
-    // Evaluate contacts, prepare for solving step
+    // Contacts can be destroyed while gathering, so remember the capacity
+    int32 capacity = contactCount;
+    Contact** contacts = (Contact**)world->linearAllocator.Allocate(capacity * sizeof(Contact*));
+    int32 count = 0;
+
+    // Gather the contacts to evaluate
     Contact* c = contactList;
     while (c)
     {
@@ -53,52 +94,96 @@ void ContactManager::EvaluateContacts()
             continue;
         }
 
-        // Evaluate the contact, prepare the solve step
-        c->Update();
+        contacts[count++] = c;
         c = c->next;
     }
+
+    // Narrow phase
+    // Evaluate contacts in parallel, prepare for solving step
+    ContactUpdateContext context{ this, contacts, {} };
+    world->RunTask(UpdateContactTask, count, min_contact_task_range, &context);
+
+    // Report in contact order regardless of the worker that evaluated the contact
+    int32 workerCount = world->workerCount;
+
+    BroadPhaseStats& stats = broadPhase.stats;
+    stats.pairs = count;
+    stats.touchingPairs = 0;
+    stats.reusedPairs = 0;
+    for (int32 i = 0; i < workerCount; ++i)
+    {
+        stats.touchingPairs += context.touchingCounts[i];
+        stats.reusedPairs += context.reusedCounts[i];
+    }
+
+    std::vector<ContactUpdate>& updates = updateBuffers[0];
+    for (int32 i = 1; i < workerCount; ++i)
+    {
+        updates.insert(updates.end(), updateBuffers[i].begin(), updateBuffers[i].end());
+        updateBuffers[i].clear();
+    }
+
+    if (workerCount > 1)
+    {
+        std::sort(updates.begin(), updates.end(), [](const ContactUpdate& a, const ContactUpdate& b) { return a.index < b.index; });
+    }
+
+    for (const ContactUpdate& update : updates)
+    {
+        contacts[update.index]->ReportUpdate(update.wasTouching);
+    }
+    updates.clear();
+
+    world->linearAllocator.Free(contacts, capacity * sizeof(Contact*));
 }
 
-void ContactManager::OnNewContact(Collider* colliderA, Collider* colliderB)
+inline RigidBody* ContactManager::GetBody(Collider* collider) const
+{
+    // Colliders of the static scene are shared, so their contacts are attached to the scene body of this world
+    return collider->body->world == world ? collider->body : world->sceneBody;
+}
+
+bool ContactManager::ShouldCollide(Collider* colliderA, Collider* colliderB) const
 {
-    RigidBody* bodyA = colliderA->body;
-    RigidBody* bodyB = colliderB->body;
+    RigidBody* bodyA = GetBody(colliderA);
+    RigidBody* bodyB = GetBody(colliderB);
 
     MuliAssert(bodyA != bodyB);
     MuliAssert(colliderA->GetType() >= colliderB->GetType());
 
     if (bodyA->GetType() != RigidBody::Type::dynamic_body && bodyB->GetType() != RigidBody::Type::dynamic_body)
     {
-        return;
+        return false;
     }
 
     if (EvaluateFilter(colliderA->GetFilter(), colliderB->GetFilter()) == false)
     {
-        return;
+        return false;
     }
 
-    // TODO: Use hash set to remove potential bottleneck
-    ContactEdge* e = bodyB->contactList;
-    while (e)
+    // This contact already exists
+    if (contactPairs.Contains(colliderA, colliderB))
     {
-        if (e->other == bodyA)
-        {
-            Collider* ceA = e->contact->colliderA;
-            Collider* ceB = e->contact->colliderB;
-
-            // This contact already exists
-            if ((colliderA == ceA && colliderB == ceB) || (colliderA == ceB && colliderB == ceA))
-            {
-                return;
-            }
-        }
+        return false;
+    }
 
-        e = e->next;
+    return true;
+}
+
+void ContactManager::OnNewContact(Collider* colliderA, Collider* colliderB)
+{
+    if (ShouldCollide(colliderA, colliderB) == false)
+    {
+        return;
     }
 
+    RigidBody* bodyA = GetBody(colliderA);
+    RigidBody* bodyB = GetBody(colliderB);
+
     // Create new contact
     void* mem = world->blockAllocator.Allocate(sizeof(Contact));
-    Contact* c = new (mem) Contact(colliderA, colliderB);
+    Contact* c = new (mem) Contact(colliderA, colliderB, bodyA, bodyB);
+    contactPairs.Add(colliderA, colliderB);
 
     // Insert into the world
     c->prev = nullptr;
@@ -136,6 +221,7 @@ void ContactManager::OnNewContact(Collider* colliderA, Collider* colliderB)
     bodyB->contactList = &c->nodeB;
 
     ++contactCount;
+    ++broadPhase.stats.newPairs;
 }
 
 void ContactManager::Destroy(Contact* c)
@@ -143,6 +229,9 @@ void ContactManager::Destroy(Contact* c)
     RigidBody* bodyA = c->bodyA;
     RigidBody* bodyB = c->bodyB;
 
+    c->RemoveColor();
+    contactPairs.Remove(c->colliderA, c->colliderB);
+
     // Remove from the world
     if (c->prev) c->prev->next = c->next;
     if (c->next) c->next->prev = c->prev;
@@ -171,7 +260,6 @@ void ContactManager::AddCollider(Collider* collider)
 void ContactManager::RemoveCollider(Collider* collider)
 {
     broadPhase.Remove(collider);
-    collider->node = AABBTree::nullNode;
 
     RigidBody* body = collider->body;
 
@@ -187,10 +275,13 @@ void ContactManager::RemoveCollider(Collider* collider)
 
         if (collider == colliderA || collider == colliderB)
         {
+            RigidBody* bodyA = contact->bodyA;
+            RigidBody* bodyB = contact->bodyB;
+
             Destroy(contact);
 
-            colliderA->body->Awake();
-            colliderB->body->Awake();
+            bodyA->Awake();
+            bodyB->Awake();
         }
     }
 }
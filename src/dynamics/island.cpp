@@ -1,4 +1,5 @@
 #include "muli/island.h"
+#include "muli/wide_contact_solver.h"
 
 #define SOLVE_CONTACTS_BACKWARD 1
 #define SOLVE_CONTACT_CONSTRAINT 1
@@ -6,26 +7,134 @@
 namespace muli
 {
 
-Island::Island(World* world, int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity)
+// Minimum number of constraints handed to a worker at once
+static constexpr int32 min_color_task_range = 64;
+
+// Items of a color task are the wide contact batches of the color followed by its scalar constraints
+struct ColorTaskContext
+{
+    WideContactSolver* wideSolver;
+    int32 batchBegin;
+    int32 batchCount;
+    Constraint** constraints;
+    const Timestep* step;
+    SolverBodies* bodies;
+    bool solved[max_workers];
+};
+
+static void PrepareTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    MuliNotUsed(workerIndex);
+    ColorTaskContext* context = (ColorTaskContext*)taskContext;
+
+    for (int32 i = begin; i < end; ++i)
+    {
+        if (i < context->batchCount)
+        {
+            context->wideSolver->Prepare(context->batchBegin + i, *context->step, *context->bodies);
+        }
+        else
+        {
+            context->constraints[i - context->batchCount]->Prepare(*context->step, *context->bodies);
+        }
+    }
+}
+
+static void SolveVelocityTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    MuliNotUsed(workerIndex);
+    ColorTaskContext* context = (ColorTaskContext*)taskContext;
+
+    for (int32 i = begin; i < end; ++i)
+    {
+        if (i < context->batchCount)
+        {
+            context->wideSolver->SolveVelocityConstraints(context->batchBegin + i, *context->bodies);
+        }
+        else
+        {
+            context->constraints[i - context->batchCount]->SolveVelocityConstraints(*context->step, *context->bodies);
+        }
+    }
+}
+
+static void SolvePositionTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    ColorTaskContext* context = (ColorTaskContext*)taskContext;
+
+    bool solved = true;
+    for (int32 i = begin; i < end; ++i)
+    {
+        if (i < context->batchCount)
+        {
+            solved &= context->wideSolver->SolvePositionConstraints(context->batchBegin + i, *context->bodies);
+        }
+        else
+        {
+            solved &= context->constraints[i - context->batchCount]->SolvePositionConstraints(*context->step, *context->bodies);
+        }
+    }
+
+    context->solved[workerIndex] &= solved;
+}
+
+Island::Island(World* world, LinearAllocator* allocator, int32 bodyCapacity, int32 contactCapacity, int32 jointCapacity)
     : world{ world }
+    , allocator{ allocator }
+    , ownsStorage{ true }
     , bodyCapacity{ bodyCapacity }
     , contactCapacity{ contactCapacity }
     , jointCapacity{ jointCapacity }
     , bodyCount{ 0 }
     , contactCount{ 0 }
     , jointCount{ 0 }
+    , solverBodies{ nullptr, nullptr, nullptr }
+    , solverBodyCount{ 0 }
     , sleeping{ false }
+    , useWorkers{ false }
+{
+    bodies = (RigidBody**)allocator->Allocate(bodyCapacity * sizeof(RigidBody*));
+    contacts = (Contact**)allocator->Allocate(contactCapacity * sizeof(Contact*));
+    joints = (Joint**)allocator->Allocate(jointCapacity * sizeof(Joint*));
+}
+
+Island::Island(
+    World* world,
+    LinearAllocator* allocator,
+    RigidBody** bodies,
+    int32 bodyCount,
+    Contact** contacts,
+    int32 contactCount,
+    Joint** joints,
+    int32 jointCount
+)
+    : world{ world }
+    , allocator{ allocator }
+    , ownsStorage{ false }
+    , bodies{ bodies }
+    , contacts{ contacts }
+    , joints{ joints }
+    , bodyCapacity{ bodyCount }
+    , contactCapacity{ contactCount }
+    , jointCapacity{ jointCount }
+    , bodyCount{ bodyCount }
+    , contactCount{ contactCount }
+    , jointCount{ jointCount }
+    , solverBodies{ nullptr, nullptr, nullptr }
+    , solverBodyCount{ 0 }
+    , sleeping{ false }
+    , useWorkers{ false }
 {
-    bodies = (RigidBody**)world->linearAllocator.Allocate(bodyCapacity * sizeof(RigidBody*));
-    contacts = (Contact**)world->linearAllocator.Allocate(contactCapacity * sizeof(Contact*));
-    joints = (Joint**)world->linearAllocator.Allocate(jointCapacity * sizeof(Joint*));
 }
 
 Island::~Island()
 {
-    world->linearAllocator.Free(joints, jointCapacity * sizeof(Joint*));
-    world->linearAllocator.Free(contacts, contactCapacity * sizeof(Contact*));
-    world->linearAllocator.Free(bodies, bodyCapacity * sizeof(RigidBody*));
+    if (ownsStorage)
+    {
+        allocator->Free(joints, jointCapacity * sizeof(Joint*));
+        allocator->Free(contacts, contactCapacity * sizeof(Contact*));
+        allocator->Free(bodies, bodyCapacity * sizeof(RigidBody*));
+    }
 }
 
 void Island::Solve()
@@ -33,7 +142,7 @@ void Island::Solve()
     bool awakeIsland = false;
 
     const WorldSettings& settings = world->settings;
-    const Timestep& step = settings.step;
+    const Timestep& step = world->step;
 
     // Integrate velocities, yield tentative velocities that possibly violate the constraint
     for (int32 i = 0; i < bodyCount; ++i)
@@ -48,7 +157,6 @@ void Island::Solve()
         if (sleeping)
         {
             b->islandID = 0;
-            b->islandIndex = 0;
             b->linearVelocity.SetZero();
             b->angularVelocity = 0.0f;
             b->flag |= RigidBody::flag_sleeping;
@@ -95,16 +203,29 @@ void Island::Solve()
             b->linearVelocity *= 1.0f / (1.0f + b->linearDamping * step.dt);
             b->angularVelocity *= 1.0f / (1.0f + b->angularDamping * step.dt);
         }
+
+        b->force.SetZero();
+        b->torque = 0.0f;
+    }
+
+    LoadSolverBodies();
+
+    // Colors only pay off when they are spread over the workers, otherwise keep the sequential order
+    if (useWorkers || settings.wide_solver)
+    {
+        SolveColored();
+        StoreSolverBodies(awakeIsland);
+        return;
     }
 
     // Prepare constraints for solving step
     for (int32 i = 0; i < contactCount; ++i)
     {
-        contacts[i]->Prepare(step);
+        contacts[i]->Prepare(step, solverBodies);
     }
     for (int32 i = 0; i < jointCount; ++i)
     {
-        joints[i]->Prepare(step);
+        joints[i]->Prepare(step, solverBodies);
     }
 
     // Iteratively solve the violated velocity constraints
@@ -115,28 +236,148 @@ void Island::Solve()
 #if SOLVE_CONTACT_CONSTRAINT
         for (int32 j = contactCount; j > 0; j--)
         {
-            contacts[j - 1]->SolveVelocityConstraints(step);
+            contacts[j - 1]->SolveVelocityConstraints(step, solverBodies);
         }
 #endif
         for (int32 j = jointCount; j > 0; j--)
         {
-            joints[j - 1]->SolveVelocityConstraints(step);
+            joints[j - 1]->SolveVelocityConstraints(step, solverBodies);
         }
 #else
 #if SOLVE_CONTACT_CONSTRAINT
         for (int32 j = 0; j < contactCount; ++j)
         {
-            contacts[j]->SolveVelocityConstraints(step);
+            contacts[j]->SolveVelocityConstraints(step, solverBodies);
         }
 #endif
         for (int32 j = 0; j < jointCount; ++j)
         {
-            joints[j]->SolveVelocityConstraints(step);
+            joints[j]->SolveVelocityConstraints(step, solverBodies);
         }
 #endif
     }
 
-    // Update positions using corrected velocities (Semi-implicit euler integration)
+    IntegratePositions(step.dt);
+
+    // Solve position constraints
+    for (int32 i = 0; i < step.position_iterations; ++i)
+    {
+        bool contactSolved = true;
+        bool jointSolved = true;
+
+#if SOLVE_CONTACTS_BACKWARD
+#if SOLVE_CONTACT_CONSTRAINT
+        for (int32 j = contactCount; j > 0; j--)
+        {
+            contactSolved &= contacts[j - 1]->SolvePositionConstraints(step, solverBodies);
+        }
+#endif
+        for (int32 j = jointCount; j > 0; j--)
+        {
+            jointSolved &= joints[j - 1]->SolvePositionConstraints(step, solverBodies);
+        }
+#else
+#if SOLVE_CONTACT_CONSTRAINT
+        for (int32 j = 0; j < contactCount; ++j)
+        {
+            contactSolved &= contacts[j]->SolvePositionConstraints(step, solverBodies);
+        }
+#endif
+        for (int32 j = 0; j < jointCount; ++j)
+        {
+            jointSolved &= joints[j]->SolvePositionConstraints(step, solverBodies);
+        }
+#endif
+        if (contactSolved && jointSolved)
+        {
+            break;
+        }
+    }
+
+    StoreSolverBodies(awakeIsland);
+}
+
+// Update positions using corrected velocities (Semi-implicit euler integration)
+void Island::IntegratePositions(float dt)
+{
+    for (int32 i = 0; i < bodyCount; ++i)
+    {
+        solverBodies.positions[i].c += solverBodies.velocities[i].v * dt;
+        solverBodies.positions[i].a += solverBodies.velocities[i].w * dt;
+    }
+}
+
+// Copy the body state into the solver arrays and assign the solver indices of the constraints
+void Island::LoadSolverBodies()
+{
+    // Static bodies can be shared by islands solved in parallel, so they never live in the solver arrays
+    // Every constraint end on a static body gets its own copy instead
+    int32 staticCount = 0;
+    for (int32 i = 0; i < contactCount; ++i)
+    {
+        staticCount += contacts[i]->bodyA->type == RigidBody::Type::static_body;
+        staticCount += contacts[i]->bodyB->type == RigidBody::Type::static_body;
+    }
+    for (int32 i = 0; i < jointCount; ++i)
+    {
+        staticCount += joints[i]->bodyA->type == RigidBody::Type::static_body;
+        staticCount += joints[i]->bodyB->type == RigidBody::Type::static_body;
+    }
+
+    solverBodyCount = bodyCount + staticCount;
+    solverBodies.velocities = (SolverVelocity*)allocator->Allocate(solverBodyCount * sizeof(SolverVelocity));
+    solverBodies.positions = (SolverPosition*)allocator->Allocate(solverBodyCount * sizeof(SolverPosition));
+    solverBodies.masses = (SolverMass*)allocator->Allocate(solverBodyCount * sizeof(SolverMass));
+
+    for (int32 i = 0; i < bodyCount; ++i)
+    {
+        // Island views share the body array of the world island, so make the index local to this island
+        bodies[i]->islandIndex = i;
+        LoadSolverBody(i, bodies[i]);
+    }
+
+    int32 staticIndex = bodyCount;
+    for (int32 i = 0; i < contactCount; ++i)
+    {
+        contacts[i]->indexA = GetSolverIndex(contacts[i]->bodyA, &staticIndex);
+        contacts[i]->indexB = GetSolverIndex(contacts[i]->bodyB, &staticIndex);
+    }
+    for (int32 i = 0; i < jointCount; ++i)
+    {
+        joints[i]->indexA = GetSolverIndex(joints[i]->bodyA, &staticIndex);
+        joints[i]->indexB = GetSolverIndex(joints[i]->bodyB, &staticIndex);
+    }
+
+    MuliAssert(staticIndex == solverBodyCount);
+}
+
+void Island::LoadSolverBody(int32 index, const RigidBody* body)
+{
+    solverBodies.velocities[index].v = body->linearVelocity;
+    solverBodies.velocities[index].w = body->angularVelocity;
+    solverBodies.positions[index].c = body->sweep.c;
+    solverBodies.positions[index].a = body->sweep.a;
+    solverBodies.masses[index].invMass = body->invMass;
+    solverBodies.masses[index].invInertia = body->invInertia;
+}
+
+int32 Island::GetSolverIndex(RigidBody* body, int32* staticIndex)
+{
+    if (body->type != RigidBody::Type::static_body)
+    {
+        MuliAssert(body->islandIndex < bodyCount && bodies[body->islandIndex] == body);
+        return body->islandIndex;
+    }
+
+    int32 index = (*staticIndex)++;
+    LoadSolverBody(index, body);
+
+    return index;
+}
+
+// Write the solver results back to the bodies and release the solver arrays
+void Island::StoreSolverBodies(bool awakeIsland)
+{
     for (int32 i = 0; i < bodyCount; ++i)
     {
         RigidBody* b = bodies[i];
@@ -146,68 +387,186 @@ void Island::Solve()
             b->Awake();
         }
 
-        b->force.SetZero();
-        b->torque = 0.0f;
+        if (sleeping)
+        {
+            b->islandIndex = 0;
+        }
+
+        b->linearVelocity = solverBodies.velocities[i].v;
+        b->angularVelocity = solverBodies.velocities[i].w;
+        b->sweep.c = solverBodies.positions[i].c;
+        b->sweep.a = solverBodies.positions[i].a;
+    }
 
-        b->sweep.c += b->linearVelocity * step.dt;
-        b->sweep.a += b->angularVelocity * step.dt;
+    allocator->Free(solverBodies.masses, solverBodyCount * sizeof(SolverMass));
+    allocator->Free(solverBodies.positions, solverBodyCount * sizeof(SolverPosition));
+    allocator->Free(solverBodies.velocities, solverBodyCount * sizeof(SolverVelocity));
 
-        if (settings.world_bounds.TestPoint(b->GetPosition()) == false)
+    solverBodies = { nullptr, nullptr, nullptr };
+    solverBodyCount = 0;
+}
+
+// Constraints are grouped by their graph color and the colors are solved one after another
+// Constraints in the same color don't share any body, so they can be solved in parallel
+void Island::SolveColored()
+{
+    const Timestep& step = world->step;
+
+    // Colored contacts are packed into SIMD lanes when the wide solver is enabled
+    bool wide = world->settings.wide_solver;
+
+    // Counting sort by color, the last bucket holds the uncolored constraints
+    int32 colorOffsets[graph_color_count + 2] = { 0 };
+    int32 wideOffsets[graph_color_count + 1] = { 0 };
+    for (int32 i = 0; i < contactCount; ++i)
+    {
+        int32 color = contacts[i]->color;
+        if (wide && color < graph_color_count)
         {
-            world->BufferDestroy(b);
+            ++wideOffsets[color + 1];
+        }
+        else
+        {
+            ++colorOffsets[color + 1];
         }
     }
-
-    // Solve position constraints
-    for (int32 i = 0; i < settings.step.position_iterations; ++i)
+    for (int32 i = 0; i < jointCount; ++i)
     {
-        bool contactSolved = true;
-        bool jointSolved = true;
+        ++colorOffsets[joints[i]->color + 1];
+    }
+    for (int32 i = 0; i <= graph_color_count; ++i)
+    {
+        colorOffsets[i + 1] += colorOffsets[i];
+    }
+    for (int32 i = 0; i < graph_color_count; ++i)
+    {
+        wideOffsets[i + 1] += wideOffsets[i];
+    }
 
-#if SOLVE_CONTACTS_BACKWARD
-#if SOLVE_CONTACT_CONSTRAINT
-        for (int32 j = contactCount; j > 0; j--)
+    int32 wideCount = wideOffsets[graph_color_count];
+    int32 constraintCount = contactCount + jointCount - wideCount;
+
+    WideContactSolver wideSolver{ allocator, wideCount, wide ? graph_color_count : 0 };
+    Constraint** constraints = (Constraint**)allocator->Allocate(constraintCount * sizeof(Constraint*));
+    Contact** wideContacts = (Contact**)allocator->Allocate(wideCount * sizeof(Contact*));
+
+    int32 cursors[graph_color_count + 1];
+    int32 wideCursors[graph_color_count];
+    memcpy(cursors, colorOffsets, sizeof(cursors));
+    memcpy(wideCursors, wideOffsets, sizeof(wideCursors));
+    for (int32 i = 0; i < contactCount; ++i)
+    {
+        int32 color = contacts[i]->color;
+        if (wide && color < graph_color_count)
+        {
+            wideContacts[wideCursors[color]++] = contacts[i];
+        }
+        else
         {
-            Contact* c = contacts[j - 1];
+            constraints[cursors[color]++] = contacts[i];
+        }
+    }
+    for (int32 i = 0; i < jointCount; ++i)
+    {
+        constraints[cursors[joints[i]->color]++] = joints[i];
+    }
 
-            bool solved = c->SolvePositionConstraints(step);
-            if (solved == false)
-            {
-                c->b1->Awake();
-                c->b2->Awake();
-            }
+    int32 batchOffsets[graph_color_count + 1];
+    for (int32 i = 0; i < graph_color_count; ++i)
+    {
+        batchOffsets[i] = wideSolver.GetBatchCount();
+        wideSolver.AddContacts(wideContacts + wideOffsets[i], wideOffsets[i + 1] - wideOffsets[i]);
+    }
+    batchOffsets[graph_color_count] = wideSolver.GetBatchCount();
 
-            contactSolved &= solved;
+    allocator->Free(wideContacts, wideCount * sizeof(Contact*));
+
+    ColorTaskContext context;
+    context.wideSolver = &wideSolver;
+    context.step = &step;
+    context.bodies = &solverBodies;
+
+    SolveColors(PrepareTask, &context, constraints, colorOffsets, batchOffsets);
+
+    for (int32 i = 0; i < step.velocity_iterations; ++i)
+    {
+        SolveColors(SolveVelocityTask, &context, constraints, colorOffsets, batchOffsets);
+    }
+
+    for (int32 i = 0; i < wideSolver.GetBatchCount(); ++i)
+    {
+        wideSolver.StoreImpulses(i);
+    }
+
+    IntegratePositions(step.dt);
+
+    for (int32 i = 0; i < step.position_iterations; ++i)
+    {
+        for (int32 j = 0; j < world->workerCount; ++j)
+        {
+            context.solved[j] = true;
         }
-#endif
-        for (int32 j = jointCount; j > 0; j--)
+
+        SolveColors(SolvePositionTask, &context, constraints, colorOffsets, batchOffsets);
+
+        bool solved = true;
+        for (int32 j = 0; j < world->workerCount; ++j)
         {
-            jointSolved &= joints[j - 1]->SolvePositionConstraints(step);
+            solved &= context.solved[j];
         }
-#else
-#if SOLVE_CONTACT_CONSTRAINT
-        for (int32 j = 0; j < contactCount; ++j)
+
+        if (solved)
         {
-            Contact* c = contacts[j];
+            break;
+        }
+    }
+
+    allocator->Free(constraints, constraintCount * sizeof(Constraint*));
+}
 
-            bool solved = c->SolvePositionConstraints();
-            if (solved == false)
-            {
-                c->b1->Awake();
-                c->b2->Awake();
-            }
+void Island::SolveColors(
+    TaskFunction* task, ColorTaskContext* context, Constraint** constraints, const int32* colorOffsets, const int32* batchOffsets
+)
+{
+    for (int32 i = 0; i < graph_color_count; ++i)
+    {
+        context->constraints = constraints + colorOffsets[i];
+        context->batchBegin = batchOffsets[i];
+        context->batchCount = batchOffsets[i + 1] - batchOffsets[i];
+        int32 count = context->batchCount + colorOffsets[i + 1] - colorOffsets[i];
 
-            contactSolved &= solved;
+        if (useWorkers)
+        {
+            world->RunTask(task, count, min_color_task_range, context);
         }
-#endif
-        for (int32 j = 0; j < jointCount; ++j)
+        else
         {
-            jointSolved &= joints[j]->SolvePositionConstraints();
+            task(0, count, 0, context);
         }
-#endif
-        if (contactSolved && jointSolved)
+    }
+
+    // Uncolored constraints may share bodies
+    context->constraints = constraints + colorOffsets[graph_color_count];
+    context->batchBegin = 0;
+    context->batchCount = 0;
+    task(0, colorOffsets[graph_color_count + 1] - colorOffsets[graph_color_count], 0, context);
+}
+
+// Islands can be solved on worker threads, so anything that touches the world or calls back to the user is done here
+// This is called on the calling thread of World::Step() in island order
+void Island::Report()
+{
+    const WorldSettings& settings = world->settings;
+
+    for (int32 i = 0; i < bodyCount; ++i)
+    {
+        RigidBody* b = bodies[i];
+
+        // Transforms are synchronized after all islands are solved, so this tests the position at the beginning of the step
+        // just like the check that used to run in the position integration
+        if (settings.world_bounds.TestPoint(b->GetPosition()) == false)
         {
-            break;
+            world->BufferDestroy(b);
         }
     }
 
@@ -229,16 +588,17 @@ static constexpr int32 toi_index_2 = 1;
 
 void Island::SolveTOI(float dt)
 {
-    Timestep& step = world->settings.step;
-    bool warmStartingEnabled = step.warm_starting;
-
+    // Solve without warm starting, the impulses of the discrete solver are saved and restored
+    Timestep step = world->step;
     step.warm_starting = false;
 
+    LoadSolverBodies();
+
     for (int32 i = 0; i < contactCount; ++i)
     {
         // Save the impulses computed by the discrete solver
         contacts[i]->SaveImpulses();
-        contacts[i]->Prepare(step);
+        contacts[i]->Prepare(step, solverBodies);
     }
 
     // Move the TOI contact to a safe position so that the next ComputeTimeOfImpact() returns the separated state
@@ -248,7 +608,7 @@ void Island::SolveTOI(float dt)
 
         for (int32 j = 0; j < contactCount; ++j)
         {
-            solved &= contacts[j]->SolveTOIPositionConstraints();
+            solved &= contacts[j]->SolveTOIPositionConstraints(solverBodies);
         }
 
         if (solved)
@@ -257,10 +617,10 @@ void Island::SolveTOI(float dt)
         }
     }
 
-    bodies[toi_index_1]->sweep.c0 = bodies[toi_index_1]->sweep.c;
-    bodies[toi_index_1]->sweep.a0 = bodies[toi_index_1]->sweep.a;
-    bodies[toi_index_2]->sweep.c0 = bodies[toi_index_2]->sweep.c;
-    bodies[toi_index_2]->sweep.a0 = bodies[toi_index_2]->sweep.a;
+    bodies[toi_index_1]->sweep.c0 = solverBodies.positions[toi_index_1].c;
+    bodies[toi_index_1]->sweep.a0 = solverBodies.positions[toi_index_1].a;
+    bodies[toi_index_2]->sweep.c0 = solverBodies.positions[toi_index_2].c;
+    bodies[toi_index_2]->sweep.a0 = solverBodies.positions[toi_index_2].a;
 
     for (int32 i = 0; i < step.velocity_iterations; ++i)
     {
@@ -268,14 +628,14 @@ void Island::SolveTOI(float dt)
 #if SOLVE_CONTACT_CONSTRAINT
         for (int32 j = contactCount; j > 0; j--)
         {
-            contacts[j - 1]->SolveVelocityConstraints(step);
+            contacts[j - 1]->SolveVelocityConstraints(step, solverBodies);
         }
 #endif
 #else
 #if SOLVE_CONTACT_CONSTRAINT
         for (int32 j = 0; j < contactCount; ++j)
         {
-            contacts[j]->SolveVelocityConstraints(step);
+            contacts[j]->SolveVelocityConstraints(step, solverBodies);
         }
 #endif
 #endif
@@ -284,17 +644,14 @@ void Island::SolveTOI(float dt)
     // We don't need position correction
     // Because we solved velocity constraints in a position that is already safe
 
+    IntegratePositions(dt);
+    StoreSolverBodies(false);
+
     for (int32 i = 0; i < bodyCount; ++i)
     {
-        RigidBody* b = bodies[i];
-
-        b->sweep.c += b->linearVelocity * dt;
-        b->sweep.a += b->angularVelocity * dt;
-        b->SynchronizeTransform();
+        bodies[i]->SynchronizeTransform();
     }
 
-    step.warm_starting = warmStartingEnabled;
-
     for (int32 i = 0; i < contactCount; ++i)
     {
         Contact* contact = contacts[i];
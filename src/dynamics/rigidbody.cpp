@@ -26,6 +26,7 @@ RigidBody::RigidBody(RigidBody::Type type)
     , angularDamping{ 0.0f }
     , islandIndex{ 0 }
     , islandID{ 0 }
+    , colorMask{ 0 }
     , flag{ flag_enabled }
     , world{ nullptr }
     , prev{ nullptr }
@@ -321,6 +322,21 @@ void RigidBody::SetType(RigidBody::Type newType)
         return;
     }
 
+    // Constraint colors depend on the body type, so release them while the old type is still set
+    ContactEdge* ce = contactList;
+    while (ce)
+    {
+        ContactEdge* ce0 = ce;
+        ce = ce->next;
+        world->contactManager.Destroy(ce0->contact);
+    }
+    contactList = nullptr;
+
+    for (JointEdge* je = jointList; je; je = je->next)
+    {
+        je->joint->RemoveColor();
+    }
+
     type = newType;
 
     ResetMassData();
@@ -338,16 +354,12 @@ void RigidBody::SetType(RigidBody::Type newType)
 
     Awake();
 
-    // Refresh the broad phase contacts
-    ContactEdge* ce = contactList;
-    while (ce)
+    for (JointEdge* je = jointList; je; je = je->next)
     {
-        ContactEdge* ce0 = ce;
-        ce = ce->next;
-        world->contactManager.Destroy(ce0->contact);
+        je->joint->AddColor();
     }
-    contactList = nullptr;
 
+    // Refresh the broad phase contacts
     for (Collider* c = colliderList; c; c = c->next)
     {
         world->contactManager.broadPhase.Refresh(c);
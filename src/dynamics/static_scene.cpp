@@ -0,0 +1,101 @@
+#include "muli/static_scene.h"
+#include "muli/capsule.h"
+#include "muli/circle.h"
+#include "muli/polygon.h"
+#include "muli/world.h"
+
+namespace muli
+{
+
+StaticScene::StaticScene(const World& world)
+    : body{ RigidBody::Type::static_body }
+{
+    for (const RigidBody* b = world.GetBodyList(); b; b = b->GetNext())
+    {
+        if (b->GetType() != RigidBody::Type::static_body)
+        {
+            continue;
+        }
+
+        for (const Collider* c = b->GetColliderList(); c; c = c->GetNext())
+        {
+            AddCollider(c, b->GetTransform());
+        }
+    }
+
+    // The scene is only read from now on
+    wideTree.Build(tree);
+}
+
+StaticScene::~StaticScene() noexcept
+{
+    Collider* c = body.colliderList;
+    while (c)
+    {
+        Collider* c0 = c;
+        c = c->next;
+
+        c0->~Collider();
+        c0->Destroy(&blockAllocator);
+        blockAllocator.Free(c0, sizeof(Collider));
+    }
+
+    body.colliderList = nullptr;
+    body.colliderCount = 0;
+}
+
+void StaticScene::AddCollider(const Collider* source, const Transform& tf)
+{
+    void* mem = blockAllocator.Allocate(sizeof(Collider));
+    Collider* collider = new (mem) Collider;
+
+    const Shape* shape = source->GetShape();
+    float radius = shape->GetRadius();
+
+    // Bake the body transform into the shape, so every scene collider uses the identity transform of the scene body
+    switch (shape->GetType())
+    {
+    case Shape::Type::circle:
+    {
+        Circle circle{ radius, Mul(tf, shape->GetCenter()) };
+        collider->Create(&blockAllocator, &body, &circle, source->GetDensity(), source->GetMaterial());
+    }
+    break;
+    case Shape::Type::capsule:
+    {
+        const Capsule* capsule = (const Capsule*)shape;
+        Capsule baked{ Mul(tf, capsule->GetVertexA()), Mul(tf, capsule->GetVertexB()), radius, false };
+        collider->Create(&blockAllocator, &body, &baked, source->GetDensity(), source->GetMaterial());
+    }
+    break;
+    case Shape::Type::polygon:
+    {
+        int32 vertexCount = shape->GetVertexCount();
+        std::vector<Vec2> vertices(vertexCount);
+        for (int32 i = 0; i < vertexCount; ++i)
+        {
+            vertices[i] = Mul(tf, shape->GetVertex(i));
+        }
+
+        Polygon baked{ vertices.data(), vertexCount, false, radius };
+        collider->Create(&blockAllocator, &body, &baked, source->GetDensity(), source->GetMaterial());
+    }
+    break;
+    default:
+        MuliAssert(false);
+        break;
+    }
+
+    collider->filter = source->filter;
+    collider->enabled = source->enabled;
+    collider->ContactListener = source->ContactListener;
+
+    collider->next = body.colliderList;
+    body.colliderList = collider;
+    ++body.colliderCount;
+
+    collider->node = tree.CreateNode(collider, collider->GetAABB(), collider->filter.bit);
+    tree.ClearMoved(collider->node);
+}
+
+} // namespace muli
@@ -9,8 +9,11 @@
 namespace muli
 {
 
-World::World(const WorldSettings& settings)
+World::World(const WorldSettings& settings, const StaticScene* staticScene)
     : settings{ settings }
+    , step{}
+    , staticScene{ staticScene }
+    , sceneBody{ nullptr }
     , contactManager{ this }
     , bodyList{ nullptr }
     , bodyListTail{ nullptr }
@@ -20,16 +23,51 @@ World::World(const WorldSettings& settings)
     , islandCount{ 0 }
     , sleepingBodyCount{ 0 }
     , stepComplete{ true }
+    , toiStats{}
+    , workerCount{ 1 }
+    , workerAllocators{ nullptr }
+    , threadPool{ nullptr }
 {
     // Assertions for stable CCD
     MuliAssert(toi_position_solver_threshold < linear_slop * 2.0f);
     MuliAssert(default_radius >= toi_position_solver_threshold);
     MuliAssert(position_solver_threshold > toi_position_solver_threshold);
+
+    if (staticScene)
+    {
+        void* mem = muli::Alloc(sizeof(RigidBody));
+        sceneBody = new (mem) RigidBody(RigidBody::Type::static_body);
+        sceneBody->world = this;
+    }
+
+    UpdateWorkers();
 }
 
 World::~World() noexcept
 {
     Reset();
+
+    if (sceneBody)
+    {
+        MuliAssert(sceneBody->contactList == nullptr);
+        sceneBody->~RigidBody();
+        muli::Free(sceneBody);
+    }
+
+    if (threadPool)
+    {
+        threadPool->~ThreadPool();
+        muli::Free(threadPool);
+    }
+
+    if (workerAllocators)
+    {
+        for (int32 i = 0; i < workerCount; ++i)
+        {
+            workerAllocators[i].~LinearAllocator();
+        }
+        muli::Free(workerAllocators);
+    }
 }
 
 void World::Reset()
@@ -53,15 +91,136 @@ void World::Reset()
     destroyJointBuffer.clear();
 }
 
+void World::UpdateWorkers()
+{
+    int32 newWorkerCount = Clamp(settings.worker_count, 1, max_workers);
+
+    if (newWorkerCount != workerCount)
+    {
+        if (workerAllocators)
+        {
+            for (int32 i = 0; i < workerCount; ++i)
+            {
+                workerAllocators[i].~LinearAllocator();
+            }
+            muli::Free(workerAllocators);
+            workerAllocators = nullptr;
+        }
+
+        workerCount = newWorkerCount;
+
+        // Single worker runs everything on the calling thread with the world allocator
+        if (workerCount > 1)
+        {
+            workerAllocators = (LinearAllocator*)muli::Alloc(workerCount * sizeof(LinearAllocator));
+            for (int32 i = 0; i < workerCount; ++i)
+            {
+                new (workerAllocators + i) LinearAllocator;
+            }
+        }
+    }
+
+    // Run the built-in thread pool only if the user didn't provide the task system
+    int32 poolWorkerCount = settings.enqueue_task == nullptr ? workerCount : 1;
+    int32 currentPoolWorkerCount = threadPool ? threadPool->GetWorkerCount() : 1;
+
+    if (poolWorkerCount != currentPoolWorkerCount)
+    {
+        if (threadPool)
+        {
+            threadPool->~ThreadPool();
+            muli::Free(threadPool);
+            threadPool = nullptr;
+        }
+
+        if (poolWorkerCount > 1)
+        {
+            threadPool = new (muli::Alloc(sizeof(ThreadPool))) ThreadPool(poolWorkerCount);
+        }
+    }
+}
+
+void World::RunTask(TaskFunction* task, int32 itemCount, int32 minRange, void* taskContext)
+{
+    if (itemCount <= 0)
+    {
+        return;
+    }
+
+    if (settings.enqueue_task)
+    {
+        MuliAssert(settings.finish_task != nullptr);
+
+        void* userTask = settings.enqueue_task(task, itemCount, minRange, taskContext, settings.user_task_context);
+        if (userTask)
+        {
+            settings.finish_task(userTask, settings.user_task_context);
+        }
+    }
+    else if (threadPool)
+    {
+        threadPool->Finish(threadPool->Enqueue(task, itemCount, minRange, taskContext));
+    }
+    else
+    {
+        task(0, itemCount, 0, taskContext);
+    }
+}
+
+struct IslandSolveContext
+{
+    World* world;
+    Island* island;
+    IslandRange* ranges;
+};
+
+void World::SolveIslandTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    IslandSolveContext* context = (IslandSolveContext*)taskContext;
+    World* world = context->world;
+    Island* island = context->island;
+
+    for (int32 i = begin; i < end; ++i)
+    {
+        const IslandRange& range = context->ranges[i];
+
+        // Solved later with all workers
+        if (range.useWorkers)
+        {
+            continue;
+        }
+
+        Island view{ world,
+                     world->workerAllocators + workerIndex,
+                     island->bodies + range.bodyBegin,
+                     range.bodyCount,
+                     island->contacts + range.contactBegin,
+                     range.contactCount,
+                     island->joints + range.jointBegin,
+                     range.jointCount };
+        view.sleeping = range.sleeping;
+        view.Solve();
+    }
+}
+
 void World::Solve()
 {
     // Build the constraint island
-    Island island{ this, bodyCount, contactManager.contactCount, jointCount };
+    Island island{ this, &linearAllocator, bodyCount, contactManager.contactCount, jointCount };
 
     int32 restingBodies = 0;
     int32 islandID = 0;
     sleepingBodyCount = 0;
 
+    // Islands are collected first and then solved in parallel if we have multiple workers
+    // Otherwise each island is solved right after it's built
+    bool parallel = workerCount > 1;
+    IslandRange* ranges = nullptr;
+    if (parallel)
+    {
+        ranges = (IslandRange*)linearAllocator.Allocate(bodyCount * sizeof(IslandRange));
+    }
+
     // Use arena allocator to avoid per-frame allocation
     RigidBody** stack = (RigidBody**)linearAllocator.Allocate(bodyCount * sizeof(RigidBody*));
     int32 stackPointer;
@@ -95,6 +254,10 @@ void World::Solve()
         stack[stackPointer++] = b;
         b->flag |= RigidBody::flag_island;
 
+        int32 bodyBegin = island.bodyCount;
+        int32 contactBegin = island.contactCount;
+        int32 jointBegin = island.jointCount;
+
         ++islandID;
         while (stackPointer > 0)
         {
@@ -182,16 +345,81 @@ void World::Solve()
             }
         }
 
-        island.sleeping = settings.sleeping && (restingBodies == island.bodyCount);
-        island.Solve();
-        island.Clear();
+        bool sleeping = settings.sleeping && (restingBodies == island.bodyCount - bodyBegin);
         restingBodies = 0;
+
+        if (parallel)
+        {
+            IslandRange& range = ranges[islandID - 1];
+            range.bodyBegin = bodyBegin;
+            range.bodyCount = island.bodyCount - bodyBegin;
+            range.contactBegin = contactBegin;
+            range.contactCount = island.contactCount - contactBegin;
+            range.jointBegin = jointBegin;
+            range.jointCount = island.jointCount - jointBegin;
+            range.sleeping = sleeping;
+            range.useWorkers =
+                settings.graph_coloring && (range.contactCount + range.jointCount >= graph_coloring_threshold) && sleeping == false;
+        }
+        else
+        {
+            island.sleeping = sleeping;
+            island.Solve();
+            island.Report();
+            island.Clear();
+        }
     }
 
     linearAllocator.Free(stack, bodyCount * sizeof(RigidBody*));
 
     islandCount = islandID;
 
+    if (parallel)
+    {
+        IslandSolveContext context{ this, &island, ranges };
+        RunTask(SolveIslandTask, islandCount, 1, &context);
+
+        // Large islands are split into graph colors and solved one by one with all workers
+        for (int32 i = 0; i < islandCount; ++i)
+        {
+            const IslandRange& range = ranges[i];
+            if (range.useWorkers == false)
+            {
+                continue;
+            }
+
+            Island view{ this,
+                         &linearAllocator,
+                         island.bodies + range.bodyBegin,
+                         range.bodyCount,
+                         island.contacts + range.contactBegin,
+                         range.contactCount,
+                         island.joints + range.jointBegin,
+                         range.jointCount };
+            view.sleeping = range.sleeping;
+            view.useWorkers = true;
+            view.Solve();
+        }
+
+        // Report in island order to keep the callbacks and the destroy buffer deterministic
+        for (int32 i = 0; i < islandCount; ++i)
+        {
+            const IslandRange& range = ranges[i];
+
+            Island view{ this,
+                         &linearAllocator,
+                         island.bodies + range.bodyBegin,
+                         range.bodyCount,
+                         island.contacts + range.contactBegin,
+                         range.contactCount,
+                         island.joints + range.jointBegin,
+                         range.jointCount };
+            view.Report();
+        }
+
+        linearAllocator.Free(ranges, bodyCount * sizeof(IslandRange));
+    }
+
     for (RigidBody* body = bodyList; body; body = body->next)
     {
         MuliAssert(body->sweep.alpha0 == 0.0f);
@@ -225,7 +453,7 @@ void World::Solve()
 // Find TOI contacts and solve them
 float World::SolveTOI()
 {
-    Island island{ this, 2 * max_toi_contacts, max_toi_contacts, 0 };
+    Island island{ this, &linearAllocator, 2 * max_toi_contacts, max_toi_contacts, 0 };
 
     while (true)
     {
@@ -264,8 +492,8 @@ float World::SolveTOI()
                     continue;
                 }
 
-                RigidBody* bodyA = colliderA->body;
-                RigidBody* bodyB = colliderB->body;
+                RigidBody* bodyA = c->bodyA;
+                RigidBody* bodyB = c->bodyB;
 
                 RigidBody::Type typeA = bodyA->type;
                 RigidBody::Type typeB = bodyB->type;
@@ -307,7 +535,13 @@ float World::SolveTOI()
                 MuliAssert(alpha0 < 1.0f);
 
                 TOIOutput output;
-                ComputeTimeOfImpact(colliderA->shape, bodyA->sweep, colliderB->shape, bodyB->sweep, 1.0f, &output);
+                ComputeTimeOfImpact(
+                    colliderA->shape, bodyA->sweep, colliderB->shape, bodyB->sweep, 1.0f, &output, &c->simplexCache
+                );
+
+                ++toiStats.toiCalls;
+                toiStats.gjkCalls += output.gjkCalls;
+                toiStats.gjkIterations += output.gjkIterations;
 
 #if 0
                 switch (output.state)
@@ -365,10 +599,8 @@ float World::SolveTOI()
         }
 
         // Advance the bodies to the TOI
-        Collider* colliderA = minContact->colliderA;
-        Collider* colliderB = minContact->colliderB;
-        RigidBody* bodyA = colliderA->body;
-        RigidBody* bodyB = colliderB->body;
+        RigidBody* bodyA = minContact->bodyA;
+        RigidBody* bodyB = minContact->bodyB;
 
         Sweep save1 = bodyA->sweep;
         Sweep save2 = bodyB->sweep;
@@ -483,6 +715,7 @@ float World::SolveTOI()
                 }
 
                 island.Add(other);
+                other->flag |= RigidBody::flag_island;
 
                 // Awake linked bodies
                 for (ContactEdge* oce = other->contactList; oce; oce = oce->next)
@@ -493,7 +726,7 @@ float World::SolveTOI()
         }
 
         // step the rest time
-        float dt = (1.0f - minAlpha) * settings.step.dt;
+        float dt = (1.0f - minAlpha) * step.dt;
         island.SolveTOI(dt);
 
         // Reset island flags and synchronize broad-phase collider node
@@ -532,6 +765,12 @@ float World::SolveTOI()
         body->flag &= ~RigidBody::flag_island;
     }
 
+    if (sceneBody)
+    {
+        sceneBody->sweep.alpha0 = 0.0f;
+        sceneBody->flag &= ~RigidBody::flag_island;
+    }
+
     for (Contact* contact = contactManager.contactList; contact; contact = contact->next)
     {
         contact->flag &= ~(Contact::flag_toi | Contact::flag_island);
@@ -544,16 +783,29 @@ float World::SolveTOI()
 
 float World::Step(float dt)
 {
-    settings.step.dt = dt;
-    settings.step.inv_dt = dt > 0.0f ? 1.0f / dt : 0.0f;
+    step = settings.step;
+    step.dt = dt;
+    step.inv_dt = dt > 0.0f ? 1.0f / dt : 0.0f;
 
-    if (settings.step.inv_dt == 0.0f)
+    if (step.inv_dt == 0.0f)
     {
         return 0.0f;
     }
 
+    UpdateWorkers();
+
     // Grow the allocator buffer size if needed
     linearAllocator.GrowMemory();
+    if (workerAllocators)
+    {
+        for (int32 i = 0; i < workerCount; ++i)
+        {
+            workerAllocators[i].GrowMemory();
+        }
+    }
+
+    contactManager.broadPhase.stats = BroadPhaseStats{};
+    toiStats = TOIStats{};
 
     if (stepComplete)
     {
@@ -572,14 +824,8 @@ float World::Step(float dt)
         progress = SolveTOI();
     }
 
-    for (RigidBody* b : destroyBodyBuffer)
-    {
-        Destroy(b);
-    }
-    for (Joint* j : destroyJointBuffer)
-    {
-        Destroy(j);
-    }
+    Destroy(destroyBodyBuffer);
+    Destroy(destroyJointBuffer);
 
     destroyBodyBuffer.clear();
     destroyJointBuffer.clear();
@@ -621,14 +867,27 @@ void World::Destroy(RigidBody* body)
 void World::Destroy(std::span<RigidBody*> bodies)
 {
     std::unordered_set<RigidBody*> destroyed;
+    std::vector<Collider*> colliders;
 
-    for (size_t i = 0; i < bodies.size(); ++i)
+    for (RigidBody* b : bodies)
     {
-        RigidBody* b = bodies[i];
+        if (destroyed.insert(b).second)
+        {
+            for (Collider* c = b->colliderList; c; c = c->next)
+            {
+                colliders.push_back(c);
+            }
+        }
+    }
+
+    // Remove all proxies from the broad phase at once, instead of refitting the tree for each of them
+    contactManager.broadPhase.Remove(colliders);
 
-        if (destroyed.find(b) != destroyed.end())
+    // Destroy each body once, in the given order
+    for (RigidBody* b : bodies)
+    {
+        if (destroyed.erase(b))
         {
-            destroyed.insert(b);
             Destroy(b);
         }
     }
@@ -652,6 +911,8 @@ void World::Destroy(Joint* joint)
     RigidBody* bodyA = joint->bodyA;
     RigidBody* bodyB = joint->bodyB;
 
+    joint->RemoveColor();
+
     // Remove from the world
     if (joint->prev) joint->prev->next = joint->next;
     if (joint->next) joint->next->prev = joint->prev;
@@ -678,13 +939,10 @@ void World::Destroy(std::span<Joint*> joints)
 {
     std::unordered_set<Joint*> destroyed;
 
-    for (size_t i = 0; i < joints.size(); ++i)
+    for (Joint* j : joints)
     {
-        Joint* j = joints[i];
-
-        if (destroyed.find(j) != destroyed.end())
+        if (destroyed.insert(j).second)
         {
-            destroyed.insert(j);
             Destroy(j);
         }
     }
@@ -703,12 +961,13 @@ void World::BufferDestroy(std::span<Joint*> joints)
     }
 }
 
-void World::Query(const Vec2& point, std::function<bool(Collider* collider)> callback) const
+void World::Query(const Vec2& point, std::function<bool(Collider* collider)> callback, uint32 categoryMask) const
 {
     struct TempCallback
     {
         Vec2 point;
         decltype(callback)& callbackFcn;
+        bool proceed = true;
 
         TempCallback(Vec2 point, decltype(callback)& callback)
             : point{ point }
@@ -728,7 +987,8 @@ void World::Query(const Vec2& point, std::function<bool(Collider* collider)> cal
 
             if (collider->TestPoint(point))
             {
-                return callbackFcn(collider);
+                proceed = callbackFcn(collider);
+                return proceed;
             }
 
             return true;
@@ -737,15 +997,16 @@ void World::Query(const Vec2& point, std::function<bool(Collider* collider)> cal
 
     tempCallback.point = point;
 
-    contactManager.broadPhase.tree.Query(point, &tempCallback);
+    contactManager.broadPhase.Query(point, &tempCallback, categoryMask);
 }
 
-void World::Query(const AABB& aabb, std::function<bool(Collider* collider)> callback) const
+void World::Query(const AABB& aabb, std::function<bool(Collider* collider)> callback, uint32 categoryMask) const
 {
     struct TempCallback
     {
         Polygon box;
         decltype(callback)& callbackFcn;
+        bool proceed = true;
 
         TempCallback(const AABB& aabb, decltype(callback)& callback)
             : box{ { aabb.min, { aabb.max.x, aabb.min.y }, aabb.max, { aabb.min.x, aabb.max.y } }, false, 0.0f }
@@ -765,22 +1026,24 @@ void World::Query(const AABB& aabb, std::function<bool(Collider* collider)> call
 
             if (Collide(collider->shape, collider->body->transform, &box, identity))
             {
-                return callbackFcn(collider);
+                proceed = callbackFcn(collider);
+                return proceed;
             }
 
             return true;
         }
     } tempCallback(aabb, callback);
 
-    contactManager.broadPhase.tree.Query(aabb, &tempCallback);
+    contactManager.broadPhase.Query(aabb, &tempCallback, categoryMask);
 }
 
-void World::Query(const Vec2& point, WorldQueryCallback* callback)
+void World::Query(const Vec2& point, WorldQueryCallback* callback, uint32 categoryMask)
 {
     struct TempCallback
     {
         Vec2 point;
         WorldQueryCallback* callback;
+        bool proceed = true;
 
         bool QueryCallback(NodeProxy node, Collider* collider)
         {
@@ -794,7 +1057,8 @@ void World::Query(const Vec2& point, WorldQueryCallback* callback)
 
             if (collider->TestPoint(point))
             {
-                return callback->OnQuery(collider);
+                proceed = callback->OnQuery(collider);
+                return proceed;
             }
 
             return true;
@@ -804,10 +1068,10 @@ void World::Query(const Vec2& point, WorldQueryCallback* callback)
     tempCallback.point = point;
     tempCallback.callback = callback;
 
-    contactManager.broadPhase.tree.Query(point, &tempCallback);
+    contactManager.broadPhase.Query(point, &tempCallback, categoryMask);
 }
 
-void World::Query(const AABB& aabb, WorldQueryCallback* callback)
+void World::Query(const AABB& aabb, WorldQueryCallback* callback, uint32 categoryMask)
 {
     Vec2 vertices[4] = { aabb.min, { aabb.max.x, aabb.min.y }, aabb.max, { aabb.min.x, aabb.max.y } };
     Polygon box{ vertices, 4, false, 0.0f };
@@ -817,6 +1081,7 @@ void World::Query(const AABB& aabb, WorldQueryCallback* callback)
         Polygon region;
         WorldQueryCallback* callback;
         Transform t{ identity };
+        bool proceed = true;
 
         TempCallback(const Polygon& box)
             : region{ box }
@@ -835,7 +1100,8 @@ void World::Query(const AABB& aabb, WorldQueryCallback* callback)
 
             if (Collide(collider->shape, collider->body->transform, &region, t))
             {
-                return callback->OnQuery(collider);
+                proceed = callback->OnQuery(collider);
+                return proceed;
             }
 
             return true;
@@ -844,10 +1110,12 @@ void World::Query(const AABB& aabb, WorldQueryCallback* callback)
 
     tempCallback.callback = callback;
 
-    contactManager.broadPhase.tree.Query(aabb, &tempCallback);
+    contactManager.broadPhase.Query(aabb, &tempCallback, categoryMask);
 }
 
-void World::RayCastAny(const Vec2& from, const Vec2& to, float radius, RayCastAnyCallback* callback)
+void World::RayCastAny(
+    const Vec2& from, const Vec2& to, float radius, RayCastAnyCallback* callback, uint32 categoryMask
+)
 {
     AABBCastInput input;
     input.from = from;
@@ -858,6 +1126,17 @@ void World::RayCastAny(const Vec2& from, const Vec2& to, float radius, RayCastAn
     struct TempCallback
     {
         RayCastAnyCallback* callback;
+        float maxFraction = 1.0f;
+
+        float ClipFraction(float newFraction)
+        {
+            if (newFraction >= 0.0f)
+            {
+                maxFraction = newFraction;
+            }
+
+            return newFraction;
+        }
 
         float AABBCastCallback(const AABBCastInput& subInput, Collider* collider)
         {
@@ -875,7 +1154,7 @@ void World::RayCastAny(const Vec2& from, const Vec2& to, float radius, RayCastAn
                 float fraction = output.fraction;
                 Vec2 point = (1.0f - fraction) * input.from + fraction * input.to;
 
-                return callback->OnHitAny(collider, point, output.normal, fraction);
+                return ClipFraction(callback->OnHitAny(collider, point, output.normal, fraction));
             }
 
             return input.maxFraction;
@@ -884,10 +1163,12 @@ void World::RayCastAny(const Vec2& from, const Vec2& to, float radius, RayCastAn
 
     tempCallback.callback = callback;
 
-    contactManager.broadPhase.tree.AABBCast(input, &tempCallback);
+    contactManager.broadPhase.AABBCast(input, &tempCallback, categoryMask);
 }
 
-bool World::RayCastClosest(const Vec2& from, const Vec2& to, float radius, RayCastClosestCallback* callback)
+bool World::RayCastClosest(
+    const Vec2& from, const Vec2& to, float radius, RayCastClosestCallback* callback, uint32 categoryMask
+)
 {
     struct TempCallback : public RayCastAnyCallback
     {
@@ -909,7 +1190,7 @@ bool World::RayCastClosest(const Vec2& from, const Vec2& to, float radius, RayCa
         }
     } tempCallback;
 
-    RayCastAny(from, to, radius, &tempCallback);
+    RayCastAny(from, to, radius, &tempCallback, categoryMask);
 
     if (tempCallback.hit)
     {
@@ -922,7 +1203,9 @@ bool World::RayCastClosest(const Vec2& from, const Vec2& to, float radius, RayCa
     return false;
 }
 
-void World::ShapeCastAny(const Shape* shape, const Transform& tf, const Vec2& translation, ShapeCastAnyCallback* callback)
+void World::ShapeCastAny(
+    const Shape* shape, const Transform& tf, const Vec2& translation, ShapeCastAnyCallback* callback, uint32 categoryMask
+)
 {
     AABB aabb;
     shape->ComputeAABB(tf, &aabb);
@@ -939,6 +1222,17 @@ void World::ShapeCastAny(const Shape* shape, const Transform& tf, const Vec2& tr
         const Shape* shape;
         Transform tf;
         Vec2 translation;
+        float maxFraction = 1.0f;
+
+        float ClipFraction(float newFraction)
+        {
+            if (newFraction >= 0.0f)
+            {
+                maxFraction = newFraction;
+            }
+
+            return newFraction;
+        }
 
         float AABBCastCallback(const AABBCastInput& input, Collider* collider)
         {
@@ -950,7 +1244,7 @@ void World::ShapeCastAny(const Shape* shape, const Transform& tf, const Vec2& tr
             );
             if (hit)
             {
-                return callback->OnHitAny(collider, output.point, output.normal, output.t * input.maxFraction);
+                return ClipFraction(callback->OnHitAny(collider, output.point, output.normal, output.t * input.maxFraction));
             }
 
             return input.maxFraction;
@@ -962,10 +1256,16 @@ void World::ShapeCastAny(const Shape* shape, const Transform& tf, const Vec2& tr
     tempCallback.tf = tf;
     tempCallback.translation = translation;
 
-    contactManager.broadPhase.tree.AABBCast(input, &tempCallback);
+    contactManager.broadPhase.AABBCast(input, &tempCallback, categoryMask);
 }
 
-bool World::ShapeCastClosest(const Shape* shape, const Transform& tf, const Vec2& translation, ShapeCastClosestCallback* callback)
+bool World::ShapeCastClosest(
+    const Shape* shape,
+    const Transform& tf,
+    const Vec2& translation,
+    ShapeCastClosestCallback* callback,
+    uint32 categoryMask
+)
 {
     struct TempCallback : ShapeCastAnyCallback
     {
@@ -987,7 +1287,7 @@ bool World::ShapeCastClosest(const Shape* shape, const Transform& tf, const Vec2
         }
     } tempCallback;
 
-    ShapeCastAny(shape, tf, translation, &tempCallback);
+    ShapeCastAny(shape, tf, translation, &tempCallback, categoryMask);
 
     if (tempCallback.hit)
     {
@@ -1004,7 +1304,8 @@ void World::RayCastAny(
     const Vec2& from,
     const Vec2& to,
     float radius,
-    std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback
+    std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback,
+    uint32 categoryMask
 )
 {
     AABBCastInput input;
@@ -1016,12 +1317,23 @@ void World::RayCastAny(
     struct TempCallback
     {
         decltype(callback)& callbackFcn;
+        float maxFraction = 1.0f;
 
         TempCallback(decltype(callback)& callback)
             : callbackFcn{ callback }
         {
         }
 
+        float ClipFraction(float newFraction)
+        {
+            if (newFraction >= 0.0f)
+            {
+                maxFraction = newFraction;
+            }
+
+            return newFraction;
+        }
+
         float AABBCastCallback(const AABBCastInput& subInput, Collider* collider)
         {
             RayCastInput input;
@@ -1038,21 +1350,22 @@ void World::RayCastAny(
                 float fraction = output.fraction;
                 Vec2 point = (1.0f - fraction) * input.from + fraction * input.to;
 
-                return callbackFcn(collider, point, output.normal, fraction);
+                return ClipFraction(callbackFcn(collider, point, output.normal, fraction));
             }
 
             return input.maxFraction;
         }
     } tempCallback(callback);
 
-    contactManager.broadPhase.tree.AABBCast(input, &tempCallback);
+    contactManager.broadPhase.AABBCast(input, &tempCallback, categoryMask);
 }
 
 bool World::RayCastClosest(
     const Vec2& from,
     const Vec2& to,
     float radius,
-    std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback
+    std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float fraction)> callback,
+    uint32 categoryMask
 )
 {
     struct TempCallback : public RayCastAnyCallback
@@ -1075,7 +1388,7 @@ bool World::RayCastClosest(
         }
     } tempCallback;
 
-    RayCastAny(from, to, radius, &tempCallback);
+    RayCastAny(from, to, radius, &tempCallback, categoryMask);
 
     if (tempCallback.hit)
     {
@@ -1092,7 +1405,8 @@ void World::ShapeCastAny(
     const Shape* shape,
     const Transform& tf,
     const Vec2& translation,
-    std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback
+    std::function<float(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback,
+    uint32 categoryMask
 )
 {
     AABB aabb;
@@ -1110,6 +1424,7 @@ void World::ShapeCastAny(
         const Shape* shape;
         Transform tf;
         Vec2 translation;
+        float maxFraction = 1.0f;
 
         TempCallback(decltype(callback)& callback, const Shape* shape, Transform tf, Vec2 translation)
             : callbackFcn{ callback }
@@ -1119,6 +1434,16 @@ void World::ShapeCastAny(
         {
         }
 
+        float ClipFraction(float newFraction)
+        {
+            if (newFraction >= 0.0f)
+            {
+                maxFraction = newFraction;
+            }
+
+            return newFraction;
+        }
+
         float AABBCastCallback(const AABBCastInput& input, Collider* collider)
         {
             ShapeCastOutput output;
@@ -1129,21 +1454,22 @@ void World::ShapeCastAny(
             );
             if (hit)
             {
-                return callbackFcn(collider, output.point, output.normal, output.t * input.maxFraction);
+                return ClipFraction(callbackFcn(collider, output.point, output.normal, output.t * input.maxFraction));
             }
 
             return input.maxFraction;
         }
     } tempCallback(callback, shape, tf, translation);
 
-    contactManager.broadPhase.tree.AABBCast(input, &tempCallback);
+    contactManager.broadPhase.AABBCast(input, &tempCallback, categoryMask);
 }
 
 bool World::ShapeCastClosest(
     const Shape* shape,
     const Transform& tf,
     const Vec2& translation,
-    std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback
+    std::function<void(Collider* collider, const Vec2& point, const Vec2& normal, float t)> callback,
+    uint32 categoryMask
 )
 {
     struct TempCallback : ShapeCastAnyCallback
@@ -1166,7 +1492,7 @@ bool World::ShapeCastClosest(
         }
     } tempCallback;
 
-    ShapeCastAny(shape, tf, translation, &tempCallback);
+    ShapeCastAny(shape, tf, translation, &tempCallback, categoryMask);
 
     if (tempCallback.hit)
     {
@@ -1640,6 +1966,8 @@ void World::AddJoint(Joint* joint)
         joint->bodyB->jointList = &joint->nodeB;
     }
 
+    joint->AddColor();
+
     ++jointCount;
 }
 
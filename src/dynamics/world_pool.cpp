@@ -0,0 +1,42 @@
+#include "muli/world_pool.h"
+
+namespace muli
+{
+
+struct WorldStepContext
+{
+    World** worlds;
+    float dt;
+    int32 stepCount;
+};
+
+WorldPool::WorldPool(int32 workerCount)
+    : threadPool{ workerCount }
+{
+}
+
+void WorldPool::StepTask(int32 begin, int32 end, int32 workerIndex, void* taskContext)
+{
+    MuliNotUsed(workerIndex);
+    WorldStepContext* context = (WorldStepContext*)taskContext;
+
+    for (int32 i = begin; i < end; ++i)
+    {
+        World* world = context->worlds[i];
+
+        for (int32 j = 0; j < context->stepCount; ++j)
+        {
+            world->Step(context->dt);
+        }
+    }
+}
+
+void WorldPool::Step(std::span<World*> worlds, float dt, int32 stepCount)
+{
+    WorldStepContext context{ worlds.data(), dt, stepCount };
+
+    // Worlds can take very different time to step, so let the pool balance them in small blocks
+    threadPool.Finish(threadPool.Enqueue(StepTask, int32(worlds.size()), 1, &context));
+}
+
+} // namespace muli
@@ -0,0 +1,150 @@
+#include "muli/pair_set.h"
+#include "muli/hash.h"
+
+namespace muli
+{
+
+PairSet::PairSet(int32 initialCapacity)
+    : capacity{ 1 }
+    , count{ 0 }
+{
+    while (capacity < initialCapacity)
+    {
+        capacity *= 2;
+    }
+
+    pairs = (Pair*)muli::Alloc(capacity * sizeof(Pair));
+    memset(pairs, 0, capacity * sizeof(Pair));
+}
+
+PairSet::~PairSet()
+{
+    muli::Free(pairs);
+}
+
+int32 PairSet::GetSlot(const Pair& pair) const
+{
+    uint64 h = MixBits(uint64(uintptr_t(pair.a)) ^ MixBits(uint64(uintptr_t(pair.b))));
+    return int32(h & uint64(capacity - 1));
+}
+
+int32 PairSet::Find(const Pair& pair) const
+{
+    // Linear probing, the table is never full so the probe ends at an empty slot
+    int32 i = GetSlot(pair);
+    while (pairs[i].a != nullptr)
+    {
+        if (pairs[i].a == pair.a && pairs[i].b == pair.b)
+        {
+            return i;
+        }
+
+        i = (i + 1) & (capacity - 1);
+    }
+
+    return -1;
+}
+
+bool PairSet::Contains(const void* a, const void* b) const
+{
+    return Find(MakePair(a, b)) != -1;
+}
+
+bool PairSet::Add(const void* a, const void* b)
+{
+    MuliAssert(a != nullptr && b != nullptr);
+
+    Pair pair = MakePair(a, b);
+    if (Find(pair) != -1)
+    {
+        return false;
+    }
+
+    // Keep the load factor under 1/2
+    if (2 * (count + 1) > capacity)
+    {
+        Grow();
+    }
+
+    int32 i = GetSlot(pair);
+    while (pairs[i].a != nullptr)
+    {
+        i = (i + 1) & (capacity - 1);
+    }
+
+    pairs[i] = pair;
+    ++count;
+
+    return true;
+}
+
+bool PairSet::Remove(const void* a, const void* b)
+{
+    int32 i = Find(MakePair(a, b));
+    if (i == -1)
+    {
+        return false;
+    }
+
+    // Backward shift deletion, move the following pairs of the probe chain into the hole
+    // so lookups never need tombstones
+    int32 hole = i;
+    int32 j = i;
+    while (true)
+    {
+        j = (j + 1) & (capacity - 1);
+        if (pairs[j].a == nullptr)
+        {
+            break;
+        }
+
+        // The pair at j can fill the hole if its home slot isn't cyclically within (hole, j]
+        int32 home = GetSlot(pairs[j]);
+        if (((j - home) & (capacity - 1)) >= ((j - hole) & (capacity - 1)))
+        {
+            pairs[hole] = pairs[j];
+            hole = j;
+        }
+    }
+
+    pairs[hole] = Pair{ nullptr, nullptr };
+    --count;
+
+    return true;
+}
+
+void PairSet::Clear()
+{
+    memset(pairs, 0, capacity * sizeof(Pair));
+    count = 0;
+}
+
+void PairSet::Grow()
+{
+    Pair* oldPairs = pairs;
+    int32 oldCapacity = capacity;
+
+    capacity *= 2;
+    pairs = (Pair*)muli::Alloc(capacity * sizeof(Pair));
+    memset(pairs, 0, capacity * sizeof(Pair));
+
+    for (int32 i = 0; i < oldCapacity; ++i)
+    {
+        if (oldPairs[i].a == nullptr)
+        {
+            continue;
+        }
+
+        int32 j = GetSlot(oldPairs[i]);
+        while (pairs[j].a != nullptr)
+        {
+            j = (j + 1) & (capacity - 1);
+        }
+
+        pairs[j] = oldPairs[i];
+    }
+
+    muli::Free(oldPairs);
+}
+
+} // namespace muli
@@ -0,0 +1,177 @@
+#include "muli/thread_pool.h"
+
+namespace muli
+{
+
+// Number of blocks each worker gets on average, more blocks give better load balancing
+static constexpr int32 blocks_per_worker = 4;
+
+// Number of yields before an idle thread blocks on the condition variable
+static constexpr int32 spin_count = 1000;
+
+ThreadPool::ThreadPool(int32 inWorkerCount)
+    : workerCount{ Clamp(inWorkerCount, 1, max_workers) }
+    , taskAvailable{ false }
+    , taskGeneration{ 0 }
+    , activeWorkers{ 0 }
+    , exit{ false }
+{
+    task.function = nullptr;
+    task.context = nullptr;
+    task.itemCount = 0;
+    task.blockSize = 0;
+    task.blockCount = 0;
+    task.nextBlock = 0;
+
+    // The calling thread works as worker 0
+    threads = (std::thread*)muli::Alloc((workerCount - 1) * sizeof(std::thread));
+    for (int32 i = 1; i < workerCount; ++i)
+    {
+        new (threads + i - 1) std::thread(&ThreadPool::WorkerMain, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{ mutex };
+        exit = true;
+    }
+    wakeCondition.notify_all();
+
+    for (int32 i = 0; i < workerCount - 1; ++i)
+    {
+        threads[i].join();
+        threads[i].~thread();
+    }
+
+    muli::Free(threads);
+}
+
+void* ThreadPool::Enqueue(TaskFunction* function, int32 itemCount, int32 minRange, void* taskContext)
+{
+    if (itemCount <= 0)
+    {
+        return nullptr;
+    }
+
+    int32 blockSize = Max(Max(minRange, 1), (itemCount + workerCount * blocks_per_worker - 1) / (workerCount * blocks_per_worker));
+
+    // Not worth waking up the workers
+    if (workerCount == 1 || itemCount <= blockSize)
+    {
+        function(0, itemCount, 0, taskContext);
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{ mutex };
+        MuliAssert(taskAvailable == false);
+
+        task.function = function;
+        task.context = taskContext;
+        task.itemCount = itemCount;
+        task.blockSize = blockSize;
+        task.blockCount = (itemCount + blockSize - 1) / blockSize;
+        task.nextBlock.store(0, std::memory_order_relaxed);
+
+        taskAvailable = true;
+        ++taskGeneration;
+    }
+    wakeCondition.notify_all();
+
+    return &task;
+}
+
+void ThreadPool::Finish(void* userTask)
+{
+    if (userTask == nullptr)
+    {
+        return;
+    }
+
+    MuliAssert(userTask == &task);
+
+    Execute(0);
+
+    // Wait for the workers still running the last blocks
+    for (int32 i = 0; i < spin_count && activeWorkers.load(std::memory_order_relaxed) > 0; ++i)
+    {
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock{ mutex };
+    doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+
+    taskAvailable = false;
+}
+
+void ThreadPool::Execute(int32 workerIndex)
+{
+    while (true)
+    {
+        int32 block = task.nextBlock.fetch_add(1, std::memory_order_relaxed);
+        if (block >= task.blockCount)
+        {
+            break;
+        }
+
+        int32 begin = block * task.blockSize;
+        int32 end = Min(begin + task.blockSize, task.itemCount);
+
+        task.function(begin, end, workerIndex, task.context);
+    }
+}
+
+void ThreadPool::WorkerMain(int32 workerIndex)
+{
+    uint64 generation = 0;
+
+    while (true)
+    {
+        for (int32 i = 0; i < spin_count && taskGeneration.load(std::memory_order_relaxed) == generation; ++i)
+        {
+            std::this_thread::yield();
+        }
+
+        {
+            std::unique_lock<std::mutex> lock{ mutex };
+            while (exit == false && (taskAvailable == false || taskGeneration == generation))
+            {
+                // Skip the tasks finished by the other threads, so that the next spin waits for a new one
+                generation = taskGeneration;
+                wakeCondition.wait(lock);
+            }
+
+            if (exit)
+            {
+                return;
+            }
+
+            generation = taskGeneration;
+            ++activeWorkers;
+        }
+
+        Execute(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            --activeWorkers;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void* ThreadPool::EnqueueTask(TaskFunction* function, int32 itemCount, int32 minRange, void* taskContext, void* userContext)
+{
+    ThreadPool* pool = (ThreadPool*)userContext;
+    return pool->Enqueue(function, itemCount, minRange, taskContext);
+}
+
+void ThreadPool::FinishTask(void* userTask, void* userContext)
+{
+    ThreadPool* pool = (ThreadPool*)userContext;
+    pool->Finish(userTask);
+}
+
+} // namespace muli